@@ -0,0 +1,106 @@
+#include "odbc/ast/Arena.hpp"
+#include "odbc/ast/Node.hpp"
+#include "odbc/ast/Traversal.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <functional>
+
+/*
+ * Compares the explicit-stack Traversal against the recursive walk the AST
+ * functions used before. Block lists are kept short enough for the recursive
+ * version not to overflow the stack.
+ */
+
+using namespace odbc;
+
+// ----------------------------------------------------------------------------
+static void freeRecursive(ast::Arena* arena, ast::node_t* node)
+{
+    if (node == nullptr)
+        return;
+
+    freeRecursive(arena, node->base.left);
+    freeRecursive(arena, node->base.right);
+    ast::freeNode(arena, node);
+}
+
+// ----------------------------------------------------------------------------
+static int countRecursive(ast::node_t* node)
+{
+    if (node == nullptr)
+        return 0;
+    return 1 + countRecursive(node->base.left) + countRecursive(node->base.right);
+}
+
+// ----------------------------------------------------------------------------
+static ast::node_t* newBlockList(ast::Arena* arena, int statementCount)
+{
+    ast::node_t* block = ast::newBlock(arena, ast::newIntegerLiteral(arena, 0), nullptr);
+    for (int i = 1; i < statementCount; ++i)
+        ast::appendStatementToBlock(arena, block, ast::newIntegerLiteral(arena, i));
+    return block;
+}
+
+// ----------------------------------------------------------------------------
+static ast::node_t* newBalancedTree(ast::Arena* arena, int depth)
+{
+    if (depth == 0)
+        return ast::newIntegerLiteral(arena, 0);
+    return ast::newOp(arena, newBalancedTree(arena, depth - 1), newBalancedTree(arena, depth - 1), ast::OP_ADD);
+}
+
+// ----------------------------------------------------------------------------
+// Returns the best time in milliseconds out of several runs. The tree is
+// rebuilt before every run and not part of the measurement.
+static double bestOf(int runs,
+                     const std::function<ast::node_t*(ast::Arena*)>& build,
+                     const std::function<void(ast::Arena*, ast::node_t*)>& work)
+{
+    double best = 1e30;
+    for (int run = 0; run != runs; ++run)
+    {
+        ast::Arena arena;
+        ast::node_t* root = build(&arena);
+        auto start = std::chrono::steady_clock::now();
+        work(&arena, root);
+        auto end = std::chrono::steady_clock::now();
+        best = std::min(best, std::chrono::duration<double, std::milli>(end - start).count());
+    }
+    return best;
+}
+
+// ----------------------------------------------------------------------------
+static void compare(const char* name, const std::function<ast::node_t*(ast::Arena*)>& build)
+{
+    const int runs = 20;
+    volatile int sink = 0;
+
+    double countRec = bestOf(runs, build, [&sink](ast::Arena*, ast::node_t* root) {
+        sink = countRecursive(root);
+    });
+    double countIter = bestOf(runs, build, [&sink](ast::Arena*, ast::node_t* root) {
+        int count = 0;
+        ast::Traversal().preOrder(root, [&count](ast::node_t*) { count++; return true; });
+        sink = count;
+    });
+    double freeRec = bestOf(runs, build, [](ast::Arena* arena, ast::node_t* root) {
+        freeRecursive(arena, root);
+    });
+    double freeIter = bestOf(runs, build, [](ast::Arena* arena, ast::node_t* root) {
+        ast::freeNodeRecursive(arena, root);
+    });
+
+    printf("%-24s count: recursive %8.3f ms, iterative %8.3f ms\n", name, countRec, countIter);
+    printf("%-24s free:  recursive %8.3f ms, iterative %8.3f ms\n", "", freeRec, freeIter);
+}
+
+// ----------------------------------------------------------------------------
+int main()
+{
+    compare("block list (10k)", [](ast::Arena* arena) { return newBlockList(arena, 10000); });
+    compare("block list (50k)", [](ast::Arena* arena) { return newBlockList(arena, 50000); });
+    compare("balanced tree (2^16)", [](ast::Arena* arena) { return newBalancedTree(arena, 16); });
+    compare("balanced tree (2^20)", [](ast::Arena* arena) { return newBalancedTree(arena, 20); });
+    return 0;
+}
@@ -0,0 +1,58 @@
+#include "odbc/parsers/CompletionIndex.hpp"
+#include "odbc/parsers/keywords/KeywordsDB.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+
+/*
+ * Times completion queries against the full keyword set. Only keyword names
+ * are needed, so the directory is indexed rather than parsed.
+ */
+
+using namespace odbc;
+
+// ----------------------------------------------------------------------------
+// Returns the best time in microseconds of one query out of several runs
+static double bestOf(int runs, const CompletionIndex& index, const char* prefix, std::size_t maxResults)
+{
+    double best = 1e30;
+    volatile std::size_t sink = 0;
+    for (int run = 0; run != runs; ++run)
+    {
+        auto start = std::chrono::steady_clock::now();
+        sink = index.complete(prefix, maxResults).size();
+        auto end = std::chrono::steady_clock::now();
+        best = std::min(best, std::chrono::duration<double, std::micro>(end - start).count());
+    }
+    (void)sink;
+    return best;
+}
+
+// ----------------------------------------------------------------------------
+int main(int argc, char** argv)
+{
+    if (argc != 2)
+    {
+        printf("Usage: %s <keyword directory>\n", argv[0]);
+        return 1;
+    }
+
+    KeywordDB db;
+    if (db.indexDirectory(argv[1]) == false)
+        printf("Warning: Failed to index some keywords in %s\n", argv[1]);
+
+    auto start = std::chrono::steady_clock::now();
+    CompletionIndex index;
+    index.addKeywords(db);
+    auto end = std::chrono::steady_clock::now();
+    printf("%zu names indexed in %.3f ms\n", index.size(),
+           std::chrono::duration<double, std::milli>(end - start).count());
+
+    const int runs = 100;
+    for (const char* prefix : {"", "m", "make obj", "make object sphere", "set ", "xyz"})
+        printf("%-24s top 10: %8.2f us, top 100: %8.2f us\n",
+               (std::string("\"") + prefix + "\"").c_str(),
+               bestOf(runs, index, prefix, 10), bestOf(runs, index, prefix, 100));
+
+    return 0;
+}
@@ -0,0 +1,87 @@
+#include "odbc/parsers/db/Driver.hpp"
+#include "odbc/parsers/db/IncrementalParser.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <string>
+
+/*
+ * Compares parsing a whole source with applying a small edit to it through
+ * db::IncrementalParser, for growing source sizes. The time of a full parse
+ * grows with the source, the time of an edit should stay about the same.
+ * Edits are typed at one place, like they would be in an editor, with a
+ * line inserted and removed now and then.
+ */
+
+using namespace odbc;
+
+// ----------------------------------------------------------------------------
+static std::string makeSource(int lines)
+{
+    std::string text;
+    for (int i = 0; i != lines; ++i)
+    {
+        if (i % 10 == 0)
+            text += "do\n";
+        text += "score" + std::to_string(i % 100) + "=score+" + std::to_string(i) + "\n";
+        if (i % 10 == 9)
+            text += "loop\n";
+    }
+    return text;
+}
+
+// ----------------------------------------------------------------------------
+static void benchLines(int lines)
+{
+    std::string text = makeSource(lines);
+
+    double fullMs = 1e30;
+    for (int run = 0; run != 3; ++run)
+    {
+        auto start = std::chrono::steady_clock::now();
+        db::Driver driver;
+        driver.parseString(text);
+        auto end = std::chrono::steady_clock::now();
+        fullMs = std::min(fullMs, std::chrono::duration<double, std::milli>(end - start).count());
+    }
+
+    db::IncrementalParser parser;
+    if (parser.parse(text) == false)
+    {
+        printf("%7d lines: parse failed\n", lines);
+        return;
+    }
+
+    // Somewhere in the middle, on the last digit of an assignment
+    uint32_t offset = (uint32_t)text.find('\n', text.size() / 2) - 1;
+    while (text[offset] < '0' || text[offset] > '9')
+        offset = (uint32_t)text.rfind('\n', offset) - 1;
+
+    const int edits = 10000;
+    bool failed = false;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i != edits; ++i)
+    {
+        char digit = (char)('0' + i % 10);
+        failed |= parser.edit(offset, 1, &digit, 1) == false;
+        if (i % 100 == 0)
+        {
+            uint32_t lineStart = offset + 2;
+            failed |= parser.edit(lineStart, 0, "extra=1\n", 8) == false;
+            failed |= parser.edit(lineStart, 8, "", 0) == false;
+        }
+    }
+    auto end = std::chrono::steady_clock::now();
+    double editUs = std::chrono::duration<double, std::micro>(end - start).count() / edits;
+
+    printf("%7d lines: full parse %9.3f ms, edit %7.2f us%s\n",
+           lines, fullMs, editUs, failed ? " (some edits failed to parse)" : "");
+}
+
+// ----------------------------------------------------------------------------
+int main()
+{
+    for (int lines : {1000, 5000, 20000, 100000, 500000})
+        benchLines(lines);
+    return 0;
+}
@@ -0,0 +1,51 @@
+#include "odbc/parsers/db/Driver.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <string>
+
+/*
+ * Parses flat programs of growing length and prints the time per statement.
+ * Appending a statement to the program is O(1) thanks to the tail kept on
+ * the first block, so the time per statement should stay about the same
+ * from 1k to 1M statements. A quadratic append shows up as a ratio in the
+ * hundreds by 100k statements.
+ */
+
+using namespace odbc;
+
+// ----------------------------------------------------------------------------
+// Returns the best parse time per statement out of several runs
+static double secondsPerStatement(int statementCount, int runs)
+{
+    std::string source;
+    source.reserve(statementCount * 4);
+    for (int i = 0; i != statementCount; ++i)
+        source += "a=1\n";
+
+    double best = 1e30;
+    for (int run = 0; run != runs; ++run)
+    {
+        db::Driver driver;
+        auto start = std::chrono::steady_clock::now();
+        if (driver.parseString(source) == false)
+            printf("%d statements: parse failed\n", statementCount);
+        auto end = std::chrono::steady_clock::now();
+        best = std::min(best, std::chrono::duration<double>(end - start).count());
+    }
+
+    return best / statementCount;
+}
+
+// ----------------------------------------------------------------------------
+int main()
+{
+    double baseline = secondsPerStatement(1000, 20);
+    for (int count : {1000, 10000, 100000, 1000000})
+    {
+        double perStatement = secondsPerStatement(count, count < 1000000 ? 3 : 1);
+        printf("%8d statements: %7.1f ns per statement, %5.2fx the 1k baseline\n",
+               count, perStatement * 1e9, perStatement / baseline);
+    }
+    return 0;
+}
@@ -0,0 +1,163 @@
+#include "odbc/parsers/db/Driver.hpp"
+#include "odbc/parsers/db/Parser.y.h"
+#include "odbc/parsers/db/Scanner.hpp"
+#include "odbc/parsers/SourceBuffer.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <functional>
+#include <memory>
+#include <string>
+
+/*
+ * Measures the db scanner on its own, without the parser. One kind of
+ * source is made of short statements that are mostly reserved words, which
+ * is where classifying identifiers matters. The other is mostly comments
+ * and indentation, which is where skipping text outside the DFA matters.
+ * Run it on builds before and after a scanner change to compare; the token
+ * counts must come out the same. For the size of the scanner's tables,
+ * "flex -v" prints the number of DFA states and table entries.
+ *
+ * It also times full parses with the lexer running in lockstep with the
+ * parser against lexing chunks on several threads.
+ */
+
+using namespace odbc;
+
+// ----------------------------------------------------------------------------
+static std::string keywordHeavySource(int lines)
+{
+    static const char* statements[] = {
+        "if a and not b then c = 1\n",
+        "while x < 10\n",
+        "inc x\n",
+        "endwhile\n",
+        "for i = 1 to 100 step 2\n",
+        "next i\n",
+        "repeat\n",
+        "until done or failed\n",
+        "do\n",
+        "loop\n",
+        "dim arr(10) as integer\n",
+        "global score as float\n",
+        "local name as string\n",
+        "function foo(a as integer, b as float)\n",
+        "endfunction a\n",
+        "elseif flag = true\n",
+        "else\n",
+        "endif\n",
+        "type vec\n",
+        "endtype\n",
+    };
+    const int statementCount = sizeof(statements) / sizeof(*statements);
+
+    std::string source;
+    for (int i = 0; i != lines; ++i)
+        source += statements[i % statementCount];
+    return source;
+}
+
+// ----------------------------------------------------------------------------
+// Legacy sources often carry long comment banners and tab indentation,
+// which the scanner skips without producing tokens
+static std::string commentHeavySource(int lines)
+{
+    static const char* statements[] = {
+        "rem ---------------------------------------------------------------------\n",
+        "rem  Player movement, ported from the 2003 version. Don't touch the timing\n",
+        "\t\t\tinc x\n",
+        "// Keep the camera behind the player at all times, see notes in setup.dba\n",
+        "\t\tif a and not b then c = 1\n",
+        "/* old collision code was here, removed because it was far too slow */\n",
+        "remstart this whole line is one long remark block that ends here remend\n",
+        "\t\t\t\tnext i\n",
+    };
+    const int statementCount = sizeof(statements) / sizeof(*statements);
+
+    std::string source;
+    for (int i = 0; i != lines; ++i)
+        source += statements[i % statementCount];
+    return source;
+}
+
+// ----------------------------------------------------------------------------
+// Returns the best time in milliseconds out of several runs
+static double bestOf(int runs, const std::function<void()>& work)
+{
+    double best = 1e30;
+    for (int run = 0; run != runs; ++run)
+    {
+        auto start = std::chrono::steady_clock::now();
+        work();
+        auto end = std::chrono::steady_clock::now();
+        best = std::min(best, std::chrono::duration<double, std::milli>(end - start).count());
+    }
+    return best;
+}
+
+// ----------------------------------------------------------------------------
+static int lexAll(db::Driver* driver, SourceBuffer* source)
+{
+    dbscan_t scanner;
+    DBSTYPE value;
+    int tokens = 0;
+
+    dblex_init_extra(driver, &scanner);
+    YY_BUFFER_STATE buf = db_scan_buffer(source->data(), source->scanSize(), scanner);
+    while (dblex(&value, scanner) != 0)
+        tokens++;
+    db_delete_buffer(buf, scanner);
+    dblex_destroy(scanner);
+
+    return tokens;
+}
+
+// ----------------------------------------------------------------------------
+static void benchScanner(const char* name, const std::string& text)
+{
+    db::Driver driver;
+    int tokens = 0;
+
+    // The scanner writes into the buffer, so every run gets a fresh copy
+    double ms = bestOf(10, [&]() {
+        std::unique_ptr<SourceBuffer> source = SourceBuffer::fromString(text);
+        tokens = lexAll(&driver, source.get());
+    });
+
+    printf("%-20s %9d tokens %8.3f ms %8.1f MB/s %8.2f Mtokens/s\n",
+           name, tokens, ms, text.size() / ms / 1e3, tokens / ms / 1e3);
+}
+
+// ----------------------------------------------------------------------------
+static void benchParse(const char* name, int lines, unsigned lexerThreads)
+{
+    // The keyword heavy source isn't a valid program, so use assignments
+    std::string text;
+    for (int i = 0; i != lines; ++i)
+        text += "score" + std::to_string(i % 100) + "=score+" + std::to_string(i) + "\n";
+
+    bool parsed = false;
+    double ms = bestOf(5, [&]() {
+        db::Driver driver;
+        driver.setLexerThreads(lexerThreads, 0);
+        parsed = driver.parseString(text);
+    });
+    if (parsed == false)
+        printf("%s: parse failed\n", name);
+
+    printf("%-20s %2u lexer threads %8.3f ms %8.1f MB/s\n",
+           name, lexerThreads, ms, text.size() / ms / 1e3);
+}
+
+// ----------------------------------------------------------------------------
+int main()
+{
+    benchScanner("10k lines", keywordHeavySource(10000));
+    benchScanner("100k lines", keywordHeavySource(100000));
+    benchScanner("1M lines", keywordHeavySource(1000000));
+    benchScanner("commented 100k lines", commentHeavySource(100000));
+    benchScanner("commented 1M lines", commentHeavySource(1000000));
+    for (unsigned threads : {1u, 2u, 4u, 8u})
+        benchParse("parse 1M lines", 1000000, threads);
+    return 0;
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include "odbc/config.hpp"
+#include <cstddef>
+
+namespace odbc {
+namespace ast {
+
+union node_t;
+
+/*!
+ * Bump-pointer allocator that owns every node and string of an AST. Memory is
+ * carved out of large chunks and is only returned to the system when the
+ * arena is reset or destroyed, so tearing down an AST is a single call
+ * instead of a walk over the whole tree.
+ *
+ * Nodes released with releaseNode() are kept on a free list and handed out
+ * again by allocateNode(). Strings are never released individually.
+ */
+class ODBC_PUBLIC_API Arena
+{
+public:
+    explicit Arena(std::size_t chunkSize = 64 * 1024);
+    ~Arena();
+
+    Arena(const Arena&) = delete;
+    Arena& operator=(const Arena&) = delete;
+
+    void* allocate(std::size_t size, std::size_t align = alignof(std::max_align_t));
+
+    node_t* allocateNode();
+    void releaseNode(node_t* node);
+
+    char* strdup(const char* str);
+    char* strndup(const char* str, std::size_t len);
+
+    /*!
+     * Releases everything allocated from this arena at once. One chunk is
+     * kept around so the next AST doesn't immediately hit malloc again.
+     */
+    void reset();
+
+    //! Number of bytes handed out since the last reset
+    std::size_t bytesUsed() const { return bytesUsed_; }
+    //! Number of bytes currently reserved from the system
+    std::size_t bytesReserved() const { return bytesReserved_; }
+    //! Largest value bytesUsed() has ever reached, across resets
+    std::size_t peakBytesUsed() const { return peakBytesUsed_; }
+
+private:
+    struct Chunk
+    {
+        Chunk* next;
+        std::size_t size;
+        std::size_t used;
+    };
+
+    Chunk* newChunk(std::size_t size);
+
+    Chunk* head_;
+    node_t* freeNodes_;
+    std::size_t chunkSize_;
+    std::size_t bytesUsed_;
+    std::size_t bytesReserved_;
+    std::size_t peakBytesUsed_;
+};
+
+}
+}
@@ -0,0 +1,162 @@
+#pragma once
+
+#include "odbc/config.hpp"
+#include "odbc/ast/Node.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace odbc {
+class SourceBuffer;
+namespace ast {
+
+class Arena;
+class StringTable;
+
+/*!
+ * Compact storage for an AST. All nodes live in one contiguous array and
+ * refer to each other with 32-bit indices. Each node takes 16 bytes plus 2
+ * for the length of its source span. The pointer-based node_t takes 40 on
+ * 64-bit platforms.
+ * Names, string literals and float literals are kept in side tables.
+ *
+ * Nodes are stored in post-order: children always come before their parent
+ * and the root is the last node. A pass that doesn't care about tree shape
+ * can just loop over the array. A bottom-up pass can loop over it in order.
+ * A right child is therefore always the node right before its parent, so
+ * only the left child is stored.
+ *
+ * The pointer-based node_t API remains the main interface for now.
+ * build() converts a node_t tree to this form and toTree() converts back.
+ *
+ * save() writes the arrays to a file as they are in memory. load() maps such
+ * a file and uses the arrays in place, without allocating anything per node.
+ * The file format depends on byte order and is only meant as a local cache.
+ */
+class ODBC_PUBLIC_API FlatAST
+{
+public:
+    typedef uint32_t Index;
+    static const Index none = 0xFFFFFFFF;
+
+    struct Node
+    {
+        uint8_t type;       // NodeType, plus hasRight if there is a right child
+        /*
+         * Operation for NT_OP, LiteralType for NT_LITERAL. For NT_COMMAND,
+         * subtype and flags hold the 24-bit keyword ID, see keywordID()
+         */
+        uint8_t subtype;
+        uint16_t flags;     // symbol_t::flags for NT_SYMBOL
+        Index left;         // Same child as base.left, or none
+        /*
+         * NT_SYMBOL, NT_COMMAND: Offset of the name in the string table
+         * NT_LITERAL: The value for booleans and integers, the offset into
+         *             the string table for strings and the index into the
+         *             float table for floats
+         */
+        uint32_t payload;
+        uint32_t spanOffset;
+    };
+
+    static const uint8_t hasRight = 0x80;
+
+    FlatAST();
+    ~FlatAST();
+
+    // Copying would leave the views pointing at the source's arrays
+    FlatAST(const FlatAST&) = delete;
+    FlatAST& operator=(const FlatAST&) = delete;
+
+    /*!
+     * Replaces the contents with a copy of the tree at root. The tree is not
+     * modified and may be freed afterwards.
+     */
+    void build(const node_t* root);
+
+    /*!
+     * Creates a node_t tree from the stored nodes. Nodes are allocated from
+     * the arena. Names are interned in the string table, which must belong to
+     * the same arena. String literals are copied into the arena.
+     * @return Returns the root node, or nullptr if the AST is empty or an
+     * allocation failed.
+     */
+    node_t* toTree(Arena* arena, StringTable* strings) const;
+
+    /*!
+     * Writes the AST to a file. sourceHash identifies the source text the
+     * AST was parsed from. It is stored in the file together with
+     * ODBC_VERSION. load() checks both.
+     */
+    bool save(const std::string& fileName, uint64_t sourceHash) const;
+
+    /*!
+     * Maps a file written by save() and uses it in place. Fails if the file
+     * is damaged, or if it was written by another version of the library or
+     * for different source text. The contents are cleared on failure.
+     */
+    bool load(const std::string& fileName, uint64_t sourceHash);
+
+    //! Hash of source text as save() and load() expect it
+    static uint64_t hashSource(const char* data, std::size_t size);
+
+    void clear();
+
+    bool empty() const { return nodeCount_ == 0; }
+    std::size_t nodeCount() const { return nodeCount_; }
+    Index root() const { return nodeCount_ == 0 ? none : Index(nodeCount_ - 1); }
+    const Node& node(Index i) const { return nodes_[i]; }
+    NodeType type(Index i) const { return NodeType(nodes_[i].type & ~hasRight); }
+    Index left(Index i) const { return nodes_[i].left; }
+    Index right(Index i) const { return nodes_[i].type & hasRight ? i - 1 : none; }
+    SourceSpan span(Index i) const;
+
+    //! Name of an NT_SYMBOL or NT_COMMAND node
+    const char* name(Index i) const { return &strings_[nodes_[i].payload]; }
+    //! command_t::keywordID of an NT_COMMAND node
+    uint32_t keywordID(Index i) const;
+
+    bool booleanValue(Index i) const { return nodes_[i].payload != 0; }
+    int32_t integerValue(Index i) const { return int32_t(nodes_[i].payload); }
+    double floatValue(Index i) const { return floats_[nodes_[i].payload]; }
+    const char* stringValue(Index i) const { return &strings_[nodes_[i].payload]; }
+
+    //! Bytes used by the node array and side tables
+    std::size_t memoryUsage() const;
+
+private:
+    // Span lengths that don't fit into 16 bits. Their entry in spanLengths_
+    // is longSpan and they are sorted by node.
+    struct LongSpan
+    {
+        Index node;
+        uint32_t length;
+    };
+    static const uint16_t longSpan = 0xFFFF;
+
+    bool validate() const;
+
+    // All accessors go through these. They point either into the owned
+    // arrays below or into mapping_.
+    const Node* nodes_;
+    const uint16_t* spanLengths_;
+    const LongSpan* longSpans_;
+    const double* floats_;
+    const char* strings_;  // NUL terminated strings, back to back
+    std::size_t nodeCount_;
+    std::size_t longSpanCount_;
+    std::size_t floatCount_;
+    std::size_t stringsSize_;
+
+    std::vector<Node> ownedNodes_;
+    std::vector<uint16_t> ownedSpanLengths_;
+    std::vector<LongSpan> ownedLongSpans_;
+    std::vector<double> ownedFloats_;
+    std::vector<char> ownedStrings_;
+    std::unique_ptr<SourceBuffer> mapping_;
+};
+
+}
+}
@@ -1,12 +1,16 @@
 #pragma once
 
 #include "odbc/config.hpp"
+#include "odbc/ast/SourceSpan.hpp"
+#include "odbc/ast/StringTable.hpp"
 #include <ostream>
 
 namespace odbc {
 class Driver;
 namespace ast {
 
+class Arena;
+
 enum NodeType
 {
     NT_BLOCK,
@@ -137,16 +141,17 @@ union literal_value_t
     bool b;
     int32_t i;
     double f;
-    char* s;
+    const char* s;
 };
 
 union node_t {
     struct info_t
     {
-        NodeType type;
-#ifdef ODBC_DOT_EXPORT
-        int guid;
-#endif
+        NodeType type : 8;
+        // Where the node was parsed from, see getSpan(). The length shares a
+        // word with the type so nodes don't grow.
+        uint32_t spanLength : 24;
+        uint32_t spanOffset;
     } info;
 
     struct base_t
@@ -161,6 +166,9 @@ union node_t {
         info_t info;
         node_t* next;
         node_t* statement;
+        // Last block in the list. Only maintained on the first block, which
+        // is what appendStatementToBlock() expects to be given.
+        node_t* tail;
     } block;
 
     // Assign statement to symbol
@@ -240,7 +248,11 @@ union node_t {
         info_t info;
         node_t* args;
         node_t* _padding;
-        char* name;
+        const char* name;
+        StringTable::ID nameID;
+        // ID of the command in the CommandTrie the scanner used, or
+        // NO_KEYWORD_ID if the command wasn't recognised by a trie
+        uint32_t keywordID;
     } command;
 
     struct symbol_t
@@ -248,7 +260,8 @@ union node_t {
         info_t info;
         node_t* data;
         node_t* arglist;
-        char* name;
+        const char* name;      // Interned, equal names have equal nameIDs
+        StringTable::ID nameID;
         union {
             uint16_t flags;
             struct {
@@ -270,41 +283,72 @@ union node_t {
     } literal;
 };
 
+static const uint32_t NO_KEYWORD_ID = 0xFFFFFFFF;
+
 #ifdef ODBC_DOT_EXPORT
 void dumpToDOT(std::ostream& os, node_t* root);
 #endif
 
-node_t* newOp(node_t* left, node_t* right, Operation op);
+/*!
+ * Nodes made by the parser cover the text of the rule that made them. Nodes
+ * the parser adds to link others together, like blocks, have an empty span.
+ * Offsets count bytes from the start of the source the node came from; the
+ * driver's LineIndex turns them into lines and columns. Spans longer than
+ * 16 MiB are cut short.
+ */
+inline SourceSpan getSpan(const node_t* node) { return {node->info.spanOffset, node->info.spanLength}; }
+void setSpan(node_t* node, SourceSpan span);
+
+/*
+ * All nodes are allocated from the arena passed in. Symbol and command names
+ * are interned in the string table, which must use the same arena. String
+ * literals are referenced, not copied, and must live at least as long as the
+ * arena does. Strings returned by Arena::strdup() satisfy this.
+ */
+node_t* newOp(Arena* arena, node_t* left, node_t* right, Operation op);
 
-node_t* newSymbol(const char* symbolName, node_t* data, node_t* arglist,
+/*!
+ * Allocates a node and only sets its type and its two children. This is for
+ * code that rebuilds nodes from another representation (see FlatAST) and
+ * fills in the remaining fields itself.
+ */
+node_t* newNode(Arena* arena, NodeType type, node_t* left, node_t* right);
+
+node_t* newSymbol(Arena* arena, const StringTable* strings, StringTable::ID symbolName, node_t* data, node_t* arglist,
                   SymbolType type, SymbolDataType dataType, SymbolScope scope, SymbolDeclaration declaration);
 
-node_t* newBooleanLiteral(bool value);
-node_t* newIntegerLiteral(int32_t value);
-node_t* newFloatLiteral(double value);
-node_t* newStringLiteral(const char* value);
+node_t* newBooleanLiteral(Arena* arena, bool value);
+node_t* newIntegerLiteral(Arena* arena, int32_t value);
+node_t* newFloatLiteral(Arena* arena, double value);
+node_t* newStringLiteral(Arena* arena, const char* value);
 
-node_t* newAssignment(node_t* symbol, node_t* statement);
+node_t* newAssignment(Arena* arena, node_t* symbol, node_t* statement);
 
-node_t* newBranch(node_t* condition, node_t* true_branch, node_t* false_branch);
+node_t* newBranch(Arena* arena, node_t* condition, node_t* true_branch, node_t* false_branch);
 
-node_t* newFuncReturn(node_t* returnValue);
-node_t* newSubReturn();
+node_t* newFuncReturn(Arena* arena, node_t* returnValue);
+node_t* newSubReturn(Arena* arena);
 
-node_t* newCommandSymbol(node_t* symbol, node_t* nextSymbol);
-node_t* newCommand(node_t* symbolsList, node_t* arglist);
+node_t* newCommandSymbol(Arena* arena, node_t* symbol, node_t* nextSymbol);
+node_t* newCommand(Arena* arena, StringTable* strings, node_t* symbolsList, node_t* arglist);
+node_t* newKeywordCommand(Arena* arena, StringTable* strings, uint32_t keywordID, const char* name,
+                          std::size_t nameLength, node_t* arglist);
 
-node_t* newLoop(node_t* block);
-node_t* newLoopWhile(node_t* condition, node_t* block);
-node_t* newLoopUntil(node_t* condition, node_t* block);
-node_t* newLoopFor(node_t* symbol, node_t* startExpr, node_t* endExpr, node_t* stepExpr, node_t* nextSymbol, node_t* block);
+node_t* newLoop(Arena* arena, node_t* block);
+node_t* newLoopWhile(Arena* arena, node_t* condition, node_t* block);
+node_t* newLoopUntil(Arena* arena, node_t* condition, node_t* block);
+node_t* newLoopFor(Arena* arena, node_t* symbol, node_t* startExpr, node_t* endExpr, node_t* stepExpr, node_t* nextSymbol, node_t* block);
 
-node_t* newBlock(node_t* expr, node_t* next);
-node_t* appendStatementToBlock(node_t* block, node_t* expr);
-node_t* prependStatementToBlock(node_t* block, node_t* expr);
+node_t* newBlock(Arena* arena, node_t* expr, node_t* next);
+node_t* appendStatementToBlock(Arena* arena, node_t* block, node_t* expr);
+node_t* prependStatementToBlock(Arena* arena, node_t* block, node_t* expr);
 
-void freeNode(node_t* node);
-void freeNodeRecursive(node_t* root=nullptr);
+/*
+ * Returns nodes to the arena's free list so they can be reused by later
+ * allocations. Releasing a whole AST is cheaper done with Arena::reset().
+ */
+void freeNode(Arena* arena, node_t* node);
+void freeNodeRecursive(Arena* arena, node_t* root=nullptr);
 
 }
 }
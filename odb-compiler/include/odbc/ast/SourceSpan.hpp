@@ -0,0 +1,23 @@
+#pragma once
+
+#include <cstdint>
+
+namespace odbc {
+namespace ast {
+
+/*!
+ * The text a token or node was parsed from, as a byte offset from the start
+ * of its source and a length in bytes. Lines and columns aren't stored. Get
+ * them from the LineIndex of the source when they're needed.
+ *
+ * This is also the location type of the db parser, so the scanner only has
+ * to report where each token starts and how long it is.
+ */
+struct SourceSpan
+{
+    uint32_t offset;
+    uint32_t length;
+};
+
+}
+}
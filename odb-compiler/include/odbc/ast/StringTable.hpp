@@ -0,0 +1,51 @@
+#pragma once
+
+#include "odbc/config.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace odbc {
+namespace ast {
+
+class Arena;
+
+/*!
+ * Interns identifiers. Every distinct string is stored exactly once (in the
+ * arena passed to the constructor) and is assigned a dense 32-bit ID, so two
+ * names can be compared for equality by comparing their IDs.
+ *
+ * Since the strings live in the arena, the table must be cleared whenever
+ * the arena is reset.
+ */
+class ODBC_PUBLIC_API StringTable
+{
+public:
+    typedef uint32_t ID;
+
+    explicit StringTable(Arena* arena);
+
+    ID intern(const char* str, std::size_t len);
+    ID intern(const char* str);
+
+    //! Returns the NUL terminated string for an ID returned by intern()
+    const char* get(ID id) const { return strings_[id]; }
+    std::size_t length(ID id) const { return lengths_[id]; }
+
+    //! Number of distinct strings interned
+    std::size_t size() const { return strings_.size(); }
+
+    void clear();
+
+private:
+    void grow();
+
+    Arena* arena_;
+    std::vector<const char*> strings_;
+    std::vector<uint32_t> lengths_;
+    std::vector<uint32_t> hashes_;
+    std::vector<uint32_t> slots_;  // ID + 1, 0 marks an empty slot
+};
+
+}
+}
@@ -0,0 +1,110 @@
+#pragma once
+
+#include "odbc/config.hpp"
+#include "odbc/ast/Node.hpp"
+#include <utility>
+#include <vector>
+
+namespace odbc {
+namespace ast {
+
+/*!
+ * Walks an AST through base.left/base.right using an explicit stack instead
+ * of recursion. Blocks are long linked lists, so a recursive walk needs one
+ * stack frame per statement and overflows on large generated sources. Here
+ * only the heap-allocated stack grows, and it is kept between walks so a
+ * Traversal that is reused doesn't allocate again.
+ *
+ * Visitors are called as bool(node_t*). Returning false stops the walk, in
+ * which case preOrder()/postOrder() return false as well.
+ */
+class Traversal
+{
+public:
+    /*!
+     * Visits a node before its children, left before right. Blocks are the
+     * exception: their statement comes before the next block, so statements
+     * are visited in source order. The children are read before the visitor
+     * runs, so it may free or modify the node.
+     */
+    template <typename Visitor>
+    bool preOrder(node_t* root, Visitor&& visit)
+    {
+        stack_.clear();
+        node_t* node = root;
+
+        while (node || stack_.empty() == false)
+        {
+            if (node == nullptr)
+            {
+                node = stack_.back();
+                stack_.pop_back();
+            }
+
+            node_t* left = node->base.left;
+            node_t* right = node->base.right;
+            // A block's left is the next block. Deferring that instead of
+            // the statement also keeps the stack at the nesting depth rather
+            // than the length of the list.
+            if (node->info.type == NT_BLOCK)
+                std::swap(left, right);
+            if (visit(node) == false)
+                return false;
+
+            // Continue with the left child directly and only defer the
+            // right one, which saves a push and pop per node
+            if (left)
+            {
+                if (right)
+                    stack_.push_back(right);
+                node = left;
+            }
+            else
+                node = right;
+        }
+
+        return true;
+    }
+
+    /*!
+     * Visits a node after all of its children, left before right. The node
+     * is not touched again after the visitor returns, so it may free it.
+     */
+    template <typename Visitor>
+    bool postOrder(node_t* root, Visitor&& visit)
+    {
+        stack_.clear();
+        node_t* node = root;
+        node_t* lastVisited = nullptr;
+
+        while (node || stack_.empty() == false)
+        {
+            if (node)
+            {
+                stack_.push_back(node);
+                node = node->base.left;
+                continue;
+            }
+
+            node_t* top = stack_.back();
+            if (top->base.right && top->base.right != lastVisited)
+            {
+                node = top->base.right;
+                continue;
+            }
+
+            stack_.pop_back();
+            if (visit(top) == false)
+                return false;
+            lastVisited = top;
+        }
+
+        return true;
+    }
+
+private:
+    std::vector<node_t*> stack_;
+};
+
+}
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include "odbc/config.hpp"
+#include "odbc/ast/Node.hpp"
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace odbc {
+
+class KeywordDB;
+
+/*!
+ * Sorted prefix index over keyword names and the symbols of parsed
+ * programs, for completing partially typed names in an editor. Names are
+ * matched the way DarkBASIC compares them: regardless of case and with any
+ * run of whitespace treated as one space, so "make  obj" finds
+ * "MAKE OBJECT". All names live in one string buffer next to a sorted
+ * array of fixed size entries, and a query is two binary searches plus a
+ * pass over the matching range.
+ */
+class ODBC_PUBLIC_API CompletionIndex
+{
+public:
+    struct Match
+    {
+        std::string_view name;  // As it was added, valid until the index changes
+        ast::SymbolType type;   // ST_COMMAND for keywords
+    };
+
+    //! Adds every keyword name of the DB, including indexed and snapshot ones
+    void addKeywords(const KeywordDB& db);
+    //! Adds the name of every symbol in the AST
+    void addSymbols(ast::node_t* root);
+
+    /*!
+     * Returns up to maxResults names starting with prefix. Shorter names
+     * come first, since they are the closest completions, then names are
+     * sorted alphabetically. A name added as both a keyword and a symbol
+     * is returned for each.
+     */
+    std::vector<Match> complete(std::string_view prefix, std::size_t maxResults) const;
+
+    std::size_t size() const { return entries_.size(); }
+    void clear();
+
+private:
+    struct Entry
+    {
+        uint32_t keyOffset;
+        uint32_t keyLength;
+        uint32_t nameOffset;  // Same as keyOffset if the name is its own key
+        uint32_t nameLength;
+        ast::SymbolType type;
+    };
+
+    void add(std::string_view name, ast::SymbolType type);
+    void sortEntries();
+    std::string_view key(const Entry& entry) const
+        { return std::string_view(strings_.data() + entry.keyOffset, entry.keyLength); }
+
+    std::string strings_;
+    std::vector<Entry> entries_;
+};
+
+}
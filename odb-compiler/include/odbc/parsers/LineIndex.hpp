@@ -0,0 +1,37 @@
+#pragma once
+
+#include "odbc/config.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace odbc {
+
+/*!
+ * Offsets at which the lines of a source start, built in a single
+ * vectorised pass. Turns byte offsets into lines and columns on demand, so
+ * nothing else has to keep track of them while scanning. Lines and columns
+ * count from 1, like the ones in bison's locations.
+ */
+class ODBC_PUBLIC_API LineIndex
+{
+public:
+    LineIndex() : starts_(1, 0) {}
+
+    void build(const char* text, std::size_t size);
+    //! Back to a single empty line
+    void clear() { starts_.assign(1, 0); }
+
+    //! Number of lines. A source ending in '\n' has an empty last line.
+    std::size_t lineCount() const { return starts_.size(); }
+    //! Offset of the first character of a line
+    uint32_t lineStart(std::size_t line) const { return starts_[line - 1]; }
+    //! Line an offset is on. Offsets past the end are on the last line.
+    std::size_t lineOf(uint32_t offset) const;
+    uint32_t columnOf(uint32_t offset) const { return offset - lineStart(lineOf(offset)) + 1; }
+
+private:
+    std::vector<uint32_t> starts_;
+};
+
+}
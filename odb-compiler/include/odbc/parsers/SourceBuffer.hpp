@@ -0,0 +1,51 @@
+#pragma once
+
+#include "odbc/config.hpp"
+#include <cstddef>
+#include <cstdio>
+#include <memory>
+#include <string>
+
+namespace odbc {
+
+/*!
+ * Holds the complete source text of one parse in a form flex can scan in
+ * place (yy_scan_buffer): the text is writable and followed by two NUL
+ * bytes. Files are memory mapped, and the padding bytes come for free from
+ * the zero-filled remainder of the last page unless the file happens to end
+ * right at a page boundary.
+ *
+ * Because the scanner doesn't copy out of the buffer, tokens may point into
+ * it. The buffer must therefore live at least as long as the AST built
+ * from it.
+ */
+class ODBC_PUBLIC_API SourceBuffer
+{
+public:
+    static std::unique_ptr<SourceBuffer> fromFile(const std::string& fileName);
+    static std::unique_ptr<SourceBuffer> fromString(const std::string& str);
+    static std::unique_ptr<SourceBuffer> fromMemory(const char* text, std::size_t size);
+    static std::unique_ptr<SourceBuffer> fromStream(FILE* fp);
+
+    ~SourceBuffer();
+
+    SourceBuffer(const SourceBuffer&) = delete;
+    SourceBuffer& operator=(const SourceBuffer&) = delete;
+
+    //! Start of the source text
+    char* data() { return data_; }
+    const char* data() const { return data_; }
+    //! Length of the source text, not counting the NUL padding
+    std::size_t size() const { return size_; }
+    //! Length including the NUL padding, as yy_scan_buffer() wants it
+    std::size_t scanSize() const { return size_ + 2; }
+
+private:
+    SourceBuffer(char* data, std::size_t size, std::size_t mappedSize);
+
+    char* data_;
+    std::size_t size_;
+    std::size_t mappedSize_;  // 0 if data_ was allocated with malloc
+};
+
+}
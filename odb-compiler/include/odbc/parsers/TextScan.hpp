@@ -0,0 +1,34 @@
+#pragma once
+
+#include "odbc/config.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace odbc {
+
+/*
+ * Helpers the scanners use to step over text that never becomes a token,
+ * like comment bodies and indentation, many bytes at a time instead of one
+ * DFA transition per byte. They use AVX2 when the library is compiled with
+ * it enabled, SSE2 on any other x86-64 build, and plain loops elsewhere.
+ * None of them read past the end of the text they are given.
+ */
+
+//! Returns the first '\n' in [text, end), or end if there is none
+ODBC_PUBLIC_API const char* findNewline(const char* text, const char* end);
+
+//! Returns the first character in [text, end) that isn't a tab, '\r', '\v' or '\f'
+ODBC_PUBLIC_API const char* skipBlanks(const char* text, const char* end);
+
+//! Appends the offset just past every '\n' in the text to lineStarts
+ODBC_PUBLIC_API void findLineStarts(const char* text, std::size_t size, std::vector<uint32_t>* lineStarts);
+
+/*!
+ * Returns the start of the last occurrence of word in [text, end), or
+ * nullptr if there is none. Letters in word must be lower case. They match
+ * either case in text if ignoreCase is set.
+ */
+ODBC_PUBLIC_API const char* findLast(const char* text, const char* end, const char* word, bool ignoreCase);
+
+}
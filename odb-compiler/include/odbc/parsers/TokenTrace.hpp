@@ -0,0 +1,60 @@
+#pragma once
+
+#include "odbc/config.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <vector>
+
+namespace odbc {
+
+/*!
+ * Fixed-size ring buffer of the most recent tokens a scanner produced. The
+ * scanners only feed it when built with ODBC_SCANNER_TRACE, and even then
+ * only while it is enabled, so by default lexing does no tracing work at all.
+ */
+class ODBC_PUBLIC_API TokenTrace
+{
+public:
+    struct Entry
+    {
+        const char* kind;
+        uint32_t offset;    // Byte offset of the token from the start of the input
+        uint32_t length;
+        char text[24];      // First few characters of the token, NUL terminated
+    };
+
+    explicit TokenTrace(std::size_t capacity = 256);
+
+    void setEnabled(bool enable);
+    bool isEnabled() const { return enabled_; }
+
+    //! Called by the scanner for every match so offsets stay correct
+    void advance(std::size_t length) { tokenOffset_ = offset_; offset_ += length; }
+    //! Called by the scanner when it makes the current match longer
+    void extend(std::size_t length) { offset_ += length; }
+    //! Called by the scanner for every match it wants traced
+    void record(const char* kind, const char* text, std::size_t length);
+    //! Restarts offsets at 0. Drivers call this when they start on new input
+    void beginInput() { offset_ = 0; tokenOffset_ = 0; }
+    //! Forgets all entries
+    void clear();
+
+    //! Number of entries currently held
+    std::size_t size() const { return count_; }
+    //! Access entries, 0 being the oldest still held
+    const Entry& operator[](std::size_t i) const;
+
+    void dump(std::ostream& os) const;
+
+private:
+    std::vector<Entry> entries_;
+    std::size_t capacity_;
+    std::size_t head_;
+    std::size_t count_;
+    std::size_t offset_;
+    std::size_t tokenOffset_;
+    bool enabled_;
+};
+
+}
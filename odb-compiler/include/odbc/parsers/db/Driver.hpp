@@ -1,11 +1,21 @@
 #pragma once
 
 #include "odbc/config.hpp"
+#include "odbc/ast/Arena.hpp"
+#include "odbc/ast/SourceSpan.hpp"
+#include "odbc/ast/StringTable.hpp"
+#include "odbc/parsers/LineIndex.hpp"
+#include "odbc/parsers/TokenTrace.hpp"
+#include "odbc/parsers/keywords/CommandTrie.hpp"
 #include "odbc/parsers/db/Scanner.hpp"
 #include "odbc/parsers/db/Parser.y.h"
+#include <functional>
+#include <memory>
 #include <string>
+#include <vector>
 
 namespace odbc {
+class SourceBuffer;
 namespace ast {
     union node_t;
 }
@@ -14,13 +24,105 @@ namespace db {
 class ODBC_PUBLIC_API Driver
 {
 public:
+    /*!
+     * Called for every top-level statement as soon as the parser has reduced
+     * it. Return true to take ownership of the statement. It then stays valid
+     * until freeAST() and can be released early with
+     * ast::freeNodeRecursive(getArena(), stmnt). Return false to have the
+     * driver free it right away.
+     */
+    typedef std::function<bool(ast::node_t* stmnt)> StatementCallback;
+
+    /*!
+     * Called for every error the parser reports. location is a byte span in
+     * the source being parsed, see getLineIndex().
+     */
+    typedef std::function<void(ast::SourceSpan location, const std::string& message)> ErrorCallback;
+
     Driver();
     ~Driver();
 
     bool parseString(const std::string& str);
     bool parseStream(FILE* fp);
+    /*!
+     * Memory maps the file and scans it in place. String literals in the
+     * resulting AST point directly into the mapping.
+     */
+    bool parseFile(const std::string& fileName);
+
+    /*!
+     * Parses each file with its own driver on a pool of worker threads. The
+     * returned vector has one entry per file in the same order as fileNames.
+     * An entry is nullptr if that file failed to parse.
+     * @param threads Number of worker threads. 0 uses one thread per core.
+     * @param commands Command trie given to every driver, see setCommandTrie()
+     */
+    static std::vector<std::unique_ptr<Driver>>
+        parseFiles(const std::vector<std::string>& fileNames, unsigned threads = 0,
+                   const CommandTrie* commands = nullptr);
+
+    /*!
+     * Switches the driver to streaming mode. Top-level statements are passed
+     * to the callback instead of being collected into getAST(), so memory
+     * use is bounded by the largest statement rather than by the size of
+     * the file. Pass an empty callback to go back to building an AST.
+     */
+    void setStatementCallback(StatementCallback callback) { statementCallback_ = std::move(callback); }
+
+    /*!
+     * Hands errors to the callback instead of printing them to stdout. Pass
+     * an empty callback to print them again, which is the default.
+     */
+    void setErrorCallback(ErrorCallback callback) { errorCallback_ = std::move(callback); }
+
+    /*!
+     * Enables the AST cache. After a successful parse, the AST of the source
+     * is written to this directory, keyed by a hash of the source text. When
+     * the same source text is parsed again, the AST is loaded from the cache
+     * and the scanner and parser don't run at all. Pass an empty string to
+     * disable the cache again, which is the default. The directory must
+     * already exist.
+     */
+    void setCacheDirectory(const std::string& dir) { cacheDir_ = dir; }
+
+    /*!
+     * Lets the scanner recognise commands. Wherever a symbol or a reserved
+     * word starts a command in the trie, the longest matching command is
+     * returned as a single COMMAND token carrying its keyword ID. Without a
+     * trie, no COMMAND tokens are produced. The trie is not owned and must
+     * outlive the driver. It is only read, so drivers on different threads
+     * can share one.
+     */
+    void setCommandTrie(const CommandTrie* commands) { commands_ = commands; }
+    const CommandTrie* getCommandTrie() const { return commands_; }
+
+    /*!
+     * Sources of at least this many bytes are split into chunks at line
+     * boundaries, and the chunks are lexed on this many threads before the
+     * tokens are fed to the parser in order. 0 uses one thread per core.
+     * The default is 1, which lexes and parses in lockstep on the calling
+     * thread. Builds with ODBC_SCANNER_TRACE always lex in lockstep so the
+     * trace stays in source order.
+     */
+    void setLexerThreads(unsigned threads, std::size_t minSourceSize = 256 * 1024)
+        { lexerThreads_ = threads; minChunkedSourceSize_ = minSourceSize; }
 
-    ast::node_t* appendBlock(ast::node_t* block);
+    /*!
+     * Used by the scanner. Returns the longest command text starts with.
+     * end is the end of the buffer currently being scanned.
+     */
+    CommandTrie::Match matchCommand(const char* text, const char* end) const;
+
+    /*!
+     * Used by the scanner. Interns a symbol name. While chunks are being
+     * lexed on several threads it returns 0 instead, and the driver interns
+     * the name when it passes the token to the parser.
+     */
+    ast::StringTable::ID internSymbol(const char* text, std::size_t length);
+
+    void appendStatement(ast::node_t* stmnt);
+    //! Used by the parser. Passes the error on to the error callback.
+    void reportError(ast::SourceSpan location, const std::string& message);
     void enterCommandMode() { commandMode_++; }
     void exitCommandMode() { commandMode_--; };
     bool isCommandMode() { return commandMode_ > 0; }
@@ -28,9 +130,51 @@ public:
     ast::node_t* getAST() { return ast_; }
     void freeAST();
 
+    /*!
+     * All nodes and strings of the AST are allocated from this arena. Use
+     * getArena()->peakBytesUsed() to find out how large ASTs get.
+     */
+    ast::Arena* getArena() { return &arena_; }
+
+    //! Symbol and command names of the AST are interned here
+    ast::StringTable* getStringTable() { return &strings_; }
+
+    /*!
+     * Most recent tokens seen by the scanner. Only filled in if the library
+     * was built with ODBC_SCANNER_TRACE and the trace has been enabled.
+     */
+    TokenTrace* getTokenTrace() { return &tokenTrace_; }
+
+    /*!
+     * Where the lines of the most recently parsed source start, for turning
+     * byte offsets into lines and columns in diagnostics.
+     */
+    const LineIndex& getLineIndex() const { return lineIndex_; }
+
+private:
+    bool parseBuffer(std::unique_ptr<SourceBuffer> source);
+    int parseLockstep(SourceBuffer* source);
+    int parseChunked(SourceBuffer* source, unsigned threads);
+    std::string cacheFileName(uint64_t sourceHash) const;
+    bool loadFromCache(uint64_t sourceHash);
+    void saveToCache(uint64_t sourceHash, ast::node_t* firstBlock);
+
 private:
     int commandMode_ = 0;
+    StatementCallback statementCallback_;
+    ErrorCallback errorCallback_;
+    std::string cacheDir_;
+    const CommandTrie* commands_ = nullptr;
+    unsigned lexerThreads_ = 1;
+    std::size_t minChunkedSourceSize_ = 256 * 1024;
+    bool lexingChunks_ = false;
+    ast::Arena arena_;
+    ast::StringTable strings_;
+    TokenTrace tokenTrace_;
+    LineIndex lineIndex_;
     ast::node_t* ast_;
+    // The AST may point into these, so they're kept until freeAST()
+    std::vector<std::unique_ptr<SourceBuffer>> sources_;
     dbscan_t scanner_;
     dbpstate* parser_;
     DBLTYPE location_;
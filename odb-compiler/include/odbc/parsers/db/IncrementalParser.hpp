@@ -0,0 +1,151 @@
+#pragma once
+
+#include "odbc/config.hpp"
+#include "odbc/ast/SourceSpan.hpp"
+#include "odbc/parsers/db/Driver.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace odbc {
+namespace db {
+
+/*!
+ * Keeps the AST of a source up to date while the source is being edited,
+ * for editors and language servers. An edit is widened to whole lines and
+ * to the top-level statements reaching into them. Only that region is
+ * lexed and parsed again, and the statements parsed from it replace the
+ * old ones in the list. Statements after the region keep their nodes.
+ *
+ * The scanner never looks past the end of a line, so the region lexes the
+ * same on its own as it does as part of the whole source. The cost of an
+ * edit therefore depends on the statements it touches and on how far it is
+ * from the previous edit, but not on the size of the source.
+ *
+ * Text that fails to parse is kept as a statement without a block. Every
+ * following edit parses it again together with the edited region until it
+ * parses, because the edit may complete it, e.g. by adding the "loop" of a
+ * "do".
+ *
+ * Edits free the nodes of the statements they replace, and every so often
+ * everything is parsed again to release the memory held by old copies of
+ * the text. Don't keep nodes across edits.
+ */
+class ODBC_PUBLIC_API IncrementalParser
+{
+public:
+    /*!
+     * A top-level statement and where it is in the current source. block is
+     * the AST block holding the statement, or nullptr for text that failed
+     * to parse.
+     */
+    struct Statement
+    {
+        ast::node_t* block;
+        uint32_t offset;
+        uint32_t length;
+    };
+
+    //! An error the parser reported, with its span in the current source
+    struct Error
+    {
+        ast::SourceSpan span;
+        std::string message;
+    };
+
+    IncrementalParser();
+
+    /*!
+     * The driver used to parse each region. Use it to set a command trie
+     * before the first parse. Statements and errors are delivered through
+     * its callbacks, so don't change those.
+     */
+    Driver* getDriver() { return &driver_; }
+
+    //! Replaces the whole source. Returns false if any part failed to parse.
+    bool parse(const char* text, std::size_t size);
+    bool parse(const std::string& text) { return parse(text.data(), text.size()); }
+
+    /*!
+     * Replaces removedLength bytes at offset with insertedLength bytes of
+     * text. offset is in the source before the edit. Returns false if the
+     * edit is out of range or the reparsed region failed to parse. The rest
+     * of the AST is still valid in the second case.
+     */
+    bool edit(uint32_t offset, uint32_t removedLength, const char* text, uint32_t insertedLength);
+
+    //! First block of the top-level statements, like Driver::getAST()
+    ast::node_t* getAST() const;
+
+    std::size_t statementCount() const { return statements_.size(); }
+    Statement statement(std::size_t i) const;
+    //! Index of the statement containing offset, or statementCount()
+    std::size_t statementAt(uint32_t offset) const;
+    //! True if some of the source currently fails to parse
+    bool hasErrors() const { return errorIndex_ != noError; }
+    /*!
+     * Errors the parser reported for the current source. They are not
+     * printed. Failed text is parsed again by every edit, so every edit
+     * replaces them.
+     */
+    const std::vector<Error>& errors() const { return errors_; }
+
+    /*!
+     * Nodes keep the span they were parsed with, which goes stale once an
+     * edit before them moves them. Returns where a node of statement i is in
+     * the current source. Statement i must have a block.
+     */
+    ast::SourceSpan spanOf(const ast::node_t* node, std::size_t i) const;
+
+    //! Region of the current source the most recent parse or edit parsed
+    ast::SourceSpan lastReparsed() const { return lastReparsed_; }
+
+    std::size_t size() const { return text_.size() - (gapEnd_ - gapStart_); }
+    std::string text() const;
+
+private:
+    bool reparseAll();
+    bool reparse(std::size_t first, std::size_t last, uint32_t start, uint32_t end, uint32_t delta);
+    void link(std::size_t first, std::size_t last);
+    void moveShift(std::size_t to);
+    std::size_t firstEndingAfter(uint32_t offset) const;
+
+    char charAt(std::size_t i) const
+        { return i < gapStart_ ? text_[i] : text_[i + (gapEnd_ - gapStart_)]; }
+    uint32_t lineStart(uint32_t offset) const;
+    uint32_t lineEnd(uint32_t offset) const;
+    void copyText(uint32_t begin, uint32_t end, std::string* out) const;
+    void replaceText(uint32_t offset, uint32_t removedLength, const char* text, uint32_t insertedLength);
+    void moveGap(std::size_t offset);
+
+private:
+    static constexpr std::size_t noError = (std::size_t)-1;
+
+    Driver driver_;
+    std::vector<ast::node_t*> parsed_;
+    std::vector<Error> errors_;
+    std::string regionText_;
+    uint32_t regionStart_ = 0;
+
+    // The source is kept in a gap buffer that sits at the most recent edit,
+    // so an edit only moves the text between it and the previous one
+    std::vector<char> text_;
+    std::size_t gapStart_ = 0;
+    std::size_t gapEnd_ = 0;
+
+    // Offsets of statements from shiftFrom_ on are stored without the last
+    // shiftBy_ bytes that edits before them have added or removed. Moving
+    // shiftFrom_ to the next edit only touches the statements in between.
+    // The arithmetic wraps, which is fine because only the sums are used.
+    std::vector<Statement> statements_;
+    std::size_t shiftFrom_ = 0;
+    uint32_t shiftBy_ = 0;
+
+    std::size_t errorIndex_ = noError;
+    std::size_t parsedBytes_ = 0;
+    ast::SourceSpan lastReparsed_ = {0, 0};
+};
+
+}
+}
@@ -0,0 +1,29 @@
+#pragma once
+
+#include "odbc/config.hpp"
+#include <cstddef>
+
+namespace odbc {
+namespace db {
+
+struct ReservedWord
+{
+    const char* name;    // Lower case, also used as the token trace kind
+    int token;           // TOK_* value of the db parser
+    bool caseSensitive;  // Only matches when spelled exactly like name
+    bool value;          // For "true" and "false", which are TOK_BOOLEAN_LITERAL
+};
+
+/*!
+ * The scanner lexes every identifier with a single rule and uses this to
+ * tell reserved words apart from symbols, instead of having one DFA rule
+ * per reserved word. Lookup goes through a perfect hash that is searched
+ * for at compile time, so it costs one hash of the identifier and at most
+ * one string comparison.
+ * @return The reserved word the identifier spells, or nullptr if it is a
+ * symbol.
+ */
+ODBC_PUBLIC_API const ReservedWord* findReservedWord(const char* text, std::size_t length);
+
+}
+}
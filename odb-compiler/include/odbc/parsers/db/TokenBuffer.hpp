@@ -0,0 +1,52 @@
+#pragma once
+
+#include "odbc/config.hpp"
+#include "odbc/parsers/db/Parser.y.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace odbc {
+namespace db {
+
+/*!
+ * Tokens of a db source lexed ahead of the parser, stored as one array per
+ * field. The driver fills one of these per chunk when it lexes a large
+ * source on several threads, and then feeds the tokens to the push parser
+ * in order. Offsets are relative to the start of the whole source.
+ */
+class ODBC_PUBLIC_API TokenBuffer
+{
+public:
+    void push(int token, uint32_t offset, uint32_t length, const DBSTYPE& value);
+    void reserve(std::size_t count);
+    void clear();
+
+    std::size_t size() const { return tokens_.size(); }
+    int token(std::size_t i) const { return tokens_[i]; }
+    uint32_t offset(std::size_t i) const { return offsets_[i]; }
+    uint32_t length(std::size_t i) const { return lengths_[i]; }
+    //! The literal, symbol or keyword the scanner returned with the token
+    DBSTYPE& value(std::size_t i) { return values_[i]; }
+    const DBSTYPE& value(std::size_t i) const { return values_[i]; }
+
+private:
+    std::vector<int16_t> tokens_;
+    std::vector<uint32_t> offsets_;
+    std::vector<uint32_t> lengths_;
+    std::vector<DBSTYPE> values_;
+};
+
+/*!
+ * Splits a source into at most chunkCount pieces of roughly equal size that
+ * can be lexed independently. Every piece starts at the beginning of a line.
+ * The scanner never continues a token or remark past the end of a line, so
+ * each piece lexes the same on its own as it does as part of the source.
+ * @return The offset each piece starts at. The first is always 0, and each
+ * piece ends where the next one starts or at size.
+ */
+ODBC_PUBLIC_API std::vector<std::size_t>
+    splitSource(const char* text, std::size_t size, std::size_t chunkCount);
+
+}
+}
@@ -0,0 +1,89 @@
+#pragma once
+
+#include "odbc/config.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace odbc {
+
+/*!
+ * Case-insensitive trie of command names, used by the db scanner to find
+ * multi-word commands such as "MAKE OBJECT SPHERE" with a single
+ * longest-match lookup instead of gluing symbols together later.
+ *
+ * Names are matched character by character. Letters are compared in upper
+ * case, and any run of spaces and tabs in the text matches the single space
+ * between two words of a name. A match only counts if it doesn't end in the
+ * middle of a word, so "LOAD" doesn't match the start of "LOADED".
+ *
+ * Every name gets a dense ID. IDs are assigned in sorted order, so the same
+ * set of names always produces the same IDs.
+ */
+class ODBC_PUBLIC_API CommandTrie
+{
+public:
+    typedef uint32_t KeywordID;
+    static const KeywordID notFound = 0xFFFFFFFF;
+    //! IDs have to fit into 24 bits so FlatAST can store them
+    static const std::size_t maxSize = 0xFFFFFF;
+
+    struct Match
+    {
+        KeywordID keyword;   // notFound if nothing matched
+        std::size_t length;  // Characters of the text covered by the match
+        uint64_t hash;       // hashKeywordName() of the matched text, can be passed to KeywordDB::lookup()
+    };
+
+    /*!
+     * Builds a trie from a list of names. Names that only differ in case or
+     * whitespace are treated as one. The first one in sorted order is kept.
+     * @return Returns nullptr if there are more than maxSize names.
+     */
+    static std::unique_ptr<CommandTrie> fromNames(std::vector<std::string> names);
+
+    //! Longest name the text starts with
+    Match longestMatch(std::string_view text) const;
+
+    //! Looks up a whole name. Returns notFound if there is no match
+    KeywordID find(std::string_view name) const;
+
+    std::size_t size() const { return names_.size(); }
+    //! Name as it was passed to fromNames()
+    const std::string& name(KeywordID keyword) const { return names_[keyword]; }
+
+    /*!
+     * Hash of all names. Two tries with the same hash assign the same IDs,
+     * so anything storing IDs can use this to check it was made for the same
+     * set of commands.
+     */
+    uint64_t hash() const { return hash_; }
+
+private:
+    typedef uint32_t NodeIndex;
+    static const NodeIndex noNode = 0xFFFFFFFF;
+
+    struct Node
+    {
+        uint32_t firstEdge;  // Edges are sorted by character
+        uint32_t edgeCount;
+        KeywordID keyword;   // Name ending at this node, or notFound
+    };
+
+    CommandTrie();
+    NodeIndex child(NodeIndex node, char c) const;
+
+    std::vector<Node> nodes_;
+    std::vector<char> edgeChars_;
+    std::vector<NodeIndex> edgeTargets_;
+    // Almost every lookup fails on the first character, so the root has a
+    // direct table instead of a search
+    NodeIndex rootChildren_[256];
+    std::vector<std::string> names_;
+    uint64_t hash_;
+};
+
+}
@@ -1,13 +1,16 @@
 #pragma once
 
 #include "odbc/config.hpp"
+#include "odbc/parsers/TokenTrace.hpp"
 #include "odbc/parsers/keywords/Scanner.hpp"
 #include "odbc/parsers/keywords/Parser.y.h"
 #include <string>
+#include <string_view>
 #include <vector>
 
 namespace odbc {
 class KeywordDB;
+class SourceBuffer;
 namespace kw {
 
 class ODBC_PUBLIC_API Driver
@@ -18,30 +21,46 @@ public:
 
     bool parseString(const std::string& str);
     bool parseStream(FILE* fp);
+    bool parseFile(const std::string& fileName);
+    /*!
+     * Scans the buffer in place. Tokens are views into it and are only
+     * copied once, when a finished keyword is handed to the DB, so the
+     * buffer may be released as soon as this returns.
+     */
+    bool parseBuffer(SourceBuffer& source);
 
-    void setKeywordName(char* name);
-    void setHelpFile(char* path);
+    void setKeywordName(std::string_view name);
+    void setHelpFile(std::string_view path);
     void finishKeyword();
 
     void finishOverload();
 
-    void addArg(char* arg);
+    void addArg(std::string_view arg);
     void finishArgs();
 
-    void addRetArg(char* arg);
+    void addRetArg(std::string_view arg);
     void finishRetArgs();
 
+    /*!
+     * Most recent tokens seen by the scanner. Only filled in if the library
+     * was built with ODBC_SCANNER_TRACE and the trace has been enabled.
+     */
+    TokenTrace* getTokenTrace() { return &tokenTrace_; }
+
 private:
     kwscan_t scanner_;
     kwpstate* parser_;
     KWLTYPE location_;
     KeywordDB* db_;
+    TokenTrace tokenTrace_;
 
-    char* keywordName_;
-    char* helpFile_;
+    std::string_view keywordName_;
+    std::string_view helpFile_;
     bool hasReturnType_;
-    std::vector<char*> currentArgList_;
-    std::vector<std::vector<char*>> currentOverloadList_;
+    // Arguments of all overloads of the current keyword, one after the
+    // other. overloadEnds_ holds the end of each overload.
+    std::vector<std::string_view> args_;
+    std::vector<std::size_t> overloadEnds_;
 };
 
 }
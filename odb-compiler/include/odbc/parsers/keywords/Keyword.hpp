@@ -1,16 +1,157 @@
 #pragma once
 
+#include "odbc/config.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
 #include <string>
+#include <string_view>
+#include <utility>
 #include <vector>
 
 namespace odbc {
 
-class Keyword
+/*!
+ * What kind of value an argument takes, as far as overload resolution is
+ * concerned. Any is used for arguments whose description doesn't say, and
+ * accepts everything.
+ */
+enum class KeywordArgType : uint8_t
+{
+    Any,
+    Integer,
+    Float,
+    String
+};
+
+/*!
+ * Works out the type of an argument from its description in a keyword file.
+ * Understands "x as Float", C declarations like "int pdfid" or
+ * "LPSTR filestr2", and DBPro descriptions like "Integer Value" or
+ * "String". Everything else is Any.
+ */
+ODBC_PUBLIC_API KeywordArgType parseKeywordArgType(std::string_view arg);
+
+/*!
+ * Key of an overload in a dispatch table. Made of the number of arguments
+ * in the top byte and two bits per argument type below it, so overloads
+ * with the same arity are next to each other when sorted.
+ */
+ODBC_PUBLIC_API uint64_t keywordDispatchKey(const KeywordArgType* args, std::size_t count);
+
+//! Argument types of one overload
+struct KeywordSignature
+{
+    const KeywordArgType* types;
+    std::size_t count;
+};
+
+/*!
+ * The overload resolution of Keyword::resolveOverload(), on a dispatch
+ * table stored however the caller likes. KeywordSnapshot uses it on its
+ * mapped tables.
+ * @param keyAt Returns the key of dispatch entry i. Keys are sorted.
+ * @param overloadAt Returns the overload of dispatch entry i.
+ * @param signatureOf Returns the KeywordSignature of an overload.
+ * @return Index of the overload, or Keyword::noOverload.
+ */
+template <typename KeyAt, typename OverloadAt, typename SignatureOf>
+int resolveKeywordOverload(std::size_t dispatchSize, KeyAt keyAt, OverloadAt overloadAt,
+                           SignatureOf signatureOf, const KeywordArgType* args, std::size_t count)
+{
+    auto lowerBound = [&](std::size_t lo, uint64_t key) {
+        std::size_t hi = dispatchSize;
+        while (lo < hi)
+        {
+            std::size_t mid = lo + (hi - lo) / 2;
+            if (keyAt(mid) < key)
+                lo = mid + 1;
+            else
+                hi = mid;
+        }
+        return lo;
+    };
+
+    uint64_t key = keywordDispatchKey(args, count);
+    for (std::size_t i = lowerBound(0, key); i != dispatchSize && keyAt(i) == key; ++i)
+    {
+        // Keys only hold the first few types of long argument lists
+        KeywordSignature signature = signatureOf(overloadAt(i));
+        if (signature.count == count && std::equal(signature.types, signature.types + count, args))
+            return (int)overloadAt(i);
+    }
+
+    // All overloads with the same arity share the top byte of the key
+    uint64_t arity = key & (uint64_t(0xFF) << 56);
+    std::size_t begin = lowerBound(0, arity);
+    std::size_t end = dispatchSize;
+    if (arity != (uint64_t(0xFF) << 56))
+        end = lowerBound(begin, arity + (uint64_t(1) << 56));
+
+    int best = -1;
+    std::size_t bestScore = 0;
+    for (std::size_t i = begin; i != end; ++i)
+    {
+        KeywordSignature signature = signatureOf(overloadAt(i));
+        if (signature.count != count)
+            continue;
+
+        std::size_t score = 0;
+        bool callable = true;
+        for (std::size_t a = 0; a != count && callable; ++a)
+        {
+            KeywordArgType param = signature.types[a];
+            if (param == args[a])
+                score++;
+            else if (param == KeywordArgType::String || args[a] == KeywordArgType::String)
+                callable = (param == KeywordArgType::Any || args[a] == KeywordArgType::Any);
+        }
+        if (callable == false)
+            continue;
+
+        int overload = (int)overloadAt(i);
+        if (best == -1 || score > bestScore || (score == bestScore && overload < best))
+        {
+            best = overload;
+            bestScore = score;
+        }
+    }
+
+    return best;
+}
+
+class ODBC_PUBLIC_API Keyword
 {
 public:
+    static const int noOverload = -1;
+
+    /*!
+     * Fills in signatures and the dispatch table from overloads. KeywordDB
+     * does this when a keyword is added, call it again after changing
+     * overloads.
+     */
+    void buildSignatures();
+
+    /*!
+     * Finds the overload to call with arguments of the given types. An
+     * overload whose types all match exactly is found with a binary search.
+     * Otherwise the overload with the right number of arguments and the
+     * most exact matches wins, where Integer and Float convert into each
+     * other and Any matches everything. Ties go to the overload listed
+     * first.
+     * @return Index into overloads, or noOverload if none can be called.
+     */
+    int resolveOverload(const KeywordArgType* args, std::size_t count) const;
+    int resolveOverload(const std::vector<KeywordArgType>& args) const
+        { return resolveOverload(args.data(), args.size()); }
+
     std::string name;
     std::string helpFile;
     std::vector<std::vector<std::string>> overloads;
+    // Argument types of each overload, same order as overloads
+    std::vector<std::vector<KeywordArgType>> signatures;
+    // Overloads sorted by a key made of their arity and argument types
+    std::vector<std::pair<uint64_t, uint32_t>> dispatch;
     bool hasReturnType = false;
 };
 
@@ -0,0 +1,64 @@
+#pragma once
+
+#include "odbc/config.hpp"
+#include <cctype>
+#include <cstdint>
+#include <string_view>
+
+namespace odbc {
+
+/*!
+ * DarkBASIC keywords are case-insensitive and their words may be separated
+ * by any number of spaces and tabs. These helpers hash and compare names as
+ * if they had been upper-cased and had their whitespace collapsed to single
+ * spaces, without making that copy.
+ *
+ * KeywordNameHash can be fed one character at a time, so a scanner can
+ * compute the hash while it reads a command and hand it to
+ * KeywordDB::lookup() afterwards.
+ */
+class KeywordNameHash
+{
+public:
+    void add(char c)
+    {
+        if (c == ' ' || c == '\t')
+        {
+            pendingSpace_ = started_;
+            return;
+        }
+        if (pendingSpace_)
+        {
+            mix(' ');
+            pendingSpace_ = false;
+        }
+        mix((char)toupper((unsigned char)c));
+        started_ = true;
+    }
+
+    void add(std::string_view str)
+    {
+        for (char c : str)
+            add(c);
+    }
+
+    //! Trailing whitespace is ignored, so this can be called at any time
+    uint64_t value() const { return hash_; }
+
+private:
+    void mix(char c)
+    {
+        // FNV-1a, 64-bit
+        hash_ ^= (unsigned char)c;
+        hash_ *= 1099511628211ull;
+    }
+
+    uint64_t hash_ = 14695981039346656037ull;
+    bool started_ = false;
+    bool pendingSpace_ = false;
+};
+
+ODBC_PUBLIC_API uint64_t hashKeywordName(std::string_view name);
+ODBC_PUBLIC_API bool keywordNamesEqual(std::string_view a, std::string_view b);
+
+}
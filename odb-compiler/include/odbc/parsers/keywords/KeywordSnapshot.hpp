@@ -0,0 +1,169 @@
+#pragma once
+
+#include "odbc/config.hpp"
+#include "odbc/parsers/keywords/Keyword.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace odbc {
+class SourceBuffer;
+
+/*!
+ * Read-only, contiguous form of a keyword set. Names, help files and
+ * argument names are stored back to back in a single string pool. Keywords,
+ * overloads and arguments are flat arrays that refer into it. Everything is
+ * returned as a string_view into the pool, so queries never allocate.
+ * The argument types and dispatch table of every keyword are stored too,
+ * so overloads are resolved in place, the same way Keyword does it.
+ *
+ * Names are found through a perfect hash index that is built together with
+ * the snapshot: one hash of the name, two table reads and one string
+ * comparison, no matter how many keywords there are. Nothing is modified
+ * after construction, so a snapshot can be used from any number of threads
+ * without locking.
+ *
+ * A snapshot can be written to a file and mapped back in with load(). The
+ * file is used in place, so loading costs about the same no matter how many
+ * keywords there are. The file records ODBC_VERSION and is rejected by other
+ * versions of the library. The format depends on byte order and is meant to
+ * be generated at build time, not distributed.
+ */
+class ODBC_PUBLIC_API KeywordSnapshot
+{
+public:
+    typedef uint32_t Index;
+    static const Index notFound = 0xFFFFFFFF;
+
+    /*!
+     * Builds a snapshot in memory. Fails if two names differ only in case or
+     * whitespace, because find() couldn't tell them apart.
+     */
+    static std::unique_ptr<KeywordSnapshot> fromKeywords(const std::vector<const Keyword*>& keywords);
+    static std::unique_ptr<KeywordSnapshot> load(const std::string& fileName);
+    //! Writes a snapshot to a file. Fails where fromKeywords() would
+    static bool write(const std::string& fileName, const std::vector<const Keyword*>& keywords);
+    //! Writes this snapshot to a file that load() accepts
+    bool save(const std::string& fileName) const;
+
+    ~KeywordSnapshot();
+
+    KeywordSnapshot(const KeywordSnapshot&) = delete;
+    KeywordSnapshot& operator=(const KeywordSnapshot&) = delete;
+
+    /*!
+     * Looks up a name, ignoring case and differences in whitespace. Returns
+     * notFound if there is no match.
+     */
+    Index find(std::string_view name) const;
+    //! Same as find(name), with hash being hashKeywordName(name)
+    Index find(std::string_view name, uint64_t hash) const;
+
+    //! Number of keywords. They are sorted by name
+    std::size_t size() const { return header_->keywordCount; }
+
+    std::string_view name(Index keyword) const;
+    std::string_view helpFile(Index keyword) const;
+    bool hasReturnType(Index keyword) const { return (keywords_[keyword].flags & HAS_RETURN_TYPE) != 0; }
+
+    std::size_t overloadCount(Index keyword) const { return keywords_[keyword].overloadCount; }
+    std::size_t argCount(Index keyword, std::size_t overload) const;
+    std::string_view arg(Index keyword, std::size_t overload, std::size_t arg) const;
+    //! Type of an argument, as parseKeywordArgType() gives it
+    KeywordArgType argType(Index keyword, std::size_t overload, std::size_t arg) const;
+
+    //! Same as Keyword::resolveOverload(), without copying the keyword out
+    int resolveOverload(Index keyword, const KeywordArgType* args, std::size_t count) const;
+    int resolveOverload(Index keyword, const std::vector<KeywordArgType>& args) const
+        { return resolveOverload(keyword, args.data(), args.size()); }
+
+    //! Copies a keyword out of the snapshot, for code that needs a Keyword
+    Keyword toKeyword(Index keyword) const;
+
+    //! Size of the snapshot's data in bytes
+    std::size_t dataSize() const { return dataSize_; }
+
+private:
+    enum Flags
+    {
+        HAS_RETURN_TYPE = 0x01
+    };
+
+    struct Header
+    {
+        char magic[4];
+        uint32_t formatVersion;
+        uint32_t odbcVersion;
+        uint32_t keywordCount;
+        uint32_t overloadCount;
+        uint32_t argCount;
+        uint32_t stringsSize;
+        uint32_t bucketCount;
+        uint32_t slotCount;
+        uint32_t _reserved;
+    };
+
+    struct KeywordEntry
+    {
+        uint32_t nameOffset;
+        uint32_t nameLength;
+        uint32_t helpFileOffset;
+        uint32_t helpFileLength;
+        uint32_t firstOverload;
+        uint32_t overloadCount;
+        uint32_t flags;
+    };
+
+    struct OverloadEntry
+    {
+        uint32_t firstArg;
+        uint32_t argCount;
+    };
+
+    struct StringEntry
+    {
+        uint32_t offset;
+        uint32_t length;
+    };
+
+    // One per overload. A keyword's entries are at the same indices as its
+    // overloads, sorted by key
+    struct DispatchEntry
+    {
+        uint64_t key;
+        uint32_t overload;
+        uint32_t _reserved;
+    };
+
+    KeywordSnapshot();
+    static bool serialize(const std::vector<const Keyword*>& keywords, std::vector<char>* data);
+    static bool writeFile(const std::string& fileName, const char* data, std::size_t size);
+    static uint32_t slot(uint64_t hash, uint32_t seed, uint32_t slotCount);
+    static bool buildIndex(const std::vector<const Keyword*>& sorted,
+                           std::vector<uint32_t>* buckets, std::vector<uint32_t>* slots);
+    bool setData(const char* data, std::size_t size);
+    std::string_view string(uint32_t offset, uint32_t length) const;
+
+    const Header* header_;
+    const DispatchEntry* dispatch_;
+    const KeywordEntry* keywords_;
+    const OverloadEntry* overloads_;
+    const StringEntry* args_;
+    // Type of each entry of args_
+    const KeywordArgType* argTypes_;
+    // Perfect hash index. A name's hash picks a bucket, the bucket's seed
+    // picks a slot, the slot holds the index of the keyword
+    const uint32_t* buckets_;
+    const uint32_t* slots_;
+    const char* strings_;
+    std::size_t dataSize_;
+
+    // The data either lives in a mapped file or in memory owned here
+    std::unique_ptr<SourceBuffer> mapping_;
+    std::vector<char> owned_;
+};
+
+}
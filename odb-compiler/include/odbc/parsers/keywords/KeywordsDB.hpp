@@ -1,23 +1,200 @@
 #pragma once
 
 #include "odbc/config.hpp"
+#include "odbc/parsers/keywords/CommandTrie.hpp"
 #include "odbc/parsers/keywords/Keyword.hpp"
+#include "odbc/parsers/keywords/KeywordName.hpp"
+#include "odbc/parsers/keywords/KeywordSnapshot.hpp"
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
 #include <unordered_map>
+#include <vector>
 
 namespace odbc {
 
+/*!
+ * A keyword was defined more than once. The first definition is kept.
+ * firstFile is empty if the first definition was added with addKeyword()
+ * directly rather than loaded from a file.
+ */
+struct KeywordConflict
+{
+    std::string name;
+    std::string firstFile;
+    std::string secondFile;
+};
+
+/*!
+ * What loading keywords did, collected in memory as it happens. Nothing is
+ * printed while loading. Callers that want to show something can format
+ * this afterwards.
+ */
+struct KeywordLoadReport
+{
+    struct File
+    {
+        std::string fileName;
+        bool success;
+        std::size_t keywordCount;  // Keywords defined in the file, duplicates included
+        double parseTime;          // Seconds spent parsing the file
+    };
+
+    std::vector<File> files;
+    std::vector<KeywordConflict> conflicts;
+    std::size_t keywordCount = 0;   // Keywords added to the DB
+    std::size_t overloadCount = 0;  // Overloads of those keywords
+};
+
 class KeywordDB
 {
 public:
-    bool loadFromDirectory(const std::string& dir);
+    /*!
+     * Loads every .ini file in a directory. Files are parsed concurrently
+     * but merged in order of their file names, so the result doesn't depend
+     * on timing. If more than one file defines a keyword, the first file
+     * wins and the conflict is recorded in the load report.
+     * @param threads Number of worker threads. 0 uses one thread per core.
+     * @return Returns false if the directory can't be read or any file
+     * failed to parse. Keywords from the other files are still added.
+     */
+    bool loadFromDirectory(const std::string& dir, unsigned threads = 0);
+    /*!
+     * Lazy alternative to loadFromDirectory(). Only the keyword names at the
+     * start of each line of each .ini file are read. A file's overloads are
+     * parsed the first time lookup() returns one of its keywords, so
+     * programs that use a handful of plugins never pay for the rest.
+     * exists() and createCommandTrie() only need names and never parse
+     * anything. Conflicts are found and recorded while indexing. The first
+     * file wins, same as loadFromDirectory(). Indexed keywords count towards
+     * the load report's keywordCount but not its overloadCount.
+     * @return Returns false if the directory or any file can't be read.
+     */
+    bool indexDirectory(const std::string& dir);
     bool appendFromFile(const std::string& fileName);
-    bool exists(const std::string& keyword);
 
-    bool addKeyword(Keyword keyword);
-    const Keyword* lookup(const std::string& keyword) const;
+    /*!
+     * Keywords are found regardless of case and of how much whitespace
+     * separates their words, without allocating. The overloads taking a
+     * hash skip hashing the name. The hash must be hashKeywordName(keyword)
+     * or come from a KeywordNameHash fed with the same characters.
+     * lookup() may parse a file indexed by indexDirectory(), or copy a
+     * keyword out of the snapshot the first time it is asked for. That is
+     * done under a lock, so concurrent lookups stay safe.
+     */
+    bool exists(std::string_view keyword) const;
+    bool exists(std::string_view keyword, uint64_t hash) const;
+    const Keyword* lookup(std::string_view keyword) const;
+    const Keyword* lookup(std::string_view keyword, uint64_t hash) const;
+
+    /*!
+     * Moves every keyword, including those of a loaded snapshot and of
+     * indexed files, which are parsed if they haven't been yet, into one
+     * contiguous read-only KeywordSnapshot with a perfect hash index, and
+     * releases the per-keyword allocations. Afterwards the DB can't be
+     * changed anymore: addKeyword(), appendFromFile(), loadFromDirectory()
+     * and loadSnapshot() fail. All remaining methods are const and safe to
+     * call from any number of threads without locking, so one frozen DB can
+     * be shared by all compiler threads. getSnapshot() queries keywords
+     * without allocating, lookup() still works but copies keywords out of
+     * the snapshot as described there.
+     * @return Returns false if the DB is already frozen.
+     */
+    bool freeze();
+    bool isFrozen() const { return frozen_; }
+
+    /*!
+     * Maps a snapshot written by writeSnapshot() or by the
+     * odbc_keyword_snapshot tool. Its keywords count for exists() and
+     * lookup(), and can be queried through getSnapshot() without any
+     * allocation. Keywords added with addKeyword() win over the snapshot's.
+     */
+    bool loadSnapshot(const std::string& fileName);
+    /*!
+     * For startup. Loads the snapshot if it is newer than dir and every .ini
+     * file in it, otherwise indexes dir with indexDirectory(). A snapshot
+     * that is missing or can't be loaded also falls back to dir. Either
+     * argument may be empty, an empty dir skips the check.
+     * @return Returns false if neither could be loaded completely.
+     */
+    bool loadSnapshotOrDirectory(const std::string& fileName, const std::string& dir);
+    /*!
+     * Writes all keywords added with addKeyword() or indexed by
+     * indexDirectory() to a snapshot file. A frozen DB writes its frozen
+     * snapshot.
+     */
+    bool writeSnapshot(const std::string& fileName) const;
+    const KeywordSnapshot* getSnapshot() const { return snapshot_.get(); }
+
+    /*!
+     * Builds a trie of all keywords, including those of a loaded snapshot
+     * and of indexed files,
+     * for the db scanner to recognise commands with. The trie doesn't refer
+     * back to the DB and can be shared by any number of drivers.
+     */
+    std::unique_ptr<CommandTrie> createCommandTrie() const;
+
+    /*!
+     * Names of all keywords, including those of a loaded snapshot and of
+     * indexed files, in no particular order. Nothing is parsed.
+     */
+    std::vector<std::string> getKeywordNames() const;
+
+    /*!
+     * Moves the keyword into the DB. If a keyword with the same name exists
+     * already, the existing one is kept, the conflict is recorded in the
+     * load report and false is returned. Names that only differ in case or
+     * whitespace are the same name.
+     */
+    bool addKeyword(Keyword&& keyword);
+
+    //! Everything loaded so far. Conflicts are sorted by file
+    const KeywordLoadReport& getLoadReport() const { return report_; }
+    void clearLoadReport() { report_ = KeywordLoadReport(); }
 
 private:
+    //! Whether the name was added, or indexed, without parsing anything
+    bool isKnown(std::string_view keyword, uint64_t hash) const;
+    const Keyword* lookupIndexed(std::string_view keyword, uint64_t hash) const;
+    const Keyword* lookupSnapshot(std::string_view keyword, uint64_t hash) const;
+    //! File a known name was first defined in, for the load report
+    std::string firstFileOf(std::string_view keyword, uint64_t hash) const;
+    std::size_t addKeywordFile(const std::string& fileName);
+
+    struct IndexedFile
+    {
+        std::string fileName;
+        std::unique_ptr<KeywordDB> db;  // Null until the file is first needed
+    };
+    struct IndexedName
+    {
+        std::string name;
+        std::size_t file;
+    };
+    struct AddedKeyword
+    {
+        const Keyword* keyword;
+        std::size_t file;  // Index into keywordFiles_, or noFile
+    };
+    static constexpr std::size_t noFile = (std::size_t)-1;
+
     std::unordered_map<std::string, Keyword> map_;
+    // Keywords of map_ by hashKeywordName() of their name, and the files
+    // they were loaded from
+    std::unordered_multimap<uint64_t, AddedKeyword> index_;
+    std::vector<std::string> keywordFiles_;
+    std::unique_ptr<KeywordSnapshot> snapshot_;
+    // Keywords lookup() copied out of snapshot_
+    mutable std::unordered_map<KeywordSnapshot::Index, Keyword> snapshotKeywords_;
+    mutable std::mutex snapshotMutex_;
+    // Files and names found by indexDirectory(), names by hashKeywordName()
+    mutable std::vector<IndexedFile> indexedFiles_;
+    std::unordered_multimap<uint64_t, IndexedName> indexedNames_;
+    mutable std::mutex indexedMutex_;
+    KeywordLoadReport report_;
+    std::size_t currentFile_ = noFile;
+    bool frozen_ = false;
 };
 
 }
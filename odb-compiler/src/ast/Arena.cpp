@@ -0,0 +1,166 @@
+#include "odbc/ast/Arena.hpp"
+#include "odbc/ast/Node.hpp"
+#include <cstdlib>
+#include <cstring>
+#include <cstdint>
+
+namespace odbc {
+namespace ast {
+
+static const std::size_t chunkHeaderSize =
+    (sizeof(void*) + 2 * sizeof(std::size_t) + alignof(std::max_align_t) - 1) & ~(alignof(std::max_align_t) - 1);
+
+// ----------------------------------------------------------------------------
+Arena::Arena(std::size_t chunkSize) :
+    head_(nullptr),
+    freeNodes_(nullptr),
+    chunkSize_(chunkSize),
+    bytesUsed_(0),
+    bytesReserved_(0),
+    peakBytesUsed_(0)
+{
+}
+
+// ----------------------------------------------------------------------------
+Arena::~Arena()
+{
+    while (head_)
+    {
+        Chunk* next = head_->next;
+        free(head_);
+        head_ = next;
+    }
+}
+
+// ----------------------------------------------------------------------------
+Arena::Chunk* Arena::newChunk(std::size_t size)
+{
+    Chunk* chunk = (Chunk*)malloc(chunkHeaderSize + size);
+    if (chunk == nullptr)
+        return nullptr;
+
+    chunk->next = nullptr;
+    chunk->size = size;
+    chunk->used = 0;
+    bytesReserved_ += size;
+    return chunk;
+}
+
+// ----------------------------------------------------------------------------
+void* Arena::allocate(std::size_t size, std::size_t align)
+{
+    if (head_)
+    {
+        std::uintptr_t base = (std::uintptr_t)head_ + chunkHeaderSize;
+        std::uintptr_t ptr = (base + head_->used + align - 1) & ~(std::uintptr_t)(align - 1);
+        std::size_t end = (std::size_t)(ptr - base) + size;
+        if (end <= head_->size)
+        {
+            bytesUsed_ += end - head_->used;
+            if (peakBytesUsed_ < bytesUsed_)
+                peakBytesUsed_ = bytesUsed_;
+            head_->used = end;
+            return (void*)ptr;
+        }
+    }
+
+    // Oversized requests get a chunk of their own. It is linked in behind the
+    // current chunk so the remaining space in the current chunk isn't lost.
+    if (size + align > chunkSize_ / 4)
+    {
+        Chunk* chunk = newChunk(size + align);
+        if (chunk == nullptr)
+            return nullptr;
+
+        if (head_)
+        {
+            chunk->next = head_->next;
+            head_->next = chunk;
+        }
+        else
+            head_ = chunk;
+
+        std::uintptr_t base = (std::uintptr_t)chunk + chunkHeaderSize;
+        std::uintptr_t ptr = (base + align - 1) & ~(std::uintptr_t)(align - 1);
+        chunk->used = (std::size_t)(ptr - base) + size;
+        bytesUsed_ += chunk->used;
+        if (peakBytesUsed_ < bytesUsed_)
+            peakBytesUsed_ = bytesUsed_;
+        return (void*)ptr;
+    }
+
+    Chunk* chunk = newChunk(chunkSize_);
+    if (chunk == nullptr)
+        return nullptr;
+    chunk->next = head_;
+    head_ = chunk;
+
+    return allocate(size, align);
+}
+
+// ----------------------------------------------------------------------------
+node_t* Arena::allocateNode()
+{
+    if (freeNodes_)
+    {
+        node_t* node = freeNodes_;
+        freeNodes_ = node->base.left;
+        return node;
+    }
+
+    return (node_t*)allocate(sizeof(node_t), alignof(node_t));
+}
+
+// ----------------------------------------------------------------------------
+void Arena::releaseNode(node_t* node)
+{
+    node->base.left = freeNodes_;
+    freeNodes_ = node;
+}
+
+// ----------------------------------------------------------------------------
+char* Arena::strdup(const char* str)
+{
+    return strndup(str, strlen(str));
+}
+
+// ----------------------------------------------------------------------------
+char* Arena::strndup(const char* str, std::size_t len)
+{
+    char* result = (char*)allocate(len + 1, 1);
+    if (result == nullptr)
+        return nullptr;
+
+    memcpy(result, str, len);
+    result[len] = '\0';
+    return result;
+}
+
+// ----------------------------------------------------------------------------
+void Arena::reset()
+{
+    Chunk* keep = nullptr;
+    while (head_)
+    {
+        Chunk* next = head_->next;
+        if (keep == nullptr && head_->size == chunkSize_)
+        {
+            keep = head_;
+            keep->next = nullptr;
+            keep->used = 0;
+        }
+        else
+        {
+            bytesReserved_ -= head_->size;
+            free(head_);
+        }
+        head_ = next;
+    }
+
+    head_ = keep;
+    freeNodes_ = nullptr;
+    bytesUsed_ = 0;
+}
+
+}
+}
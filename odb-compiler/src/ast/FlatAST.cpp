@@ -0,0 +1,482 @@
+#include "odbc/ast/FlatAST.hpp"
+#include "odbc/ast/Arena.hpp"
+#include "odbc/ast/StringTable.hpp"
+#include "odbc/ast/Traversal.hpp"
+#include "odbc/parsers/SourceBuffer.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <unordered_map>
+
+namespace odbc {
+namespace ast {
+
+static_assert(sizeof(FlatAST::Node) == 16, "FlatAST::Node should stay at 16 bytes");
+
+const FlatAST::Index FlatAST::none;
+const uint8_t FlatAST::hasRight;
+const uint16_t FlatAST::longSpan;
+
+namespace {
+/*
+ * Layout of a file written by save(). The header is followed by the node
+ * array, the float array, the long spans, the span lengths and the string
+ * blob, in that order. Everything is stored as it is in memory. Going from
+ * the largest alignment to the smallest keeps every array aligned when the
+ * file is mapped.
+ */
+struct FileHeader
+{
+    char magic[4];
+    uint32_t formatVersion;
+    uint32_t odbcVersion;
+    uint32_t nodeCount;
+    uint64_t sourceHash;
+    uint32_t floatCount;
+    uint32_t stringsSize;
+    uint32_t longSpanCount;
+    uint32_t reserved[3];
+};
+
+const char fileMagic[4] = {'O', 'D', 'B', 'A'};
+const uint32_t fileFormatVersion = 3;
+}
+
+static_assert(sizeof(FileHeader) % 16 == 0, "Nodes following the header must stay aligned");
+
+// ----------------------------------------------------------------------------
+FlatAST::FlatAST() :
+    nodes_(nullptr),
+    spanLengths_(nullptr),
+    longSpans_(nullptr),
+    floats_(nullptr),
+    strings_(nullptr),
+    nodeCount_(0),
+    longSpanCount_(0),
+    floatCount_(0),
+    stringsSize_(0)
+{
+}
+
+// ----------------------------------------------------------------------------
+FlatAST::~FlatAST()
+{
+}
+
+// ----------------------------------------------------------------------------
+static uint32_t appendString(std::vector<char>* strings, const char* str)
+{
+    uint32_t offset = (uint32_t)strings->size();
+    strings->insert(strings->end(), str, str + strlen(str) + 1);
+    return offset;
+}
+
+// ----------------------------------------------------------------------------
+void FlatAST::build(const node_t* root)
+{
+    clear();
+
+    // Equal names have equal IDs, so each name only has to be stored once
+    std::unordered_map<StringTable::ID, uint32_t> nameOffsets;
+    auto nameOffset = [this, &nameOffsets](StringTable::ID id, const char* name) {
+        auto it = nameOffsets.find(id);
+        if (it != nameOffsets.end())
+            return it->second;
+        uint32_t offset = appendString(&ownedStrings_, name);
+        nameOffsets.emplace(id, offset);
+        return offset;
+    };
+
+    // In post-order the indices of a node's children are on top of the
+    // stack when the node itself is visited, right above left
+    std::vector<Index> children;
+    Traversal().postOrder(const_cast<node_t*>(root), [&](node_t* original) {
+        Node node;
+        node.type = (uint8_t)original->info.type;
+        node.subtype = 0;
+        node.flags = 0;
+        node.left = none;
+        node.payload = 0;
+        node.spanOffset = original->info.spanOffset;
+        if (original->base.right)
+        {
+            // Always the node visited last, see hasRight
+            node.type |= hasRight;
+            children.pop_back();
+        }
+        if (original->base.left)
+        {
+            node.left = children.back();
+            children.pop_back();
+        }
+
+        switch (original->info.type)
+        {
+            case NT_OP: {
+                node.subtype = (uint8_t)original->op.operation;
+            } break;
+
+            case NT_SYMBOL: {
+                node.flags = original->symbol.flags;
+                node.payload = nameOffset(original->symbol.nameID, original->symbol.name);
+            } break;
+
+            case NT_COMMAND: {
+                uint32_t keywordID = original->command.keywordID & 0xFFFFFF;
+                node.subtype = (uint8_t)(keywordID >> 16);
+                node.flags = (uint16_t)keywordID;
+                node.payload = nameOffset(original->command.nameID, original->command.name);
+            } break;
+
+            case NT_LITERAL: {
+                node.subtype = (uint8_t)original->literal.type;
+                switch (original->literal.type)
+                {
+                    case LT_BOOLEAN: node.payload = original->literal.value.b ? 1 : 0; break;
+                    case LT_INTEGER: node.payload = (uint32_t)original->literal.value.i; break;
+                    case LT_FLOAT:
+                        node.payload = (uint32_t)ownedFloats_.size();
+                        ownedFloats_.push_back(original->literal.value.f);
+                        break;
+                    case LT_STRING:
+                        node.payload = appendString(&ownedStrings_, original->literal.value.s);
+                        break;
+                }
+            } break;
+
+            case NT_BLOCK:
+            case NT_COMMAND_SYMBOL:
+            case NT_ASSIGNMENT:
+            case NT_BRANCH:
+            case NT_BRANCH_PATHS:
+            case NT_FUNC_RETURN:
+            case NT_SUB_RETURN:
+            case NT_LOOP:
+            case NT_LOOP_WHILE:
+            case NT_LOOP_UNTIL:
+                break;
+        }
+
+        uint32_t spanLength = original->info.spanLength;
+        if (spanLength >= longSpan)
+        {
+            ownedLongSpans_.push_back({(Index)ownedNodes_.size(), spanLength});
+            spanLength = longSpan;
+        }
+        ownedSpanLengths_.push_back((uint16_t)spanLength);
+
+        children.push_back((Index)ownedNodes_.size());
+        ownedNodes_.push_back(node);
+        return true;
+    });
+
+    nodes_ = ownedNodes_.data();
+    nodeCount_ = ownedNodes_.size();
+    spanLengths_ = ownedSpanLengths_.data();
+    longSpans_ = ownedLongSpans_.data();
+    longSpanCount_ = ownedLongSpans_.size();
+    floats_ = ownedFloats_.data();
+    floatCount_ = ownedFloats_.size();
+    strings_ = ownedStrings_.data();
+    stringsSize_ = ownedStrings_.size();
+}
+
+// ----------------------------------------------------------------------------
+node_t* FlatAST::toTree(Arena* arena, StringTable* strings) const
+{
+    if (nodeCount_ == 0)
+        return nullptr;
+
+    // Children come before their parents, so a single forward pass sees
+    // every child before it is needed
+    std::vector<node_t*> converted(nodeCount_);
+    for (Index i = 0; i != nodeCount_; ++i)
+    {
+        const Node& flat = nodes_[i];
+        node_t* node = newNode(arena, type(i),
+                               flat.left != none ? converted[flat.left] : nullptr,
+                               right(i) != none ? converted[right(i)] : nullptr);
+        if (node == nullptr)
+            goto allocFailed;
+        setSpan(node, span(i));
+
+        switch (node->info.type)
+        {
+            case NT_OP: {
+                node->op.operation = (Operation)flat.subtype;
+            } break;
+
+            case NT_SYMBOL: {
+                node->symbol.nameID = strings->intern(&strings_[flat.payload]);
+                node->symbol.name = strings->get(node->symbol.nameID);
+                node->symbol.flags = flat.flags;
+            } break;
+
+            case NT_COMMAND: {
+                node->command.nameID = strings->intern(&strings_[flat.payload]);
+                node->command.name = strings->get(node->command.nameID);
+                node->command.keywordID = keywordID(i);
+            } break;
+
+            case NT_LITERAL: {
+                node->literal.type = (LiteralType)flat.subtype;
+                switch (node->literal.type)
+                {
+                    case LT_BOOLEAN: node->literal.value.b = flat.payload != 0; break;
+                    case LT_INTEGER: node->literal.value.i = (int32_t)flat.payload; break;
+                    case LT_FLOAT: node->literal.value.f = floats_[flat.payload]; break;
+                    case LT_STRING:
+                        if ((node->literal.value.s = arena->strdup(&strings_[flat.payload])) == nullptr)
+                        {
+                            freeNode(arena, node);
+                            goto allocFailed;
+                        }
+                        break;
+                }
+            } break;
+
+            case NT_BLOCK: {
+                node->block.tail = node->block.next ? node->block.next->block.tail : node;
+            } break;
+
+            case NT_COMMAND_SYMBOL:
+            case NT_ASSIGNMENT:
+            case NT_BRANCH:
+            case NT_BRANCH_PATHS:
+            case NT_FUNC_RETURN:
+            case NT_SUB_RETURN:
+            case NT_LOOP:
+            case NT_LOOP_WHILE:
+            case NT_LOOP_UNTIL:
+                break;
+        }
+
+        converted[i] = node;
+    }
+
+    return converted.back();
+
+    // Every node that was converted so far is either a root or reachable
+    // from one that comes after it, so free the ones nobody points to
+    allocFailed:
+    {
+        std::vector<bool> referenced(nodeCount_, false);
+        for (Index i = 0; i != nodeCount_; ++i)
+        {
+            if (converted[i] == nullptr)
+                continue;
+            if (nodes_[i].left != none)
+                referenced[nodes_[i].left] = true;
+            if (right(i) != none)
+                referenced[right(i)] = true;
+        }
+        for (Index i = 0; i != nodeCount_; ++i)
+            if (converted[i] && referenced[i] == false)
+                freeNodeRecursive(arena, converted[i]);
+    }
+    return nullptr;
+}
+
+// ----------------------------------------------------------------------------
+bool FlatAST::save(const std::string& fileName, uint64_t sourceHash) const
+{
+    FileHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, fileMagic, sizeof(fileMagic));
+    header.formatVersion = fileFormatVersion;
+    header.odbcVersion = ODBC_VERSION;
+    header.nodeCount = (uint32_t)nodeCount_;
+    header.sourceHash = sourceHash;
+    header.floatCount = (uint32_t)floatCount_;
+    header.stringsSize = (uint32_t)stringsSize_;
+    header.longSpanCount = (uint32_t)longSpanCount_;
+
+    FILE* fp = fopen(fileName.c_str(), "wb");
+    if (fp == nullptr)
+        return false;
+
+    bool success = fwrite(&header, sizeof(header), 1, fp) == 1
+        && fwrite(nodes_, sizeof(Node), nodeCount_, fp) == nodeCount_
+        && fwrite(floats_, sizeof(double), floatCount_, fp) == floatCount_
+        && (longSpanCount_ == 0 || fwrite(longSpans_, sizeof(LongSpan), longSpanCount_, fp) == longSpanCount_)
+        && fwrite(spanLengths_, sizeof(uint16_t), nodeCount_, fp) == nodeCount_
+        && fwrite(strings_, 1, stringsSize_, fp) == stringsSize_;
+
+    if (fclose(fp) != 0)
+        success = false;
+    if (success == false)
+        remove(fileName.c_str());
+    return success;
+}
+
+// ----------------------------------------------------------------------------
+bool FlatAST::load(const std::string& fileName, uint64_t sourceHash)
+{
+    clear();
+
+    std::unique_ptr<SourceBuffer> mapping = SourceBuffer::fromFile(fileName);
+    if (mapping == nullptr || mapping->size() < sizeof(FileHeader))
+        return false;
+
+    const FileHeader* header = (const FileHeader*)mapping->data();
+    if (memcmp(header->magic, fileMagic, sizeof(fileMagic)) != 0 ||
+        header->formatVersion != fileFormatVersion ||
+        header->odbcVersion != ODBC_VERSION ||
+        header->sourceHash != sourceHash)
+    {
+        return false;
+    }
+
+    std::size_t expectedSize = sizeof(FileHeader)
+        + (std::size_t)header->nodeCount * sizeof(Node)
+        + (std::size_t)header->floatCount * sizeof(double)
+        + (std::size_t)header->longSpanCount * sizeof(LongSpan)
+        + (std::size_t)header->nodeCount * sizeof(uint16_t)
+        + header->stringsSize;
+    if (mapping->size() != expectedSize)
+        return false;
+
+    const char* data = mapping->data() + sizeof(FileHeader);
+    nodes_ = (const Node*)data;
+    nodeCount_ = header->nodeCount;
+    data += nodeCount_ * sizeof(Node);
+    floats_ = (const double*)data;
+    floatCount_ = header->floatCount;
+    data += floatCount_ * sizeof(double);
+    longSpans_ = (const LongSpan*)data;
+    longSpanCount_ = header->longSpanCount;
+    data += longSpanCount_ * sizeof(LongSpan);
+    spanLengths_ = (const uint16_t*)data;
+    data += nodeCount_ * sizeof(uint16_t);
+    strings_ = data;
+    stringsSize_ = header->stringsSize;
+    mapping_ = std::move(mapping);
+
+    if (validate() == false)
+    {
+        clear();
+        return false;
+    }
+
+    return true;
+}
+
+// ----------------------------------------------------------------------------
+bool FlatAST::validate() const
+{
+    // A damaged cache file must not lead toTree() or the accessors out of
+    // bounds, so check every index once up front
+    if (stringsSize_ > 0 && strings_[stringsSize_ - 1] != '\0')
+        return false;
+
+    // Each node must have exactly one parent, or toTree() would share nodes
+    std::vector<bool> referenced(nodeCount_, false);
+    auto reference = [&referenced](Index child, Index parent) {
+        if (child == none)
+            return true;
+        if (child >= parent || referenced[child])
+            return false;
+        referenced[child] = true;
+        return true;
+    };
+
+    std::size_t nextLongSpan = 0;
+    for (Index i = 0; i != nodeCount_; ++i)
+    {
+        const Node& node = nodes_[i];
+        if (type(i) > NT_LITERAL)
+            return false;
+        if ((node.type & hasRight) && i == 0)
+            return false;
+        if (reference(node.left, i) == false || reference(right(i), i) == false)
+            return false;
+
+        if (spanLengths_[i] == longSpan)
+        {
+            if (nextLongSpan == longSpanCount_ || longSpans_[nextLongSpan].node != i)
+                return false;
+            nextLongSpan++;
+        }
+
+        if (type(i) == NT_SYMBOL || type(i) == NT_COMMAND ||
+            (type(i) == NT_LITERAL && node.subtype == LT_STRING))
+        {
+            if (node.payload >= stringsSize_)
+                return false;
+        }
+        else if (type(i) == NT_LITERAL && node.subtype == LT_FLOAT)
+        {
+            if (node.payload >= floatCount_)
+                return false;
+        }
+        else if (type(i) == NT_LITERAL && node.subtype > LT_STRING)
+            return false;
+    }
+
+    return nextLongSpan == longSpanCount_;
+}
+
+// ----------------------------------------------------------------------------
+SourceSpan FlatAST::span(Index i) const
+{
+    if (spanLengths_[i] != longSpan)
+        return {nodes_[i].spanOffset, spanLengths_[i]};
+
+    const LongSpan* found = std::lower_bound(longSpans_, longSpans_ + longSpanCount_, i,
+        [](const LongSpan& span, Index node) { return span.node < node; });
+    return {nodes_[i].spanOffset, found->length};
+}
+
+// ----------------------------------------------------------------------------
+uint32_t FlatAST::keywordID(Index i) const
+{
+    // NO_KEYWORD_ID doesn't fit into 24 bits, so its low bits stand in for it
+    uint32_t id = ((uint32_t)nodes_[i].subtype << 16) | nodes_[i].flags;
+    return id == 0xFFFFFF ? NO_KEYWORD_ID : id;
+}
+
+// ----------------------------------------------------------------------------
+uint64_t FlatAST::hashSource(const char* data, std::size_t size)
+{
+    // FNV-1a, 64-bit
+    uint64_t hash = 14695981039346656037ull;
+    for (std::size_t i = 0; i != size; ++i)
+    {
+        hash ^= (unsigned char)data[i];
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+// ----------------------------------------------------------------------------
+void FlatAST::clear()
+{
+    nodes_ = nullptr;
+    spanLengths_ = nullptr;
+    longSpans_ = nullptr;
+    floats_ = nullptr;
+    strings_ = nullptr;
+    nodeCount_ = 0;
+    longSpanCount_ = 0;
+    floatCount_ = 0;
+    stringsSize_ = 0;
+    ownedNodes_.clear();
+    ownedSpanLengths_.clear();
+    ownedLongSpans_.clear();
+    ownedFloats_.clear();
+    ownedStrings_.clear();
+    mapping_.reset();
+}
+
+// ----------------------------------------------------------------------------
+std::size_t FlatAST::memoryUsage() const
+{
+    return nodeCount_ * sizeof(Node)
+         + nodeCount_ * sizeof(uint16_t)
+         + longSpanCount_ * sizeof(LongSpan)
+         + floatCount_ * sizeof(double)
+         + stringsSize_;
+}
+
+}
+}
@@ -1,41 +1,53 @@
 #include "odbc/ast/Node.hpp"
-#include <cstdlib>
+#include "odbc/ast/Arena.hpp"
+#include "odbc/ast/Traversal.hpp"
 #include <cstring>
+#include <string>
+#include <unordered_map>
+#include <vector>
 #include <cassert>
 
 namespace odbc {
 namespace ast {
 
+static_assert(sizeof(void*) != 8 || sizeof(node_t) == 40, "node_t should stay at 40 bytes");
+
 // ----------------------------------------------------------------------------
 #ifdef ODBC_DOT_EXPORT
-static int nodeGUIDCounter;
-static void dumpToDOTRecursive(std::ostream& os, node_t* node)
+// Nodes don't carry an ID, so the export numbers them in the order it first
+// meets them
+class DOTNodeIDs
+{
+public:
+    int operator()(const node_t* node)
+        { return ids_.emplace(node, (int)ids_.size()).first->second; }
+
+private:
+    std::unordered_map<const node_t*, int> ids_;
+};
+
+// ----------------------------------------------------------------------------
+static void dumpNodeToDOT(std::ostream& os, node_t* node, DOTNodeIDs& id)
 {
     switch (node->info.type)
     {
         case NT_BLOCK: {
-            os << "N" << node->info.guid << " -> N" << node->block.statement->info.guid << "[label=\"stmnt\"];\n";
-            os << "N" << node->info.guid << "[label=\"block (" << node->info.guid << ")\"];\n";
-            dumpToDOTRecursive(os, node->block.statement);
+            os << "N" << id(node) << " -> N" << id(node->block.statement) << "[label=\"stmnt\"];\n";
+            os << "N" << id(node) << "[label=\"block (" << id(node) << ")\"];\n";
             if (node->block.next)
-            {
-                os << "N" << node->info.guid << " -> " << "N" << node->block.next->info.guid << "[label=\"next\"];\n";
-                dumpToDOTRecursive(os, node->block.next);
-            }
+                os << "N" << id(node) << " -> " << "N" << id(node->block.next) << "[label=\"next\"];\n";
         } break;
 
         case NT_ASSIGNMENT: {
-            os << "N" << node->info.guid << " -> " << "N" << node->assignment.symbol->info.guid << "[label=\"symbol\"];\n";
-            os << "N" << node->info.guid << " -> " << "N" << node->assignment.statement->info.guid << "[label=\"expr\"];\n";
-            os << "N" << node->info.guid << "[label=\"=\"];\n";
-            dumpToDOTRecursive(os, node->assignment.symbol);
-            dumpToDOTRecursive(os, node->assignment.statement);
+            os << "N" << id(node) << " -> " << "N" << id(node->assignment.symbol) << "[label=\"symbol\"];\n";
+            os << "N" << id(node) << " -> " << "N" << id(node->assignment.statement) << "[label=\"expr\"];\n";
+            os << "N" << id(node) << "[label=\"=\"];\n";
         } break;
 
         case NT_OP: {
-            os << "N" << node->info.guid << " -> " << "N" << node->op.left->info.guid << "[label=\"left\"];\n";
-            os << "N" << node->info.guid << " -> " << "N" << node->op.right->info.guid << "[label=\"right\"];\n";
-            os << "N" << node->info.guid << "[label=\"";
+            os << "N" << id(node) << " -> " << "N" << id(node->op.left) << "[label=\"left\"];\n";
+            os << "N" << id(node) << " -> " << "N" << id(node->op.right) << "[label=\"right\"];\n";
+            os << "N" << id(node) << "[label=\"";
             switch (node->op.operation)
             {
                 case OP_ADD   : os << "+"; break;
@@ -53,55 +65,37 @@ static void dumpToDOTRecursive(std::ostream& os, node_t* node)
                 default: break;
             }
             os << "\"];\n";
-            dumpToDOTRecursive(os, node->op.left);
-            dumpToDOTRecursive(os, node->op.right);
         } break;
 
         case NT_BRANCH: {
-            os << "N" << node->info.guid << "[label=\"if\"];\n";
-            os << "N" << node->info.guid << " -> " << "N" << node->branch.condition->info.guid << "[label=\"cond\"];\n";
-            dumpToDOTRecursive(os, node->branch.condition);
+            os << "N" << id(node) << "[label=\"if\"];\n";
+            os << "N" << id(node) << " -> " << "N" << id(node->branch.condition) << "[label=\"cond\"];\n";
             if (node->branch.paths)
-            {
-                os << "N" << node->info.guid << " -> " << "N" << node->branch.paths->info.guid << "[label=\"paths\"];\n";
-                dumpToDOTRecursive(os, node->branch.paths);
-            }
+                os << "N" << id(node) << " -> " << "N" << id(node->branch.paths) << "[label=\"paths\"];\n";
         } break;
 
         case NT_BRANCH_PATHS: {
-            os << "N" << node->info.guid << "[label=\"paths\"];\n";
+            os << "N" << id(node) << "[label=\"paths\"];\n";
             if (node->branch_paths.is_true)
-            {
-                os << "N" << node->info.guid << " -> " << "N" << node->branch_paths.is_true->info.guid << " [label=\"true\"];\n";
-                dumpToDOTRecursive(os, node->branch_paths.is_true);
-            }
+                os << "N" << id(node) << " -> " << "N" << id(node->branch_paths.is_true) << " [label=\"true\"];\n";
             if (node->branch_paths.is_false)
-            {
-                os << "N" << node->info.guid << " -> " << "N" << node->branch_paths.is_false->info.guid << " [label=\"false\"];\n";
-                dumpToDOTRecursive(os, node->branch_paths.is_false);
-            }
+                os << "N" << id(node) << " -> " << "N" << id(node->branch_paths.is_false) << " [label=\"false\"];\n";
         } break;
 
         case NT_FUNC_RETURN: {
-            os << "N" << node->info.guid << "[label=\"endfunction\"];\n";
+            os << "N" << id(node) << "[label=\"endfunction\"];\n";
             if (node->func_return.retval)
-            {
-                os << "N" << node->info.guid << " -> " << "N" << node->func_return.retval->info.guid << " [label=\"retval\"];\n";
-                dumpToDOTRecursive(os, node->func_return.retval);
-            }
+                os << "N" << id(node) << " -> " << "N" << id(node->func_return.retval) << " [label=\"retval\"];\n";
         } break;
 
         case NT_SUB_RETURN: {
-            os << "N" << node->info.guid << "[label=\"return\"];\n";
+            os << "N" << id(node) << "[label=\"return\"];\n";
         } break;
 
         case NT_COMMAND: {
-            os << "N" << node->info.guid << "[label=\"command: \\\"" << node->command.name << "\\\"\"];\n";
+            os << "N" << id(node) << "[label=\"command: \\\"" << node->command.name << "\\\"\"];\n";
             if (node->command.args)
-            {
-                os << "N" << node->info.guid << " -> " << "N" << node->command.args->info.guid << " [label=\"args\"];\n";
-                dumpToDOTRecursive(os, node->command.args);
-            }
+                os << "N" << id(node) << " -> " << "N" << id(node->command.args) << " [label=\"args\"];\n";
         } break;
 
         case NT_COMMAND_SYMBOL: {
@@ -109,49 +103,32 @@ static void dumpToDOTRecursive(std::ostream& os, node_t* node)
         } return;
 
         case NT_LOOP: {
-            os << "N" << node->info.guid << "[label = \"loop\"]\n";
+            os << "N" << id(node) << "[label = \"loop\"]\n";
             if (node->loop.body)
-            {
-                os << "N" << node->info.guid << " -> " << "N" << node->loop.body->info.guid << "[label=\"body\"];\n";
-                dumpToDOTRecursive(os, node->loop.body);
-            }
+                os << "N" << id(node) << " -> " << "N" << id(node->loop.body) << "[label=\"body\"];\n";
         } break;
 
         case NT_LOOP_WHILE: {
-            os << "N" << node->info.guid << "[label = \"while\"]\n";
-            os << "N" << node->info.guid << " -> " << "N" << node->loop_while.condition->info.guid << "[label=\"cond\"];\n";
-            dumpToDOTRecursive(os, node->loop_while.condition);
+            os << "N" << id(node) << "[label = \"while\"]\n";
+            os << "N" << id(node) << " -> " << "N" << id(node->loop_while.condition) << "[label=\"cond\"];\n";
             if (node->loop_while.body)
-            {
-                os << "N" << node->info.guid << " -> " << "N" << node->loop_while.body->info.guid << "[label=\"body\"];\n";
-                dumpToDOTRecursive(os, node->loop_while.body);
-            }
+                os << "N" << id(node) << " -> " << "N" << id(node->loop_while.body) << "[label=\"body\"];\n";
         } break;
 
         case NT_LOOP_UNTIL: {
-            os << "N" << node->info.guid << "[label = \"repeat\"]\n";
-            os << "N" << node->info.guid << " -> " << "N" << node->loop_until.condition->info.guid << "[label=\"cond\"];\n";
-            dumpToDOTRecursive(os, node->loop_until.condition);
+            os << "N" << id(node) << "[label = \"repeat\"]\n";
+            os << "N" << id(node) << " -> " << "N" << id(node->loop_until.condition) << "[label=\"cond\"];\n";
             if (node->loop_until.body)
-            {
-                os << "N" << node->info.guid << " -> " << "N" << node->loop_until.body->info.guid << "[label=\"body\"];\n";
-                dumpToDOTRecursive(os, node->loop_until.body);
-            }
+                os << "N" << id(node) << " -> " << "N" << id(node->loop_until.body) << "[label=\"body\"];\n";
         } break;
 
         case NT_SYMBOL: {
             if (node->symbol.data)
-            {
-                os << "N" << node->info.guid << " -> " << "N" << node->symbol.data->info.guid << "[label=\"data\"];\n";
-                dumpToDOTRecursive(os, node->symbol.data);
-            }
+                os << "N" << id(node) << " -> " << "N" << id(node->symbol.data) << "[label=\"data\"];\n";
             if (node->symbol.arglist)
-            {
-                os << "N" << node->info.guid << " -> " << "N" << node->symbol.arglist->info.guid << " [label=\"arglist\"];\n";
-                dumpToDOTRecursive(os, node->symbol.arglist);
-            }
+                os << "N" << id(node) << " -> " << "N" << id(node->symbol.arglist) << " [label=\"arglist\"];\n";
 
-            os << "N" << node->info.guid << " [shape=record, label=\"{\\\"" << node->symbol.name << "\\\"|";
+            os << "N" << id(node) << " [shape=record, label=\"{\\\"" << node->symbol.name << "\\\"|";
             switch (node->symbol.flag.type)
             {
 #define X(name) case name : os << #name; break;
@@ -184,25 +161,31 @@ static void dumpToDOTRecursive(std::ostream& os, node_t* node)
             switch (node->literal.type)
             {
                 case LT_BOOLEAN:
-                    os << "N" << node->info.guid << " [shape=record, label=\"{\\\"" << (node->literal.value.b ? "true" : "false") << "\\\" | LT_BOOLEAN}\"];\n";
+                    os << "N" << id(node) << " [shape=record, label=\"{\\\"" << (node->literal.value.b ? "true" : "false") << "\\\" | LT_BOOLEAN}\"];\n";
                     break;
                 case LT_INTEGER:
-                    os << "N" << node->info.guid << " [shape=record, label=\"{\\\"" << node->literal.value.i << "\\\" | LT_INTEGER}\"];\n";
+                    os << "N" << id(node) << " [shape=record, label=\"{\\\"" << node->literal.value.i << "\\\" | LT_INTEGER}\"];\n";
                     break;
                 case LT_FLOAT:
-                    os << "N" << node->info.guid << " [shape=record, label=\"{\\\"" << node->literal.value.f << "\\\" | LT_FLOAT}\"];\n";
+                    os << "N" << id(node) << " [shape=record, label=\"{\\\"" << node->literal.value.f << "\\\" | LT_FLOAT}\"];\n";
                     break;
                 case LT_STRING:
-                    os << "N" << node->info.guid << " [shape=record, label=\"{\\\"" << node->literal.value.s << "\\\" | LT_STRING}\"];\n";
+                    os << "N" << id(node) << " [shape=record, label=\"{\\\"" << node->literal.value.s << "\\\" | LT_STRING}\"];\n";
                     break;
             }
         } break;
     }
 }
+
+// ----------------------------------------------------------------------------
 void dumpToDOT(std::ostream& os, node_t* root)
 {
     os << std::string("digraph name {\n");
-    dumpToDOTRecursive(os, root);
+    DOTNodeIDs id;
+    Traversal().preOrder(root, [&os, &id](node_t* node) {
+        dumpNodeToDOT(os, node, id);
+        return true;
+    });
     os << std::string("}\n");
 }
 #endif
@@ -211,15 +194,34 @@ void dumpToDOT(std::ostream& os, node_t* root)
 static void init_info(node_t* node, NodeType type)
 {
     node->info.type = type;
-#ifdef ODBC_DOT_EXPORT
-    node->info.guid = nodeGUIDCounter++;
-#endif
+    node->info.spanLength = 0;
+    node->info.spanOffset = 0;
+}
+
+// ----------------------------------------------------------------------------
+void setSpan(node_t* node, SourceSpan span)
+{
+    node->info.spanOffset = span.offset;
+    node->info.spanLength = span.length < 0xFFFFFF ? span.length : 0xFFFFFF;
 }
 
 // ----------------------------------------------------------------------------
-node_t* newOp(node_t* left, node_t* right, Operation op)
+node_t* newNode(Arena* arena, NodeType type, node_t* left, node_t* right)
 {
-    node_t* node = (node_t*)malloc(sizeof *node);
+    node_t* node = arena->allocateNode();
+    if (node == nullptr)
+        return nullptr;
+
+    init_info(node, type);
+    node->base.left = left;
+    node->base.right = right;
+    return node;
+}
+
+// ----------------------------------------------------------------------------
+node_t* newOp(Arena* arena, node_t* left, node_t* right, Operation op)
+{
+    node_t* node = arena->allocateNode();
     if (node == nullptr)
         return nullptr;
 
@@ -231,15 +233,16 @@ node_t* newOp(node_t* left, node_t* right, Operation op)
 }
 
 // ----------------------------------------------------------------------------
-node_t* newSymbol(const char* symbolName, node_t* data, node_t* arglist,
+node_t* newSymbol(Arena* arena, const StringTable* strings, StringTable::ID symbolName, node_t* data, node_t* arglist,
                   SymbolType type, SymbolDataType dataType, SymbolScope scope, SymbolDeclaration declaration)
 {
-    node_t* node = (node_t*)malloc(sizeof *node);
+    node_t* node = arena->allocateNode();
     if (node == nullptr)
         return nullptr;
 
     init_info(node, NT_SYMBOL);
-    node->symbol.name = strdup(symbolName);
+    node->symbol.name = strings->get(symbolName);
+    node->symbol.nameID = symbolName;
     node->symbol.flag.type = type;
     node->symbol.flag.datatype = dataType;
     node->symbol.flag.scope = scope;
@@ -250,74 +253,91 @@ node_t* newSymbol(const char* symbolName, node_t* data, node_t* arglist,
 }
 
 // ----------------------------------------------------------------------------
-static node_t* dupNode(node_t* other)
+static node_t* dupNode(Arena* arena, node_t* other)
 {
-    node_t* left = nullptr;
-    node_t* right = nullptr;
-
-    node_t* node = (node_t*)malloc(sizeof *node);
-    if (node == nullptr)
-        goto allocNodeFailed;
-
-    if (other->base.left)
-        if ((left = dupNode(other->base.left)) == nullptr)
-            goto dupLeftFailed;
-    if (other->base.right)
-        if ((right = node->base.right = dupNode(other->base.right)) == nullptr)
-            goto dupRightFailed;
-
-    init_info(node, other->info.type);
-    switch (node->info.type)
+    // Children are visited first, so by the time a node is copied the
+    // copies of its children are on top of the stack, right above left
+    std::vector<node_t*> copies;
+    bool success = Traversal().postOrder(other, [arena, &copies](node_t* original) {
+        node_t* node = arena->allocateNode();
+        if (node == nullptr)
+            return false;
+
+        node->base.right = nullptr;
+        node->base.left = nullptr;
+        if (original->base.right)
+        {
+            node->base.right = copies.back();
+            copies.pop_back();
+        }
+        if (original->base.left)
+        {
+            node->base.left = copies.back();
+            copies.pop_back();
+        }
+
+        init_info(node, original->info.type);
+        node->info.spanLength = original->info.spanLength;
+        node->info.spanOffset = original->info.spanOffset;
+        switch (node->info.type)
+        {
+            case NT_OP     : {
+                node->op.operation = original->op.operation;
+            } break;
+
+            case NT_SYMBOL : {
+                node->symbol.flags = original->symbol.flags;
+                node->symbol.flag.declaration = SD_REF;
+                node->symbol.flag.scope = SS_LOCAL;
+                node->symbol.name = original->symbol.name;
+                node->symbol.nameID = original->symbol.nameID;
+            } break;
+
+            case NT_LITERAL: {
+                node->literal.type = original->literal.type;
+                node->literal.value = original->literal.value;
+            } break;
+
+            case NT_COMMAND: {
+                node->command.name = original->command.name;
+                node->command.nameID = original->command.nameID;
+                node->command.keywordID = original->command.keywordID;
+            } break;
+
+            case NT_BLOCK: {
+                node->block.tail = node->block.next ? node->block.next->block.tail : node;
+            } break;
+
+            case NT_COMMAND_SYMBOL:
+            case NT_ASSIGNMENT:
+            case NT_BRANCH:
+            case NT_BRANCH_PATHS:
+            case NT_FUNC_RETURN:
+            case NT_SUB_RETURN:
+            case NT_LOOP:
+            case NT_LOOP_WHILE:
+            case NT_LOOP_UNTIL:
+                break;
+        }
+
+        copies.push_back(node);
+        return true;
+    });
+
+    if (success == false)
     {
-        case NT_OP     : {
-            node->op.operation = other->op.operation;
-        } break;
-
-        case NT_SYMBOL : {
-            node->symbol.flags = other->symbol.flags;
-            node->symbol.flag.declaration = SD_REF;
-            node->symbol.flag.scope = SS_LOCAL;
-            node->symbol.name = strdup(other->symbol.name);
-            if (node->symbol.name == nullptr)
-                goto allocSymbolNameFailed;
-        } break;
-
-        case NT_LITERAL: {
-            node->literal.type = other->literal.type;
-            node->literal.value = other->literal.value;
-        } break;
-
-        case NT_COMMAND: {
-            node->command.name = strdup(other->command.name);
-        } break;
-
-        case NT_COMMAND_SYMBOL:
-        case NT_BLOCK:
-        case NT_ASSIGNMENT:
-        case NT_BRANCH:
-        case NT_BRANCH_PATHS:
-        case NT_FUNC_RETURN:
-        case NT_SUB_RETURN:
-        case NT_LOOP:
-        case NT_LOOP_WHILE:
-        case NT_LOOP_UNTIL:
-            break;
+        for (node_t* copy : copies)
+            freeNodeRecursive(arena, copy);
+        return nullptr;
     }
 
-    node->base.left = left;
-    node->base.right = right;
-    return node;
-
-    allocSymbolNameFailed : if (right) freeNodeRecursive(right);
-    dupRightFailed        : if (left) freeNodeRecursive(left);
-    dupLeftFailed         : free(node);
-    allocNodeFailed       : return nullptr;
+    return copies.back();
 }
 
 // ----------------------------------------------------------------------------
-static node_t* newConstant(LiteralType type, literal_value_t value)
+static node_t* newConstant(Arena* arena, LiteralType type, literal_value_t value)
 {
-    node_t* node = (node_t*)malloc(sizeof *node);
+    node_t* node = arena->allocateNode();
     if (node == nullptr)
         return nullptr;
 
@@ -329,16 +349,18 @@ static node_t* newConstant(LiteralType type, literal_value_t value)
     return node;
 }
 
-node_t* newBooleanLiteral(bool b)       { literal_value_t value; value.b = b;         return newConstant(LT_BOOLEAN, value); }
-node_t* newIntegerLiteral(int32_t i)    { literal_value_t value; value.i = i;         return newConstant(LT_INTEGER, value); }
-node_t* newFloatLiteral(double f)       { literal_value_t value; value.f = f;         return newConstant(LT_FLOAT, value); }
-node_t* newStringLiteral(const char* s) { literal_value_t value; value.s = strdup(s); return newConstant(LT_STRING, value); }
+node_t* newBooleanLiteral(Arena* arena, bool b)       { literal_value_t value; value.b = b; return newConstant(arena, LT_BOOLEAN, value); }
+node_t* newIntegerLiteral(Arena* arena, int32_t i)    { literal_value_t value; value.i = i; return newConstant(arena, LT_INTEGER, value); }
+node_t* newFloatLiteral(Arena* arena, double f)       { literal_value_t value; value.f = f; return newConstant(arena, LT_FLOAT, value); }
+node_t* newStringLiteral(Arena* arena, const char* s) { literal_value_t value; value.s = s; return newConstant(arena, LT_STRING, value); }
 
 // ----------------------------------------------------------------------------
-node_t* newAssignment(node_t* symbol, node_t* statement)
+node_t* newAssignment(Arena* arena, node_t* symbol, node_t* statement)
 {
     assert(symbol->info.type == NT_SYMBOL);
-    node_t* ass = (node_t*)malloc(sizeof *ass);
+    node_t* ass = arena->allocateNode();
+    if (ass == nullptr)
+        return nullptr;
     init_info(ass, NT_ASSIGNMENT);
     ass->assignment.symbol = symbol;
     ass->assignment.statement = statement;
@@ -346,12 +368,12 @@ node_t* newAssignment(node_t* symbol, node_t* statement)
 }
 
 // ----------------------------------------------------------------------------
-node_t* newBranch(node_t* condition, node_t* true_branch, node_t* false_branch)
+node_t* newBranch(Arena* arena, node_t* condition, node_t* true_branch, node_t* false_branch)
 {
     node_t* paths = nullptr;
     if (true_branch || false_branch)
     {
-        paths = (node_t*)malloc(sizeof* paths);
+        paths = arena->allocateNode();
         if (paths == nullptr)
             return nullptr;
         init_info(paths, NT_BRANCH_PATHS);
@@ -359,10 +381,11 @@ node_t* newBranch(node_t* condition, node_t* true_branch, node_t* false_branch)
         paths->branch_paths.is_false = false_branch;
     }
 
-    node_t* node = (node_t*)malloc(sizeof *node);
+    node_t* node = arena->allocateNode();
     if (node == nullptr)
     {
-        freeNodeRecursive(paths);
+        if (paths)
+            arena->releaseNode(paths);
         return nullptr;
     }
     init_info(node, NT_BRANCH);
@@ -373,9 +396,9 @@ node_t* newBranch(node_t* condition, node_t* true_branch, node_t* false_branch)
 }
 
 // ----------------------------------------------------------------------------
-node_t* newFuncReturn(node_t* returnValue)
+node_t* newFuncReturn(Arena* arena, node_t* returnValue)
 {
-    node_t* node = (node_t*)malloc(sizeof *node);
+    node_t* node = arena->allocateNode();
     if (node == nullptr)
         return nullptr;
 
@@ -386,9 +409,9 @@ node_t* newFuncReturn(node_t* returnValue)
 }
 
 // ----------------------------------------------------------------------------
-node_t* newSubReturn()
+node_t* newSubReturn(Arena* arena)
 {
-    node_t* node = (node_t*)malloc(sizeof *node);
+    node_t* node = arena->allocateNode();
     if (node == nullptr)
         return nullptr;
 
@@ -399,9 +422,9 @@ node_t* newSubReturn()
 }
 
 // ----------------------------------------------------------------------------
-node_t* newCommandSymbol(node_t* symbol, node_t* nextSymbol)
+node_t* newCommandSymbol(Arena* arena, node_t* symbol, node_t* nextSymbol)
 {
-    node_t* node = (node_t*)malloc(sizeof *node);
+    node_t* node = arena->allocateNode();
     if (node == nullptr)
         return nullptr;
 
@@ -412,57 +435,62 @@ node_t* newCommandSymbol(node_t* symbol, node_t* nextSymbol)
 }
 
 // ----------------------------------------------------------------------------
-static char* symbolListToString(node_t* symbolList)
+static StringTable::ID symbolListToString(StringTable* strings, node_t* symbolList)
 {
     if (symbolList->info.type == NT_SYMBOL)
-        return strdup(symbolList->symbol.name);
+        return symbolList->symbol.nameID;
 
-    int commandStrLen = 0;
-    int symbolCount = 0;
+    std::string commandName;
     for (node_t* commandSymbol = symbolList; commandSymbol; commandSymbol = commandSymbol->command_symbol.next)
     {
         assert(commandSymbol->info.type == NT_COMMAND_SYMBOL);
         node_t* symbol = commandSymbol->command_symbol.symbol;
         assert(symbol->info.type == NT_SYMBOL);
-        commandStrLen += strlen(symbol->symbol.name);
-        symbolCount++;
-    }
-    commandStrLen += symbolCount - 1;   // account for spaces in between each symbol
-
-    char* commandName = (char*)malloc(commandStrLen + 1);
-    *commandName = '\0';
-    for (node_t* commandSymbol = symbolList; commandSymbol; commandSymbol = commandSymbol->command_symbol.next)
-    {
-        node_t* symbol = commandSymbol->command_symbol.symbol;
-        strcat(commandName, symbol->symbol.name);
+        commandName.append(symbol->symbol.name, strings->length(symbol->symbol.nameID));
         if (commandSymbol->command_symbol.next)
-            strcat(commandName, " ");
+            commandName += ' ';
     }
 
-    return commandName;
+    return strings->intern(commandName.data(), commandName.length());
 }
-node_t* newCommand(node_t* symbolList, node_t* arglist)
+node_t* newCommand(Arena* arena, StringTable* strings, node_t* symbolList, node_t* arglist)
 {
-    node_t* node = (node_t*)malloc(sizeof *node);
+    node_t* node = arena->allocateNode();
     if (node == nullptr)
         return nullptr;
 
     init_info(node, NT_COMMAND);
     node->command.args = arglist;
     node->command._padding = nullptr;
-    if ((node->command.name = symbolListToString(symbolList)) == nullptr)
-    {
-        free(node);
+    node->command.nameID = symbolListToString(strings, symbolList);
+    node->command.name = strings->get(node->command.nameID);
+    node->command.keywordID = NO_KEYWORD_ID;
+
+    return node;
+}
+
+// ----------------------------------------------------------------------------
+node_t* newKeywordCommand(Arena* arena, StringTable* strings, uint32_t keywordID, const char* name,
+                          std::size_t nameLength, node_t* arglist)
+{
+    node_t* node = arena->allocateNode();
+    if (node == nullptr)
         return nullptr;
-    }
+
+    init_info(node, NT_COMMAND);
+    node->command.args = arglist;
+    node->command._padding = nullptr;
+    node->command.nameID = strings->intern(name, nameLength);
+    node->command.name = strings->get(node->command.nameID);
+    node->command.keywordID = keywordID;
 
     return node;
 }
 
 // ----------------------------------------------------------------------------
-node_t* newLoop(node_t* block)
+node_t* newLoop(Arena* arena, node_t* block)
 {
-    node_t* node = (node_t*)malloc(sizeof *node);
+    node_t* node = arena->allocateNode();
     if (node == nullptr)
         return nullptr;
 
@@ -473,9 +501,9 @@ node_t* newLoop(node_t* block)
 }
 
 // ----------------------------------------------------------------------------
-node_t* newLoopWhile(node_t* condition, node_t* block)
+node_t* newLoopWhile(Arena* arena, node_t* condition, node_t* block)
 {
-    node_t* node = (node_t*)malloc(sizeof *node);
+    node_t* node = arena->allocateNode();
     if (node == nullptr)
         return nullptr;
 
@@ -486,9 +514,9 @@ node_t* newLoopWhile(node_t* condition, node_t* block)
 }
 
 // ----------------------------------------------------------------------------
-node_t* newLoopUntil(node_t* condition, node_t* block)
+node_t* newLoopUntil(Arena* arena, node_t* condition, node_t* block)
 {
-    node_t* node = (node_t*)malloc(sizeof *node);
+    node_t* node = arena->allocateNode();
     if (node == nullptr)
         return nullptr;
 
@@ -499,90 +527,83 @@ node_t* newLoopUntil(node_t* condition, node_t* block)
 }
 
 // ----------------------------------------------------------------------------
-node_t* newLoopFor(node_t* symbol, node_t* startExpr, node_t* endExpr, node_t* stepExpr, node_t* nextSymbol, node_t* block)
+node_t* newLoopFor(Arena* arena, node_t* symbol, node_t* startExpr, node_t* endExpr, node_t* stepExpr, node_t* nextSymbol, node_t* block)
 {
     assert(symbol->info.type == NT_SYMBOL);
 
     // We need a few copies of the symbol
-    node_t* symbolRef1 = dupNode(symbol);
-    node_t* symbolRef2 = dupNode(symbol);
+    node_t* symbolRef1 = dupNode(arena, symbol);
+    node_t* symbolRef2 = dupNode(arena, symbol);
 
-    node_t* loopInit = newAssignment(symbol, startExpr);
+    node_t* loopInit = newAssignment(arena, symbol, startExpr);
 
     if (stepExpr == nullptr)
-        stepExpr = newIntegerLiteral(1);
+        stepExpr = newIntegerLiteral(arena, 1);
 
-    node_t* addStepStmnt = newOp(symbolRef2, stepExpr, OP_INC);
+    node_t* addStepStmnt = newOp(arena, symbolRef2, stepExpr, OP_INC);
     node_t* loopBody;
     if (block)
-        loopBody = appendStatementToBlock(block, addStepStmnt);
+        loopBody = appendStatementToBlock(arena, block, addStepStmnt);
     else
         loopBody = addStepStmnt;
 
-    node_t* exitCondition = newOp(symbolRef1, endExpr, OP_LE);
-    node_t* loopWithInc = newLoopWhile(exitCondition, loopBody);
-    node_t* loop = newBlock(loopInit, newBlock(loopWithInc, nullptr));
+    node_t* exitCondition = newOp(arena, symbolRef1, endExpr, OP_LE);
+    node_t* loopWithInc = newLoopWhile(arena, exitCondition, loopBody);
+    node_t* loop = newBlock(arena, loopInit, newBlock(arena, loopWithInc, nullptr));
 
-    freeNodeRecursive(nextSymbol);
+    freeNodeRecursive(arena, nextSymbol);
 
     return loop;
 }
 
 // ----------------------------------------------------------------------------
-node_t* newBlock(node_t* expr, node_t* next)
+node_t* newBlock(Arena* arena, node_t* expr, node_t* next)
 {
-    node_t* node = (node_t*)malloc(sizeof *node);
+    node_t* node = arena->allocateNode();
+    if (node == nullptr)
+        return nullptr;
     init_info(node, NT_BLOCK);
     node->block.next = next;
     node->block.statement = expr;
+    node->block.tail = next ? next->block.tail : node;
     return node;
 }
 
 // ----------------------------------------------------------------------------
-node_t* appendStatementToBlock(node_t* block, node_t* expr)
+node_t* appendStatementToBlock(Arena* arena, node_t* block, node_t* expr)
 {
     assert(block->info.type == NT_BLOCK);
-    node_t* last = block;
-    while (last->block.next)
-        last = last->block.next;
+    node_t* last = block->block.tail;
+    assert(last->block.next == nullptr);
 
-    last->block.next = newBlock(expr, nullptr);
+    last->block.next = newBlock(arena, expr, nullptr);
+    block->block.tail = last->block.next;
     return block;
 }
 
 // ----------------------------------------------------------------------------
-node_t* prependStatementToBlock(node_t* block, node_t* expr)
+node_t* prependStatementToBlock(Arena* arena, node_t* block, node_t* expr)
 {
-    node_t* prev = newBlock(expr, block);
+    node_t* prev = newBlock(arena, expr, block);
     return prev;
 }
 
 // ----------------------------------------------------------------------------
-void freeNode(node_t* node)
+void freeNode(Arena* arena, node_t* node)
 {
-    switch (node->info.type)
-    {
-        case NT_SYMBOL          : free(node->symbol.name);     break;
-        case NT_LITERAL         :
-            if (node->literal.type == LT_STRING)
-                free(node->literal.value.s);
-            break;
-
-        default: break;
-    }
-
-    free(node);
+    // Strings are owned by the arena and go away when it is reset
+    arena->releaseNode(node);
 }
 
 // ----------------------------------------------------------------------------
-void freeNodeRecursive(node_t* node)
+void freeNodeRecursive(Arena* arena, node_t* node)
 {
-    if (node == nullptr)
-        return;
-
-    freeNodeRecursive(node->base.left);
-    freeNodeRecursive(node->base.right);
-    freeNode(node);
+    // preOrder() reads the children before visiting, so freeing the node
+    // right away is safe and cheaper than a post-order walk
+    Traversal().preOrder(node, [arena](node_t* node) {
+        freeNode(arena, node);
+        return true;
+    });
 }
 
 }
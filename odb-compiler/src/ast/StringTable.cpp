@@ -0,0 +1,88 @@
+#include "odbc/ast/StringTable.hpp"
+#include "odbc/ast/Arena.hpp"
+#include <algorithm>
+#include <cstring>
+
+namespace odbc {
+namespace ast {
+
+// ----------------------------------------------------------------------------
+static uint32_t hashString(const char* str, std::size_t len)
+{
+    // FNV-1a
+    uint32_t hash = 2166136261u;
+    for (std::size_t i = 0; i != len; ++i)
+    {
+        hash ^= (unsigned char)str[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+// ----------------------------------------------------------------------------
+StringTable::StringTable(Arena* arena) :
+    arena_(arena)
+{
+}
+
+// ----------------------------------------------------------------------------
+StringTable::ID StringTable::intern(const char* str)
+{
+    return intern(str, strlen(str));
+}
+
+// ----------------------------------------------------------------------------
+StringTable::ID StringTable::intern(const char* str, std::size_t len)
+{
+    // Keep the load factor below 1/2
+    if ((strings_.size() + 1) * 2 > slots_.size())
+        grow();
+
+    uint32_t hash = hashString(str, len);
+    std::size_t mask = slots_.size() - 1;
+    for (std::size_t i = hash & mask; ; i = (i + 1) & mask)
+    {
+        uint32_t slot = slots_[i];
+        if (slot == 0)
+        {
+            ID id = (ID)strings_.size();
+            strings_.push_back(arena_->strndup(str, len));
+            lengths_.push_back((uint32_t)len);
+            hashes_.push_back(hash);
+            slots_[i] = id + 1;
+            return id;
+        }
+
+        ID id = slot - 1;
+        if (hashes_[id] == hash && lengths_[id] == len && memcmp(strings_[id], str, len) == 0)
+            return id;
+    }
+}
+
+// ----------------------------------------------------------------------------
+void StringTable::grow()
+{
+    std::size_t newSize = slots_.empty() ? 256 : slots_.size() * 2;
+    slots_.assign(newSize, 0);
+
+    std::size_t mask = newSize - 1;
+    for (ID id = 0; id != (ID)strings_.size(); ++id)
+    {
+        std::size_t i = hashes_[id] & mask;
+        while (slots_[i])
+            i = (i + 1) & mask;
+        slots_[i] = id + 1;
+    }
+}
+
+// ----------------------------------------------------------------------------
+void StringTable::clear()
+{
+    strings_.clear();
+    lengths_.clear();
+    hashes_.clear();
+    std::fill(slots_.begin(), slots_.end(), 0);
+}
+
+}
+}
@@ -1,30 +1,102 @@
 #include "odbc/parsers/db/Driver.hpp"
+#include "odbc/parsers/keywords/KeywordsDB.hpp"
 #include "odbc/ast/Node.hpp"
 #include <stdio.h>
+#include <string.h>
+#include <filesystem>
 #include <fstream>
+#include <iostream>
+#include <memory>
 
+// ----------------------------------------------------------------------------
+// The snapshot generated by the build, and the INI files it was generated
+// from to check it against. Failing that, the installed snapshot.
+static void findKeywords(const char** snapshotFile, const char** keywordDir)
+{
+#if defined(ODBC_BUILD_KEYWORD_SNAPSHOT)
+    if (std::filesystem::exists(ODBC_BUILD_KEYWORD_SNAPSHOT))
+    {
+        *snapshotFile = ODBC_BUILD_KEYWORD_SNAPSHOT;
+        *keywordDir = ODBC_BUILD_KEYWORD_DIR;
+        return;
+    }
+#endif
+#if defined(ODBC_INSTALLED_KEYWORD_SNAPSHOT)
+    *snapshotFile = ODBC_INSTALLED_KEYWORD_SNAPSHOT;
+#endif
+}
+
+// ----------------------------------------------------------------------------
 int main(int argc, char** argv)
 {
-    if (argc < 1)
+    bool traceTokens = false;
+    const char* cacheDir = nullptr;
+    const char* keywordDir = nullptr;
+    const char* snapshotFile = nullptr;
+    const char* fileName = nullptr;
+    for (int i = 1; i < argc; ++i)
     {
-        printf("Usage: %s <db source file>\n", argv[0]);
-        return 1;
+        if (strcmp(argv[i], "--trace-tokens") == 0)
+            traceTokens = true;
+        else if (strcmp(argv[i], "--cache-dir") == 0 && i + 1 < argc)
+            cacheDir = argv[++i];
+        else if (strcmp(argv[i], "--keywords") == 0 && i + 1 < argc)
+            keywordDir = argv[++i];
+        else if (strcmp(argv[i], "--keyword-snapshot") == 0 && i + 1 < argc)
+            snapshotFile = argv[++i];
+        else
+            fileName = argv[i];
     }
 
-    FILE* fp = fopen(argv[1], "r");
-    if (fp == nullptr)
+    if (fileName == nullptr)
     {
-        printf("Failed to open file %s\n", argv[1]);
+        printf("Usage: %s [--trace-tokens] [--cache-dir <dir>] [--keywords <dir>] [--keyword-snapshot <file>] <db source file>\n", argv[0]);
         return 1;
     }
 
+    // Commands are only recognised if there are keywords to match them with.
+    // A snapshot is mapped unless the INI files have changed since it was
+    // written. Those are then indexed instead, the scanner only needs the
+    // names so no overloads are parsed.
+    if (snapshotFile == nullptr && keywordDir == nullptr)
+        findKeywords(&snapshotFile, &keywordDir);
+    std::unique_ptr<odbc::CommandTrie> commands;
+    if (snapshotFile || keywordDir)
+    {
+        odbc::KeywordDB keywords;
+        if (keywords.loadSnapshotOrDirectory(snapshotFile ? snapshotFile : "", keywordDir ? keywordDir : "") == false)
+            printf("Warning: Failed to load some keywords\n");
+        commands = keywords.createCommandTrie();
+    }
+
     odbc::db::Driver driver;
-    driver.parseStream(fp);
+    driver.setCommandTrie(commands.get());
+    driver.setLexerThreads(0);
+    if (cacheDir)
+        driver.setCacheDirectory(cacheDir);
+    if (traceTokens)
+    {
+#if !defined(ODBC_SCANNER_TRACE)
+        printf("Warning: --trace-tokens has no effect, odbc was built without ODBC_SCANNER_TRACE\n");
+#endif
+        driver.getTokenTrace()->setEnabled(true);
+    }
+
+    bool result = driver.parseFile(fileName);
+
+    // Dump the trace even on failure, the tokens leading up to a parse error
+    // are usually what you want to look at
+    if (traceTokens)
+        driver.getTokenTrace()->dump(std::cout);
+
+    if (result == false)
+    {
+        printf("Failed to parse file %s\n", fileName);
+        return 1;
+    }
 
     std::ofstream os("out.dot");
     odbc::ast::dumpToDOT(os, driver.getAST());
 
-    fclose(fp);
-
     return 0;
 }
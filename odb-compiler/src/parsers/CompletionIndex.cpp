@@ -0,0 +1,150 @@
+#include "odbc/parsers/CompletionIndex.hpp"
+#include "odbc/parsers/keywords/KeywordsDB.hpp"
+#include "odbc/ast/Traversal.hpp"
+#include <algorithm>
+#include <cctype>
+
+namespace odbc {
+
+// ----------------------------------------------------------------------------
+static bool isSpace(char c)
+{
+    return c == ' ' || c == '\t';
+}
+
+// ----------------------------------------------------------------------------
+// Upper case with whitespace collapsed to single spaces. Leading whitespace
+// is dropped. Trailing whitespace is kept as one space if keepTrailingSpace
+// is set, since "make " should only complete names with another word after
+// "MAKE".
+static void normalize(std::string_view name, bool keepTrailingSpace, std::string* out)
+{
+    bool pendingSpace = false;
+    for (char c : name)
+    {
+        if (isSpace(c))
+        {
+            pendingSpace = (out->empty() == false);
+            continue;
+        }
+        if (pendingSpace)
+            out->push_back(' ');
+        pendingSpace = false;
+        out->push_back((char)toupper((unsigned char)c));
+    }
+    if (pendingSpace && keepTrailingSpace)
+        out->push_back(' ');
+}
+
+// ----------------------------------------------------------------------------
+void CompletionIndex::addKeywords(const KeywordDB& db)
+{
+    for (const auto& name : db.getKeywordNames())
+        add(name, ast::ST_COMMAND);
+    sortEntries();
+}
+
+// ----------------------------------------------------------------------------
+void CompletionIndex::addSymbols(ast::node_t* root)
+{
+    ast::Traversal().preOrder(root, [this](ast::node_t* node) {
+        if (node->info.type == ast::NT_SYMBOL && node->symbol.name)
+            add(node->symbol.name, node->symbol.flag.type);
+        return true;
+    });
+    sortEntries();
+}
+
+// ----------------------------------------------------------------------------
+void CompletionIndex::clear()
+{
+    strings_.clear();
+    entries_.clear();
+}
+
+// ----------------------------------------------------------------------------
+void CompletionIndex::add(std::string_view name, ast::SymbolType type)
+{
+    Entry entry;
+    entry.keyOffset = (uint32_t)strings_.size();
+    normalize(name, false, &strings_);
+    entry.keyLength = (uint32_t)(strings_.size() - entry.keyOffset);
+    if (entry.keyLength == 0)
+        return;
+
+    // Keyword names are usually upper case already and don't need a copy
+    if (key(entry) == name)
+    {
+        entry.nameOffset = entry.keyOffset;
+        entry.nameLength = entry.keyLength;
+    }
+    else
+    {
+        entry.nameOffset = (uint32_t)strings_.size();
+        entry.nameLength = (uint32_t)name.size();
+        strings_.append(name.data(), name.size());
+    }
+    entry.type = type;
+    entries_.push_back(entry);
+}
+
+// ----------------------------------------------------------------------------
+void CompletionIndex::sortEntries()
+{
+    // The same symbol is referenced all over a program, keep the first one
+    std::stable_sort(entries_.begin(), entries_.end(), [this](const Entry& a, const Entry& b) {
+        int cmp = key(a).compare(key(b));
+        return cmp != 0 ? cmp < 0 : a.type < b.type;
+    });
+    entries_.erase(std::unique(entries_.begin(), entries_.end(), [this](const Entry& a, const Entry& b) {
+        return a.type == b.type && key(a) == key(b);
+    }), entries_.end());
+}
+
+// ----------------------------------------------------------------------------
+std::vector<CompletionIndex::Match> CompletionIndex::complete(std::string_view prefix, std::size_t maxResults) const
+{
+    std::string normalized;
+    normalize(prefix, true, &normalized);
+
+    // Keys starting with the prefix form one range of the sorted entries
+    auto begin = std::lower_bound(entries_.begin(), entries_.end(), normalized,
+        [this](const Entry& entry, const std::string& text) {
+            return key(entry) < text;
+        });
+    auto end = std::upper_bound(begin, entries_.end(), normalized,
+        [this](const std::string& text, const Entry& entry) {
+            return text < key(entry).substr(0, text.size());
+        });
+
+    // Keep the best maxResults in a max-heap, so a short prefix matching
+    // most of the index costs O(n log k) rather than a full sort
+    auto better = [](const Entry* a, const Entry* b) {
+        if (a->keyLength != b->keyLength)
+            return a->keyLength < b->keyLength;
+        return a < b;
+    };
+    std::vector<const Entry*> best;
+    best.reserve(std::min(maxResults, (std::size_t)(end - begin)) + 1);
+    for (auto it = begin; it != end && maxResults > 0; ++it)
+    {
+        if (best.size() == maxResults && better(&*it, best.front()) == false)
+            continue;
+        best.push_back(&*it);
+        std::push_heap(best.begin(), best.end(), better);
+        if (best.size() > maxResults)
+        {
+            std::pop_heap(best.begin(), best.end(), better);
+            best.pop_back();
+        }
+    }
+    std::sort_heap(best.begin(), best.end(), better);
+
+    std::vector<Match> result;
+    result.reserve(best.size());
+    for (const Entry* entry : best)
+        result.push_back({std::string_view(strings_.data() + entry->nameOffset, entry->nameLength), entry->type});
+    return result;
+}
+
+}
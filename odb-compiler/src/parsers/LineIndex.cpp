@@ -0,0 +1,24 @@
+#include "odbc/parsers/LineIndex.hpp"
+#include "odbc/parsers/TextScan.hpp"
+#include <algorithm>
+
+namespace odbc {
+
+// ----------------------------------------------------------------------------
+void LineIndex::build(const char* text, std::size_t size)
+{
+    starts_.clear();
+    // Typical DarkBASIC lines are a few dozen characters long
+    starts_.reserve(size / 32 + 1);
+    starts_.push_back(0);
+    findLineStarts(text, size, &starts_);
+}
+
+// ----------------------------------------------------------------------------
+std::size_t LineIndex::lineOf(uint32_t offset) const
+{
+    // The first line starting after offset is the one after offset's line
+    return std::upper_bound(starts_.begin(), starts_.end(), offset) - starts_.begin();
+}
+
+}
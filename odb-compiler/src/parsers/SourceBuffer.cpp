@@ -0,0 +1,164 @@
+#include "odbc/parsers/SourceBuffer.hpp"
+#include <cstdlib>
+#include <cstring>
+
+#if !defined(_WIN32)
+#   include <fcntl.h>
+#   include <sys/mman.h>
+#   include <sys/stat.h>
+#   include <unistd.h>
+#endif
+
+namespace odbc {
+
+// ----------------------------------------------------------------------------
+SourceBuffer::SourceBuffer(char* data, std::size_t size, std::size_t mappedSize) :
+    data_(data),
+    size_(size),
+    mappedSize_(mappedSize)
+{
+}
+
+// ----------------------------------------------------------------------------
+SourceBuffer::~SourceBuffer()
+{
+#if !defined(_WIN32)
+    if (mappedSize_)
+    {
+        munmap(data_, mappedSize_);
+        return;
+    }
+#endif
+    free(data_);
+}
+
+// ----------------------------------------------------------------------------
+std::unique_ptr<SourceBuffer> SourceBuffer::fromFile(const std::string& fileName)
+{
+#if defined(_WIN32)
+    FILE* fp = fopen(fileName.c_str(), "rb");
+    if (fp == nullptr)
+        return nullptr;
+    std::unique_ptr<SourceBuffer> buffer = fromStream(fp);
+    fclose(fp);
+    return buffer;
+#else
+    int fd = open(fileName.c_str(), O_RDONLY);
+    if (fd < 0)
+        return nullptr;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0)
+    {
+        close(fd);
+        return nullptr;
+    }
+
+    // mmap() can't map empty files
+    std::size_t size = (std::size_t)st.st_size;
+    if (size == 0)
+    {
+        close(fd);
+        return fromString("");
+    }
+
+    // Bytes past the end of the file up to the end of the page read as zero.
+    // Only if there are fewer than two such bytes does an extra zero page
+    // have to be reserved behind the file.
+    std::size_t pageSize = (std::size_t)sysconf(_SC_PAGESIZE);
+    std::size_t paddedSize = size + 2;
+    std::size_t mappedSize = (paddedSize + pageSize - 1) & ~(pageSize - 1);
+    void* data;
+    if (((size + pageSize - 1) & ~(pageSize - 1)) >= paddedSize)
+    {
+        data = mmap(nullptr, mappedSize, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+        if (data == MAP_FAILED)
+        {
+            close(fd);
+            return nullptr;
+        }
+    }
+    else
+    {
+        data = mmap(nullptr, mappedSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (data == MAP_FAILED)
+        {
+            close(fd);
+            return nullptr;
+        }
+        if (mmap(data, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_FIXED, fd, 0) == MAP_FAILED)
+        {
+            munmap(data, mappedSize);
+            close(fd);
+            return nullptr;
+        }
+    }
+
+    // The mapping stays valid after closing the descriptor
+    close(fd);
+    madvise(data, mappedSize, MADV_SEQUENTIAL);
+
+    return std::unique_ptr<SourceBuffer>(new SourceBuffer((char*)data, size, mappedSize));
+#endif
+}
+
+// ----------------------------------------------------------------------------
+std::unique_ptr<SourceBuffer> SourceBuffer::fromString(const std::string& str)
+{
+    return fromMemory(str.data(), str.length());
+}
+
+// ----------------------------------------------------------------------------
+std::unique_ptr<SourceBuffer> SourceBuffer::fromMemory(const char* text, std::size_t size)
+{
+    char* data = (char*)malloc(size + 2);
+    if (data == nullptr)
+        return nullptr;
+
+    memcpy(data, text, size);
+    data[size] = '\0';
+    data[size + 1] = '\0';
+    return std::unique_ptr<SourceBuffer>(new SourceBuffer(data, size, 0));
+}
+
+// ----------------------------------------------------------------------------
+std::unique_ptr<SourceBuffer> SourceBuffer::fromStream(FILE* fp)
+{
+    std::size_t capacity = 64 * 1024;
+    std::size_t size = 0;
+    char* data = (char*)malloc(capacity);
+    if (data == nullptr)
+        return nullptr;
+
+    while (true)
+    {
+        if (capacity - size <= 2)
+        {
+            char* grown = (char*)realloc(data, capacity * 2);
+            if (grown == nullptr)
+            {
+                free(data);
+                return nullptr;
+            }
+            data = grown;
+            capacity *= 2;
+        }
+
+        std::size_t bytesRead = fread(data + size, 1, capacity - size - 2, fp);
+        size += bytesRead;
+        if (bytesRead == 0)
+            break;
+    }
+
+    if (ferror(fp))
+    {
+        free(data);
+        return nullptr;
+    }
+
+    data[size] = '\0';
+    data[size + 1] = '\0';
+    return std::unique_ptr<SourceBuffer>(new SourceBuffer(data, size, 0));
+}
+
+}
@@ -0,0 +1,143 @@
+#include "odbc/parsers/TextScan.hpp"
+#include <cstdint>
+#include <cstring>
+
+// MSVC never defines __SSE2__, but every x64 CPU has it
+#if defined(__AVX2__)
+#   define ODBC_SCAN_AVX2
+#   include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64)
+#   define ODBC_SCAN_SSE2
+#   include <emmintrin.h>
+#endif
+
+#if defined(_MSC_VER)
+#   include <intrin.h>
+#endif
+
+namespace odbc {
+
+// ----------------------------------------------------------------------------
+static inline int firstSetBit(uint32_t mask)
+{
+#if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanForward(&index, mask);
+    return (int)index;
+#else
+    return __builtin_ctz(mask);
+#endif
+}
+
+// ----------------------------------------------------------------------------
+const char* findNewline(const char* text, const char* end)
+{
+    // libc's memchr is already vectorised and hard to beat
+    const void* found = memchr(text, '\n', end - text);
+    return found ? (const char*)found : end;
+}
+
+// ----------------------------------------------------------------------------
+static bool isBlank(char c)
+{
+    return c == '\t' || c == '\r' || c == '\v' || c == '\f';
+}
+
+// ----------------------------------------------------------------------------
+const char* skipBlanks(const char* text, const char* end)
+{
+#if defined(ODBC_SCAN_AVX2)
+    const __m256i tab = _mm256_set1_epi8('\t');
+    const __m256i cr = _mm256_set1_epi8('\r');
+    const __m256i vt = _mm256_set1_epi8('\v');
+    const __m256i ff = _mm256_set1_epi8('\f');
+    while (end - text >= 32)
+    {
+        __m256i chars = _mm256_loadu_si256((const __m256i*)text);
+        __m256i blank = _mm256_or_si256(
+            _mm256_or_si256(_mm256_cmpeq_epi8(chars, tab), _mm256_cmpeq_epi8(chars, cr)),
+            _mm256_or_si256(_mm256_cmpeq_epi8(chars, vt), _mm256_cmpeq_epi8(chars, ff)));
+        uint32_t other = ~(uint32_t)_mm256_movemask_epi8(blank);
+        if (other)
+            return text + firstSetBit(other);
+        text += 32;
+    }
+#elif defined(ODBC_SCAN_SSE2)
+    const __m128i tab = _mm_set1_epi8('\t');
+    const __m128i cr = _mm_set1_epi8('\r');
+    const __m128i vt = _mm_set1_epi8('\v');
+    const __m128i ff = _mm_set1_epi8('\f');
+    while (end - text >= 16)
+    {
+        __m128i chars = _mm_loadu_si128((const __m128i*)text);
+        __m128i blank = _mm_or_si128(
+            _mm_or_si128(_mm_cmpeq_epi8(chars, tab), _mm_cmpeq_epi8(chars, cr)),
+            _mm_or_si128(_mm_cmpeq_epi8(chars, vt), _mm_cmpeq_epi8(chars, ff)));
+        uint32_t other = ~(uint32_t)_mm_movemask_epi8(blank) & 0xFFFF;
+        if (other)
+            return text + firstSetBit(other);
+        text += 16;
+    }
+#endif
+
+    while (text != end && isBlank(*text))
+        text++;
+    return text;
+}
+
+// ----------------------------------------------------------------------------
+void findLineStarts(const char* text, std::size_t size, std::vector<uint32_t>* lineStarts)
+{
+    std::size_t i = 0;
+#if defined(ODBC_SCAN_AVX2)
+    const __m256i newline = _mm256_set1_epi8('\n');
+    for (; i + 32 <= size; i += 32)
+    {
+        __m256i chars = _mm256_loadu_si256((const __m256i*)(text + i));
+        uint32_t mask = (uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(chars, newline));
+        for (; mask; mask &= mask - 1)
+            lineStarts->push_back((uint32_t)(i + firstSetBit(mask) + 1));
+    }
+#elif defined(ODBC_SCAN_SSE2)
+    const __m128i newline = _mm_set1_epi8('\n');
+    for (; i + 16 <= size; i += 16)
+    {
+        __m128i chars = _mm_loadu_si128((const __m128i*)(text + i));
+        uint32_t mask = (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(chars, newline));
+        for (; mask; mask &= mask - 1)
+            lineStarts->push_back((uint32_t)(i + firstSetBit(mask) + 1));
+    }
+#endif
+
+    for (; i != size; ++i)
+        if (text[i] == '\n')
+            lineStarts->push_back((uint32_t)(i + 1));
+}
+
+// ----------------------------------------------------------------------------
+const char* findLast(const char* text, const char* end, const char* word, bool ignoreCase)
+{
+    std::size_t length = strlen(word);
+    if ((std::size_t)(end - text) < length)
+        return nullptr;
+
+    // Only used on single lines, so a plain loop is fine
+    for (const char* start = end - length; ; --start)
+    {
+        std::size_t i = 0;
+        for (; i != length; ++i)
+        {
+            char c = start[i];
+            if (ignoreCase && c >= 'A' && c <= 'Z')
+                c = (char)(c - 'A' + 'a');
+            if (c != word[i])
+                break;
+        }
+        if (i == length)
+            return start;
+        if (start == text)
+            return nullptr;
+    }
+}
+
+}
@@ -0,0 +1,82 @@
+#include "odbc/parsers/TokenTrace.hpp"
+#include <cstring>
+
+namespace odbc {
+
+// ----------------------------------------------------------------------------
+TokenTrace::TokenTrace(std::size_t capacity) :
+    capacity_(capacity > 0 ? capacity : 1),
+    head_(0),
+    count_(0),
+    offset_(0),
+    tokenOffset_(0),
+    enabled_(false)
+{
+}
+
+// ----------------------------------------------------------------------------
+void TokenTrace::setEnabled(bool enable)
+{
+    // Don't pay for the buffer unless someone actually wants a trace
+    if (enable && entries_.empty())
+        entries_.resize(capacity_);
+    enabled_ = enable;
+}
+
+// ----------------------------------------------------------------------------
+void TokenTrace::record(const char* kind, const char* text, std::size_t length)
+{
+    if (!enabled_)
+        return;
+
+    Entry& entry = entries_[head_];
+    entry.kind = kind;
+    entry.offset = (uint32_t)tokenOffset_;
+    entry.length = (uint32_t)length;
+
+    std::size_t textLength = length < sizeof(entry.text) - 1 ? length : sizeof(entry.text) - 1;
+    memcpy(entry.text, text, textLength);
+    entry.text[textLength] = '\0';
+
+    head_ = (head_ + 1) % capacity_;
+    if (count_ < capacity_)
+        count_++;
+}
+
+// ----------------------------------------------------------------------------
+void TokenTrace::clear()
+{
+    head_ = 0;
+    count_ = 0;
+}
+
+// ----------------------------------------------------------------------------
+const TokenTrace::Entry& TokenTrace::operator[](std::size_t i) const
+{
+    return entries_[(head_ + capacity_ - count_ + i) % capacity_];
+}
+
+// ----------------------------------------------------------------------------
+void TokenTrace::dump(std::ostream& os) const
+{
+    for (std::size_t i = 0; i != count_; ++i)
+    {
+        const Entry& entry = (*this)[i];
+        os << entry.offset << "+" << entry.length << " " << entry.kind << ": \"";
+        for (const char* c = entry.text; *c; ++c)
+        {
+            switch (*c)
+            {
+                case '\n' : os << "\\n"; break;
+                case '\t' : os << "\\t"; break;
+                case '"'  : os << "\\\""; break;
+                default   : os << *c; break;
+            }
+        }
+        if (entry.length >= sizeof(entry.text))
+            os << "...";
+        os << "\"\n";
+    }
+}
+
+}
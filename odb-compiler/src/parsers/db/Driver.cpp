@@ -1,22 +1,28 @@
 #include "odbc/parsers/db/Driver.hpp"
+#include "odbc/parsers/SourceBuffer.hpp"
 #include "odbc/parsers/db/Parser.y.h"
+#include "odbc/parsers/db/TokenBuffer.hpp"
+#include "odbc/ast/FlatAST.hpp"
 #include "odbc/ast/Node.hpp"
-#include <cassert>
-
-extern int dbdebug;
+#include <algorithm>
+#include <atomic>
+#include <cinttypes>
+#include <cstdio>
+#include <thread>
 
 namespace odbc {
 namespace db {
 
 // ----------------------------------------------------------------------------
 Driver::Driver() :
+    strings_(&arena_),
     ast_(nullptr),
     location_({})
 {
-    dblex_init(&scanner_);
-    parser_ = dbpstate_new();
+    // Everything the scanner and parser touch lives in these two objects, so
+    // drivers on different threads don't interfere with each other.
     dblex_init_extra(this, &scanner_);
-    dbdebug = 0;
+    parser_ = dbpstate_new();
 }
 
 // ----------------------------------------------------------------------------
@@ -29,59 +35,331 @@ Driver::~Driver()
 
 // ----------------------------------------------------------------------------
 bool Driver::parseString(const std::string& str)
+{
+    return parseBuffer(SourceBuffer::fromString(str));
+}
+
+// ----------------------------------------------------------------------------
+bool Driver::parseStream(FILE* fp)
+{
+    return parseBuffer(SourceBuffer::fromStream(fp));
+}
+
+// ----------------------------------------------------------------------------
+bool Driver::parseFile(const std::string& fileName)
+{
+    return parseBuffer(SourceBuffer::fromFile(fileName));
+}
+
+// ----------------------------------------------------------------------------
+std::vector<std::unique_ptr<Driver>>
+Driver::parseFiles(const std::vector<std::string>& fileNames, unsigned threads,
+                   const CommandTrie* commands)
+{
+    std::vector<std::unique_ptr<Driver>> drivers(fileNames.size());
+
+    if (threads == 0)
+        threads = std::max(std::thread::hardware_concurrency(), 1u);
+    if (threads > fileNames.size())
+        threads = (unsigned)fileNames.size();
+
+    // Workers grab the next file as soon as they're done with the previous
+    // one, so a few large files don't leave the other threads idle. Each
+    // worker only ever writes to the slots it claimed.
+    std::atomic<std::size_t> nextFile(0);
+    auto worker = [&]() {
+        for (std::size_t i = nextFile++; i < fileNames.size(); i = nextFile++)
+        {
+            std::unique_ptr<Driver> driver(new Driver);
+            driver->setCommandTrie(commands);
+            if (driver->parseFile(fileNames[i]))
+                drivers[i] = std::move(driver);
+        }
+    };
+
+    if (threads <= 1)
+    {
+        worker();
+        return drivers;
+    }
+
+    std::vector<std::thread> pool;
+    pool.reserve(threads);
+    for (unsigned t = 0; t != threads; ++t)
+        pool.emplace_back(worker);
+    for (auto& thread : pool)
+        thread.join();
+
+    return drivers;
+}
+
+// ----------------------------------------------------------------------------
+bool Driver::parseBuffer(std::unique_ptr<SourceBuffer> source)
+{
+    if (source == nullptr)
+        return false;
+
+    lineIndex_.build(source->data(), source->size());
+
+    uint64_t sourceHash = 0;
+    ast::node_t* lastBlock = nullptr;
+    if (cacheDir_.empty() == false)
+    {
+        sourceHash = ast::FlatAST::hashSource(source->data(), source->size());
+        // Which commands are recognised depends on the trie, so an AST is
+        // only valid for the trie it was parsed with
+        if (commands_)
+            sourceHash ^= commands_->hash();
+        if (loadFromCache(sourceHash))
+            return true;
+        lastBlock = ast_ ? ast_->block.tail : nullptr;
+    }
+
+    tokenTrace_.beginInput();
+
+#if defined(ODBC_SCANNER_TRACE)
+    unsigned threads = 1;
+#else
+    unsigned threads = lexerThreads_;
+    if (threads == 0)
+        threads = std::max(std::thread::hardware_concurrency(), 1u);
+    if (source->size() < minChunkedSourceSize_)
+        threads = 1;
+#endif
+
+    int parse_result = threads > 1 ?
+        parseChunked(source.get(), threads) :
+        parseLockstep(source.get());
+    sources_.push_back(std::move(source));
+
+    if (parse_result != 0)
+        return false;
+
+    // Statements handed to a callback are gone, so only cache what ended up
+    // in the AST
+    if (cacheDir_.empty() == false && !statementCallback_)
+        saveToCache(sourceHash, lastBlock ? lastBlock->block.next : ast_);
+
+    return true;
+}
+
+// ----------------------------------------------------------------------------
+int Driver::parseLockstep(SourceBuffer* source)
 {
     DBSTYPE pushedValue;
     int pushedChar;
     int parse_result;
 
-    YY_BUFFER_STATE buf = db_scan_bytes(str.data(), str.length(), scanner_);
+    YY_BUFFER_STATE buf = db_scan_buffer(source->data(), source->scanSize(), scanner_);
 
     do
     {
         pushedChar = dblex(&pushedValue, scanner_);
+        if (pushedChar != 0)
+        {
+            location_.offset = (uint32_t)(dbget_text(scanner_) - source->data());
+            location_.length = (uint32_t)dbget_leng(scanner_);
+        }
+        else
+            location_ = {(uint32_t)source->size(), 0};
         parse_result = dbpush_parse(parser_, pushedChar, &pushedValue, &location_, scanner_);
     } while (parse_result == YYPUSH_MORE);
 
     db_delete_buffer(buf, scanner_);
 
-    return parse_result == 0;
+    return parse_result;
 }
 
 // ----------------------------------------------------------------------------
-bool Driver::parseStream(FILE* fp)
+int Driver::parseChunked(SourceBuffer* source, unsigned threads)
 {
-    DBSTYPE pushedValue;
-    int pushedChar;
-    int parse_result;
+    struct Chunk
+    {
+        std::size_t offset;
+        std::unique_ptr<SourceBuffer> text;
+        TokenBuffer tokens;
+    };
 
-    dbset_in(fp, scanner_);
+    // A few chunks per thread so one slow chunk doesn't hold up the rest
+    std::vector<std::size_t> starts = splitSource(source->data(), source->size(), threads * 4);
+    std::vector<Chunk> chunks(starts.size());
+    for (std::size_t i = 0; i != starts.size(); ++i)
+    {
+        std::size_t end = i + 1 < starts.size() ? starts[i + 1] : source->size();
+        chunks[i].offset = starts[i];
+        // The scanner needs two NULs after the text and writes into it, so
+        // every chunk gets its own copy. String literals end up pointing
+        // into these.
+        chunks[i].text = SourceBuffer::fromMemory(source->data() + starts[i], end - starts[i]);
+        if (chunks[i].text == nullptr)
+            return 2;
+    }
 
-    do
+    // Scanner actions only read from the driver while this is set, so one
+    // driver can be the extra of several scanners at once
+    lexingChunks_ = true;
+    std::atomic<std::size_t> nextChunk(0);
+    auto worker = [&]() {
+        dbscan_t scanner;
+        DBSTYPE value;
+        dblex_init_extra(this, &scanner);
+        for (std::size_t i = nextChunk++; i < chunks.size(); i = nextChunk++)
+        {
+            Chunk& chunk = chunks[i];
+            // Roughly one token per 4 bytes of typical DarkBASIC code
+            chunk.tokens.reserve(chunk.text->size() / 4);
+            YY_BUFFER_STATE buf = db_scan_buffer(chunk.text->data(), chunk.text->scanSize(), scanner);
+            for (int token; (token = dblex(&value, scanner)) != 0; )
+            {
+                std::size_t offset = dbget_text(scanner) - chunk.text->data();
+                chunk.tokens.push(token, (uint32_t)(chunk.offset + offset), (uint32_t)dbget_leng(scanner), value);
+            }
+            db_delete_buffer(buf, scanner);
+        }
+        dblex_destroy(scanner);
+    };
+
+    threads = std::min(threads, (unsigned)chunks.size());
+    std::vector<std::thread> pool;
+    pool.reserve(threads - 1);
+    for (unsigned t = 1; t < threads; ++t)
+        pool.emplace_back(worker);
+    worker();
+    for (auto& thread : pool)
+        thread.join();
+    lexingChunks_ = false;
+
+    // Symbols are interned here rather than by the scanner so the string
+    // table is only touched from this thread, which also keeps the IDs in
+    // the same order as when lexing in lockstep
+    int parse_result = YYPUSH_MORE;
+    for (Chunk& chunk : chunks)
     {
-        pushedChar = dblex(&pushedValue, scanner_);
-        parse_result = dbpush_parse(parser_, pushedChar, &pushedValue, &location_, scanner_);
-    } while (parse_result == YYPUSH_MORE);
+        TokenBuffer& tokens = chunk.tokens;
+        for (std::size_t i = 0; i != tokens.size() && parse_result == YYPUSH_MORE; ++i)
+        {
+            int token = tokens.token(i);
+            DBSTYPE& value = tokens.value(i);
+            if (token == TOK_SYMBOL || token == TOK_COMMAND_SYMBOL)
+                value.symbol = strings_.intern(chunk.text->data() + (tokens.offset(i) - chunk.offset), tokens.length(i));
+            location_ = {tokens.offset(i), tokens.length(i)};
+            parse_result = dbpush_parse(parser_, token, &value, &location_, scanner_);
+        }
+        sources_.push_back(std::move(chunk.text));
+    }
+
+    if (parse_result == YYPUSH_MORE)
+    {
+        DBSTYPE value;
+        location_ = {(uint32_t)source->size(), 0};
+        parse_result = dbpush_parse(parser_, 0, &value, &location_, scanner_);
+    }
+
+    return parse_result;
+}
+
+// ----------------------------------------------------------------------------
+CommandTrie::Match Driver::matchCommand(const char* text, const char* end) const
+{
+    return commands_->longestMatch(std::string_view(text, end - text));
+}
+
+// ----------------------------------------------------------------------------
+ast::StringTable::ID Driver::internSymbol(const char* text, std::size_t length)
+{
+    return lexingChunks_ ? 0 : strings_.intern(text, length);
+}
+
+// ----------------------------------------------------------------------------
+std::string Driver::cacheFileName(uint64_t sourceHash) const
+{
+    char name[32];
+    snprintf(name, sizeof(name), "%016" PRIx64 ".odbast", sourceHash);
+    return cacheDir_ + "/" + name;
+}
+
+// ----------------------------------------------------------------------------
+bool Driver::loadFromCache(uint64_t sourceHash)
+{
+    ast::FlatAST flat;
+    if (flat.load(cacheFileName(sourceHash), sourceHash) == false)
+        return false;
 
-    return parse_result == 0;
+    // An empty source has an empty AST, which is still a valid cache entry
+    if (flat.empty())
+        return true;
+
+    ast::node_t* block = flat.toTree(&arena_, &strings_);
+    if (block == nullptr)
+        return false;
+
+    // Feed the statements through appendStatement() so they end up where
+    // they would have if they had been parsed
+    while (block)
+    {
+        ast::node_t* next = block->block.next;
+        appendStatement(block->block.statement);
+        ast::freeNode(&arena_, block);
+        block = next;
+    }
+
+    return true;
 }
 
+// ----------------------------------------------------------------------------
+void Driver::saveToCache(uint64_t sourceHash, ast::node_t* firstBlock)
+{
+    ast::FlatAST flat;
+    flat.build(firstBlock);
+
+    // Write to a temporary file first so other drivers never see a
+    // partially written entry
+    std::string fileName = cacheFileName(sourceHash);
+    char suffix[32];
+    snprintf(suffix, sizeof(suffix), ".%" PRIxPTR, (uintptr_t)this);
+    std::string tmpFileName = fileName + suffix;
+    if (flat.save(tmpFileName, sourceHash) == false)
+        return;
+    if (rename(tmpFileName.c_str(), fileName.c_str()) != 0)
+        remove(tmpFileName.c_str());
+}
 
 // ----------------------------------------------------------------------------
-ast::node_t* Driver::appendBlock(ast::node_t* block)
+void Driver::appendStatement(ast::node_t* stmnt)
 {
-    assert(block->info.type == ast::NT_BLOCK);
+    if (statementCallback_)
+    {
+        if (statementCallback_(stmnt) == false)
+            ast::freeNodeRecursive(&arena_, stmnt);
+        return;
+    }
 
     if (ast_ == nullptr)
-        ast_ = block;
+        ast_ = ast::newBlock(&arena_, stmnt, nullptr);
     else
-        ast_ = ast::appendStatementToBlock(ast_, block);
-    return ast_;
+        ast::appendStatementToBlock(&arena_, ast_, stmnt);
+}
+
+// ----------------------------------------------------------------------------
+void Driver::reportError(ast::SourceSpan location, const std::string& message)
+{
+    if (errorCallback_)
+    {
+        errorCallback_(location, message);
+        return;
+    }
+
+    printf("Error: %zu:%u: %s\n", lineIndex_.lineOf(location.offset),
+           (unsigned)lineIndex_.columnOf(location.offset), message.c_str());
 }
 
 // ----------------------------------------------------------------------------
 void Driver::freeAST()
 {
-    ast::freeNodeRecursive(ast_);
+    strings_.clear();
+    arena_.reset();
+    sources_.clear();
+    lineIndex_.clear();
     ast_ = nullptr;
 }
 
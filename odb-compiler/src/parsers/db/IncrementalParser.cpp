@@ -0,0 +1,369 @@
+#include "odbc/parsers/db/IncrementalParser.hpp"
+#include "odbc/ast/Node.hpp"
+#include <algorithm>
+#include <cstring>
+
+namespace odbc {
+namespace db {
+
+// ----------------------------------------------------------------------------
+IncrementalParser::IncrementalParser()
+{
+    driver_.setStatementCallback([this](ast::node_t* stmnt) {
+        parsed_.push_back(stmnt);
+        return true;
+    });
+    // The driver only sees the region being parsed, so its spans count from
+    // the start of the region
+    driver_.setErrorCallback([this](ast::SourceSpan location, const std::string& message) {
+        location.offset += regionStart_;
+        errors_.push_back({location, message});
+    });
+}
+
+// ----------------------------------------------------------------------------
+bool IncrementalParser::parse(const char* text, std::size_t size)
+{
+    text_.assign(text, text + size);
+    gapStart_ = size;
+    gapEnd_ = size;
+    return reparseAll();
+}
+
+// ----------------------------------------------------------------------------
+bool IncrementalParser::edit(uint32_t offset, uint32_t removedLength, const char* text, uint32_t insertedLength)
+{
+    if (offset > size() || removedLength > size() - offset)
+        return false;
+
+    // Widen the edit to whole lines, then to the statements reaching into
+    // those lines and the rest of their lines. Statements can share a line
+    // when separated by colons, which is why this may take a few rounds.
+    uint32_t start = lineStart(offset);
+    uint32_t end = lineEnd(offset + removedLength);
+    std::size_t first = firstEndingAfter(start);
+    while (first != statements_.size() && statement(first).offset < start)
+    {
+        start = lineStart(statement(first).offset);
+        first = firstEndingAfter(start);
+    }
+    std::size_t last = first;
+    for (; last != statements_.size() && statement(last).offset < end; ++last)
+    {
+        Statement stmnt = statement(last);
+        end = std::max(end, lineEnd(stmnt.offset + stmnt.length));
+    }
+
+    // The edit may complete text that failed to parse, e.g. by adding the
+    // "loop" of a "do", so that is always parsed again with it
+    if (errorIndex_ != noError)
+    {
+        Statement error = statement(errorIndex_);
+        first = std::min(first, errorIndex_);
+        last = std::max(last, errorIndex_ + 1);
+        start = std::min(start, error.offset);
+        end = std::max(end, error.offset + error.length);
+    }
+
+    replaceText(offset, removedLength, text, insertedLength);
+    uint32_t delta = insertedLength - removedLength;
+
+    // Replaced statements go back to the arena, but the copies of the text
+    // they were parsed from stay with the driver until it is reset. Parsing
+    // everything again once those add up to twice the size of the source
+    // keeps the memory bounded, and costs no more than the edits did.
+    if (parsedBytes_ > 2 * size() + 64 * 1024)
+        return reparseAll();
+
+    return reparse(first, last, start, end + delta, delta);
+}
+
+// ----------------------------------------------------------------------------
+ast::node_t* IncrementalParser::getAST() const
+{
+    // At most one entry is an error, so this stops after two steps
+    for (const Statement& stmnt : statements_)
+        if (stmnt.block)
+            return stmnt.block;
+    return nullptr;
+}
+
+// ----------------------------------------------------------------------------
+IncrementalParser::Statement IncrementalParser::statement(std::size_t i) const
+{
+    Statement stmnt = statements_[i];
+    if (i >= shiftFrom_)
+        stmnt.offset += shiftBy_;
+    return stmnt;
+}
+
+// ----------------------------------------------------------------------------
+std::size_t IncrementalParser::statementAt(uint32_t offset) const
+{
+    std::size_t i = firstEndingAfter(offset);
+    if (i != statements_.size() && statement(i).offset <= offset)
+        return i;
+    return statements_.size();
+}
+
+// ----------------------------------------------------------------------------
+ast::SourceSpan IncrementalParser::spanOf(const ast::node_t* node, std::size_t i) const
+{
+    // Everything in a statement was parsed together, so it has all moved by
+    // as much as the statement itself
+    Statement stmnt = statement(i);
+    ast::SourceSpan span = ast::getSpan(node);
+    span.offset += stmnt.offset - ast::getSpan(stmnt.block->block.statement).offset;
+    return span;
+}
+
+// ----------------------------------------------------------------------------
+std::string IncrementalParser::text() const
+{
+    std::string text;
+    copyText(0, (uint32_t)size(), &text);
+    return text;
+}
+
+// ----------------------------------------------------------------------------
+bool IncrementalParser::reparseAll()
+{
+    driver_.freeAST();
+    statements_.clear();
+    shiftFrom_ = 0;
+    shiftBy_ = 0;
+    errorIndex_ = noError;
+    parsedBytes_ = 0;
+    return reparse(0, 0, 0, (uint32_t)size(), 0);
+}
+
+// ----------------------------------------------------------------------------
+bool IncrementalParser::reparse(std::size_t first, std::size_t last, uint32_t start, uint32_t end, uint32_t delta)
+{
+    ast::Arena* arena = driver_.getArena();
+
+    moveShift(last);
+    for (std::size_t i = first; i != last; ++i)
+    {
+        ast::node_t* block = statements_[i].block;
+        if (block == nullptr)
+            continue;
+        block->block.next = nullptr;
+        ast::freeNodeRecursive(arena, block);
+    }
+    errorIndex_ = noError;
+
+    copyText(start, end, &regionText_);
+    regionStart_ = start;
+    parsed_.clear();
+    errors_.clear();
+    bool success = driver_.parseString(regionText_);
+    parsedBytes_ += regionText_.size();
+
+    // Statements reduced before an error are complete and stay. The error
+    // may be on the same line as the last of them though, so whole lines
+    // from the one that statement ends on are given up, along with every
+    // statement reaching into them. Failed text then starts at a line start
+    // the way the widening in edit() expects.
+    uint32_t errorStart = end;
+    if (success == false)
+    {
+        errorStart = start;
+        if (parsed_.empty() == false)
+        {
+            ast::SourceSpan span = ast::getSpan(parsed_.back());
+            errorStart = lineStart(start + span.offset + span.length);
+        }
+        for (; parsed_.empty() == false; parsed_.pop_back())
+        {
+            ast::SourceSpan span = ast::getSpan(parsed_.back());
+            if (start + span.offset + span.length <= errorStart)
+                break;
+            errorStart = std::min(errorStart, lineStart(start + span.offset));
+            ast::freeNodeRecursive(arena, parsed_.back());
+        }
+    }
+
+    std::vector<Statement> inserted;
+    inserted.reserve(parsed_.size() + 1);
+    for (ast::node_t* stmnt : parsed_)
+    {
+        ast::node_t* block = ast::newBlock(arena, stmnt, nullptr);
+        if (block == nullptr)
+        {
+            ast::freeNodeRecursive(arena, stmnt);
+            continue;
+        }
+        ast::SourceSpan span = ast::getSpan(stmnt);
+        inserted.push_back({block, start + span.offset, span.length});
+    }
+    if (inserted.size() != parsed_.size())
+    {
+        // Out of memory. Rather than leave a hole, the whole region becomes
+        // text that failed to parse.
+        for (const Statement& stmnt : inserted)
+            ast::freeNodeRecursive(arena, stmnt.block);
+        inserted.clear();
+        success = false;
+        errorStart = start;
+    }
+    parsed_.clear();
+    if (errorStart != end)
+    {
+        errorIndex_ = first + inserted.size();
+        inserted.push_back({nullptr, errorStart, end - errorStart});
+    }
+
+    // Overwrite the old entries where possible. Inserting or erasing moves
+    // everything after them, which an edit within a statement never needs.
+    std::size_t common = std::min(last - first, inserted.size());
+    std::copy(inserted.begin(), inserted.begin() + common, statements_.begin() + first);
+    if (inserted.size() > common)
+        statements_.insert(statements_.begin() + last, inserted.begin() + common, inserted.end());
+    else
+        statements_.erase(statements_.begin() + first + common, statements_.begin() + last);
+    shiftFrom_ = first + inserted.size();
+    shiftBy_ += delta;
+    link(first, shiftFrom_);
+    lastReparsed_ = {start, end - start};
+
+    return success;
+}
+
+// ----------------------------------------------------------------------------
+void IncrementalParser::link(std::size_t first, std::size_t last)
+{
+    // At most one entry is an error, so the searches for the blocks on
+    // either side of the new ones stop after two steps
+    ast::node_t* prev = nullptr;
+    for (std::size_t i = first; i-- > 0 && prev == nullptr; )
+        prev = statements_[i].block;
+    ast::node_t* next = nullptr;
+    for (std::size_t i = last; i != statements_.size() && next == nullptr; ++i)
+        next = statements_[i].block;
+
+    for (std::size_t i = last; i-- > first; )
+    {
+        ast::node_t* block = statements_[i].block;
+        if (block == nullptr)
+            continue;
+        block->block.next = next;
+        next = block;
+    }
+    if (prev)
+        prev->block.next = next;
+
+    // appendStatementToBlock() expects the first block to know the last one
+    ast::node_t* head = getAST();
+    if (head == nullptr)
+        return;
+    for (std::size_t i = statements_.size(); i-- > 0; )
+        if (statements_[i].block)
+        {
+            head->block.tail = statements_[i].block;
+            break;
+        }
+}
+
+// ----------------------------------------------------------------------------
+void IncrementalParser::moveShift(std::size_t to)
+{
+    for (; shiftFrom_ < to; ++shiftFrom_)
+        statements_[shiftFrom_].offset += shiftBy_;
+    while (shiftFrom_ > to)
+        statements_[--shiftFrom_].offset -= shiftBy_;
+}
+
+// ----------------------------------------------------------------------------
+std::size_t IncrementalParser::firstEndingAfter(uint32_t offset) const
+{
+    // Statements don't overlap, so their ends are sorted too
+    std::size_t lo = 0;
+    std::size_t hi = statements_.size();
+    while (lo < hi)
+    {
+        std::size_t mid = lo + (hi - lo) / 2;
+        Statement stmnt = statement(mid);
+        if (stmnt.offset + stmnt.length > offset)
+            hi = mid;
+        else
+            lo = mid + 1;
+    }
+    return lo;
+}
+
+// ----------------------------------------------------------------------------
+uint32_t IncrementalParser::lineStart(uint32_t offset) const
+{
+    while (offset > 0 && charAt(offset - 1) != '\n')
+        offset--;
+    return offset;
+}
+
+// ----------------------------------------------------------------------------
+uint32_t IncrementalParser::lineEnd(uint32_t offset) const
+{
+    uint32_t end = (uint32_t)size();
+    while (offset < end && charAt(offset) != '\n')
+        offset++;
+    return offset < end ? offset + 1 : end;
+}
+
+// ----------------------------------------------------------------------------
+void IncrementalParser::copyText(uint32_t begin, uint32_t end, std::string* out) const
+{
+    out->clear();
+    out->reserve(end - begin);
+    if (begin < gapStart_)
+        out->append(text_.data() + begin, std::min<std::size_t>(end, gapStart_) - begin);
+    if (end > gapStart_)
+    {
+        std::size_t gap = gapEnd_ - gapStart_;
+        std::size_t from = std::max<std::size_t>(begin, gapStart_);
+        out->append(text_.data() + from + gap, end - from);
+    }
+}
+
+// ----------------------------------------------------------------------------
+void IncrementalParser::replaceText(uint32_t offset, uint32_t removedLength, const char* text, uint32_t insertedLength)
+{
+    moveGap(offset);
+    gapEnd_ += removedLength;
+
+    if (gapEnd_ - gapStart_ < insertedLength)
+    {
+        // Grow by a fraction of the source so typing doesn't reallocate
+        // on every key
+        std::size_t after = text_.size() - gapEnd_;
+        std::size_t gap = insertedLength + size() / 16 + 4096;
+        text_.resize(gapStart_ + gap + after);
+        std::memmove(text_.data() + text_.size() - after, text_.data() + gapEnd_, after);
+        gapEnd_ = text_.size() - after;
+    }
+
+    if (insertedLength > 0)
+        std::memcpy(text_.data() + gapStart_, text, insertedLength);
+    gapStart_ += insertedLength;
+}
+
+// ----------------------------------------------------------------------------
+void IncrementalParser::moveGap(std::size_t offset)
+{
+    if (offset < gapStart_)
+    {
+        std::size_t count = gapStart_ - offset;
+        std::memmove(text_.data() + gapEnd_ - count, text_.data() + offset, count);
+        gapStart_ -= count;
+        gapEnd_ -= count;
+    }
+    else if (offset > gapStart_)
+    {
+        std::size_t count = offset - gapStart_;
+        std::memmove(text_.data() + gapStart_, text_.data() + gapEnd_, count);
+        gapStart_ += count;
+        gapEnd_ += count;
+    }
+}
+
+}
+}
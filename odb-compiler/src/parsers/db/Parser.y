@@ -3,18 +3,44 @@
     #include "odbc/parsers/db/Driver.hpp"
     #include "odbc/ast/Node.hpp"
     #include <stdarg.h>
+    #include <stdio.h>
+    #include <string>
 
     void dberror(DBLTYPE *locp, dbscan_t scanner, const char* msg, ...);
 
     #define driver (static_cast<odbc::db::Driver*>(dbget_extra(scanner)))
+    #define arena (driver->getArena())
+    #define stringTable (driver->getStringTable())
+    #define newCommandNode(keyword, args) newKeywordCommand(arena, stringTable, keyword, \
+        driver->getCommandTrie()->name(keyword).data(), driver->getCommandTrie()->name(keyword).size(), args)
     #define error(x, ...) dberror(dbpushed_loc, scanner, x, __VA_ARGS__)
 
+    /*
+     * Locations are byte spans. A rule covers everything from the start of
+     * its first symbol to the end of its last. An empty rule sits right
+     * after whatever came before it.
+     */
+    #define YYLLOC_DEFAULT(Current, Rhs, N) do {                              \
+        if (N)                                                                \
+        {                                                                     \
+            (Current).offset = YYRHSLOC(Rhs, 1).offset;                       \
+            (Current).length = YYRHSLOC(Rhs, N).offset +                      \
+                YYRHSLOC(Rhs, N).length - YYRHSLOC(Rhs, 1).offset;            \
+        }                                                                     \
+        else                                                                  \
+        {                                                                     \
+            (Current).offset = YYRHSLOC(Rhs, 0).offset + YYRHSLOC(Rhs, 0).length; \
+            (Current).length = 0;                                             \
+        }                                                                     \
+    } while (0)
+
     using namespace odbc;
     using namespace ast;
 }
 
 %code requires
 {
+    #include "odbc/ast/SourceSpan.hpp"
     #include <stdint.h>
     typedef void* dbscan_t;
 
@@ -59,6 +85,7 @@
 %parse-param {dbscan_t scanner}
 
 %locations
+%define api.location.type {odbc::ast::SourceSpan}
 %define parse.error verbose
 
 /* This is the union that will become known as YYSTYPE in the generated code */
@@ -67,13 +94,26 @@
     int32_t integer_value;
     double float_value;
     char* string_literal;
-    char* symbol;
+    uint32_t symbol;
+    uint32_t keyword;
 
     odbc::ast::node_t* node;
 }
 
 %define api.token.prefix {TOK_}
 
+%code
+{
+    // Gives a node the span of the rule that made it. Allocation failures
+    // are passed through.
+    static node_t* located(node_t* node, const DBLTYPE& loc)
+    {
+        if (node)
+            setSpan(node, loc);
+        return node;
+    }
+}
+
 /* Define the semantic types of our grammar. %token for sepINALS and %type for non_sepinals */
 %token END 0 "end of file"
 %token NEWLINE COLON SPACE
@@ -99,6 +139,7 @@
 
 %token<symbol> SYMBOL;
 %token<symbol> COMMAND_SYMBOL;
+%token<keyword> COMMAND "command";
 %token DOLLAR HASH NO_SYMBOL_TYPE;
 
 %type<node> stmnts;
@@ -109,6 +150,8 @@
 %type<node> symbol_without_type;
 %type<node> var_assignment;
 %type<node> func_call;
+%type<node> command_stmnt;
+%type<node> command_call;
 %type<node> func_decl;
 %type<node> func_name_decl;
 %type<node> func_end;
@@ -147,15 +190,13 @@
 %right NOT
 %left LB RB
 
-%destructor { free($$); } <string_literal>
-%destructor { free($$); } <symbol>
-%destructor { freeNodeRecursive($$); } <node>
+%destructor { freeNodeRecursive(arena, $$); } <node>
 
 %start program
 
 %%
 program
-  : seps_maybe stmnts seps_maybe                 { driver->appendBlock($2); }
+  : seps_maybe toplevel_stmnts seps_maybe
   | seps_maybe
   | END
   ;
@@ -169,15 +210,25 @@ seps_maybe
   : seps
   |
   ;
+/*
+ * Top-level statements are handed to the driver one by one as soon as they
+ * are reduced instead of being collected into a block first. This lets the
+ * driver stream them out without ever holding the whole program.
+ */
+toplevel_stmnts
+  : toplevel_stmnts seps stmnt                   { driver->appendStatement($3); }
+  | stmnt                                        { driver->appendStatement($1); }
+  ;
 stmnts
-  : stmnts seps stmnt                            { $$ = appendStatementToBlock($1, $3); }
-  | stmnt                                        { $$ = newBlock($1, nullptr); }
+  : stmnts seps stmnt                            { $$ = appendStatementToBlock(arena, $1, $3); }
+  | stmnt                                        { $$ = newBlock(arena, $1, nullptr); }
   ;
 stmnt
   : var_assignment                               { $$ = $1; }
   | var_decl                                     { $$ = $1; }
   | udt_decl                                     { $$ = $1; }
   | func_call                                    { $$ = $1; }
+  | command_stmnt                                { $$ = $1; }
   | func_decl                                    { $$ = $1; }
   | func_exit_stmnt                              { $$ = $1; }
   | gosub                                        { $$ = $1; }
@@ -186,82 +237,100 @@ stmnt
   | loop                                         { $$ = $1; }
   ;
 var_assignment
-  : symbol EQ expr                               { $$ = newAssignment($1, $3); }
-  | dim_ref EQ expr                              { $$ = newAssignment($1, $3); }
+  : symbol EQ expr                               { $$ = located(newAssignment(arena, $1, $3), @$); }
+  | dim_ref EQ expr                              { $$ = located(newAssignment(arena, $1, $3), @$); }
   ;
 expr
-  : expr ADD expr                                { $$ = newOp($1, $3, OP_ADD); }
-  | expr SUB expr                                { $$ = newOp($1, $3, OP_SUB); }
-  | expr MUL expr                                { $$ = newOp($1, $3, OP_MUL); }
-  | expr DIV expr                                { $$ = newOp($1, $3, OP_DIV); }
-  | expr POW expr                                { $$ = newOp($1, $3, OP_POW); }
-  | expr MOD expr                                { $$ = newOp($1, $3, OP_MOD); }
+  : expr ADD expr                                { $$ = located(newOp(arena, $1, $3, OP_ADD), @$); }
+  | expr SUB expr                                { $$ = located(newOp(arena, $1, $3, OP_SUB), @$); }
+  | expr MUL expr                                { $$ = located(newOp(arena, $1, $3, OP_MUL), @$); }
+  | expr DIV expr                                { $$ = located(newOp(arena, $1, $3, OP_DIV), @$); }
+  | expr POW expr                                { $$ = located(newOp(arena, $1, $3, OP_POW), @$); }
+  | expr MOD expr                                { $$ = located(newOp(arena, $1, $3, OP_MOD), @$); }
   | LB expr RB                                   { $$ = $2; }
-  | expr COMMA expr                              { $$ = newOp($1, $3, OP_COMMA); }
-  | expr EQ expr                                 { $$ = newOp($1, $3, OP_EQ); }
+  | expr COMMA expr                              { $$ = located(newOp(arena, $1, $3, OP_COMMA), @$); }
+  | expr EQ expr                                 { $$ = located(newOp(arena, $1, $3, OP_EQ), @$); }
   | literal                                      { $$ = $1; }
   | symbol                                       { $$ = $1; }
   | func_call                                    { $$ = $1; }
+  | command_call                                 { $$ = $1; }
   ;
 literal
-  : BOOLEAN_LITERAL                              { $$ = newBooleanLiteral($1); }
-  | INTEGER_LITERAL                              { $$ = newIntegerLiteral($1); }
-  | FLOAT_LITERAL                                { $$ = newFloatLiteral($1); }
-  | STRING_LITERAL                               { $$ = newStringLiteral($1); free($1); }
+  : BOOLEAN_LITERAL                              { $$ = located(newBooleanLiteral(arena, $1), @$); }
+  | INTEGER_LITERAL                              { $$ = located(newIntegerLiteral(arena, $1), @$); }
+  | FLOAT_LITERAL                                { $$ = located(newFloatLiteral(arena, $1), @$); }
+  | STRING_LITERAL                               { $$ = located(newStringLiteral(arena, $1), @$); }
   ;
 gosub
-  : GOSUB SYMBOL                                 { $$ = newSymbol($2, nullptr, nullptr, ST_SUBROUTINE, SDT_UNKNOWN, SS_LOCAL, SD_REF); free($2); }
+  : GOSUB SYMBOL                                 { $$ = located(newSymbol(arena, stringTable, $2, nullptr, nullptr, ST_SUBROUTINE, SDT_UNKNOWN, SS_LOCAL, SD_REF), @$); }
   ;
 sub_decl
   : label_decl seps stmnts seps sub_return {
         $$ = $1;
         $$->symbol.flag.type = ST_SUBROUTINE;
-        $$->symbol.data = appendStatementToBlock($3, $5);
+        $$->symbol.data = appendStatementToBlock(arena, $3, $5);
+        located($$, @$);
     }
   ;
 label_decl
-  : SYMBOL COLON                                 { $$ = newSymbol($1, nullptr, nullptr, ST_LABEL, SDT_UNKNOWN, SS_LOCAL, SD_DECL); free($1); }
+  : SYMBOL COLON                                 { $$ = located(newSymbol(arena, stringTable, $1, nullptr, nullptr, ST_LABEL, SDT_UNKNOWN, SS_LOCAL, SD_DECL), @$); }
   ;
 sub_return
-  : RETURN                                       { $$ = newSubReturn(); }
+  : RETURN                                       { $$ = located(newSubReturn(arena), @$); }
   ;
 func_decl
   : func_name_decl seps stmnts seps func_end {
         $$ = $1;
         $$->symbol.flag.type = ST_FUNC;
         $$->symbol.flag.declaration = SD_DECL;
-        $$->symbol.data = appendStatementToBlock($3, $5);
+        $$->symbol.data = appendStatementToBlock(arena, $3, $5);
+        located($$, @$);
     }
   ;
 func_end
-  : ENDFUNCTION expr                             { $$ = newFuncReturn($2); }
-  | ENDFUNCTION                                  { $$ = newFuncReturn(nullptr); }
+  : ENDFUNCTION expr                             { $$ = located(newFuncReturn(arena, $2), @$); }
+  | ENDFUNCTION                                  { $$ = located(newFuncReturn(arena, nullptr), @$); }
   ;
 func_exit_stmnt
-  : EXITFUNCTION expr                            { $$ = newFuncReturn($2); }
-  | EXITFUNCTION                                 { $$ = newFuncReturn(nullptr); }
+  : EXITFUNCTION expr                            { $$ = located(newFuncReturn(arena, $2), @$); }
+  | EXITFUNCTION                                 { $$ = located(newFuncReturn(arena, nullptr), @$); }
   ;
 func_name_decl
-  : FUNCTION symbol LB expr RB                   { $$ = $2; $$->symbol.arglist = $4; }
-  | FUNCTION symbol LB RB                        { $$ = $2; }
+  : FUNCTION symbol LB expr RB                   { $$ = $2; $$->symbol.arglist = $4; located($$, @$); }
+  | FUNCTION symbol LB RB                        { $$ = located($2, @$); }
   ;
 func_call
   : symbol LB expr RB {
         $$ = $1;
         $$->symbol.flag.type = ST_FUNC;
         $$->symbol.arglist = $3;
+        located($$, @$);
     }
   | symbol LB RB {
         $$ = $1;
         $$->symbol.flag.type = ST_FUNC;
+        located($$, @$);
     }
   ;
+/*
+ * The scanner has already matched the full command name against the command
+ * trie, so a command is always a single token carrying its keyword ID.
+ */
+command_stmnt
+  : COMMAND expr                                 { $$ = located(newCommandNode($1, $2), @$); }
+  | COMMAND                                      { $$ = located(newCommandNode($1, nullptr), @$); }
+  ;
+command_call
+  : COMMAND LB expr RB                           { $$ = located(newCommandNode($1, $3), @$); }
+  | COMMAND LB RB                                { $$ = located(newCommandNode($1, nullptr), @$); }
+  ;
 udt_decl
   : TYPE udt_ref seps var_decls seps ENDTYPE
     {
         $$ = $2;
         $$->symbol.data = $4;
         $$->symbol.flag.declaration = SD_DECL;
+        located($$, @$);
     }
   ;
 udt_ref
@@ -272,20 +341,20 @@ udt_ref
     }
   ;
 var_decls
-  : var_decls seps var_decl                      { $$ = appendStatementToBlock($1, $3); }
-  | var_decl                                     { $$ = newBlock($1, nullptr); }
+  : var_decls seps var_decl                      { $$ = appendStatementToBlock(arena, $1, $3); }
+  | var_decl                                     { $$ = newBlock(arena, $1, nullptr); }
   ;
 var_decl
-  : LOCAL var_decl_type                          { $$ = $2; $$->symbol.flag.scope = SS_LOCAL; }
-  | GLOBAL var_decl_type                         { $$ = $2; $$->symbol.flag.scope = SS_GLOBAL; }
+  : LOCAL var_decl_type                          { $$ = $2; $$->symbol.flag.scope = SS_LOCAL; located($$, @$); }
+  | GLOBAL var_decl_type                         { $$ = $2; $$->symbol.flag.scope = SS_GLOBAL; located($$, @$); }
   | var_decl_type                                { $$ = $1; }
   ;
 var_decl_type
-  : symbol_and_dim_decl AS BOOLEAN               { $$ = $1; $$->symbol.flag.datatype = SDT_BOOLEAN; }
-  | symbol_and_dim_decl AS INTEGER               { $$ = $1; $$->symbol.flag.datatype = SDT_INTEGER; }
-  | symbol_and_dim_decl AS FLOAT                 { $$ = $1; $$->symbol.flag.datatype = SDT_FLOAT; }
-  | symbol_and_dim_decl AS STRING                { $$ = $1; $$->symbol.flag.datatype = SDT_STRING; }
-  | symbol_and_dim_decl AS udt_ref               { $$ = $1; $$->symbol.flag.datatype = SDT_UDT; $$->symbol.data = $3; }
+  : symbol_and_dim_decl AS BOOLEAN               { $$ = $1; $$->symbol.flag.datatype = SDT_BOOLEAN; located($$, @$); }
+  | symbol_and_dim_decl AS INTEGER               { $$ = $1; $$->symbol.flag.datatype = SDT_INTEGER; located($$, @$); }
+  | symbol_and_dim_decl AS FLOAT                 { $$ = $1; $$->symbol.flag.datatype = SDT_FLOAT; located($$, @$); }
+  | symbol_and_dim_decl AS STRING                { $$ = $1; $$->symbol.flag.datatype = SDT_STRING; located($$, @$); }
+  | symbol_and_dim_decl AS udt_ref               { $$ = $1; $$->symbol.flag.datatype = SDT_UDT; $$->symbol.data = $3; located($$, @$); }
   | symbol_and_dim_decl                          { $$ = $1; }
   ;
 symbol_and_dim_decl
@@ -298,11 +367,13 @@ dim_decl
         $$->symbol.flag.type = ST_DIM;
         $$->symbol.flag.declaration = SD_DECL;
         $$->symbol.arglist = $4;
+        located($$, @$);
     }
   | DIM symbol LB RB {
         $$ = $2;
         $$->symbol.flag.type = ST_DIM;
         $$->symbol.flag.declaration = SD_DECL;
+        located($$, @$);
     }
   ;
 dim_ref
@@ -310,39 +381,41 @@ dim_ref
         $$ = $1;
         $$->symbol.flag.type = ST_DIM;
         $$->symbol.arglist = $3;
+        located($$, @$);
     }
   | symbol LB RB {
         $$ = $1;
         $$->symbol.flag.type = ST_DIM;
+        located($$, @$);
     }
   ;
 symbol
   : symbol_without_type                          { $$ = $1; }
-  | SYMBOL HASH                                  { $$ = newSymbol($1, nullptr, nullptr, ST_UNKNOWN, SDT_FLOAT, SS_LOCAL, SD_REF); free($1); }
-  | SYMBOL DOLLAR                                { $$ = newSymbol($1, nullptr, nullptr, ST_UNKNOWN, SDT_STRING, SS_LOCAL, SD_REF); free($1); }
+  | SYMBOL HASH                                  { $$ = located(newSymbol(arena, stringTable, $1, nullptr, nullptr, ST_UNKNOWN, SDT_FLOAT, SS_LOCAL, SD_REF), @$); }
+  | SYMBOL DOLLAR                                { $$ = located(newSymbol(arena, stringTable, $1, nullptr, nullptr, ST_UNKNOWN, SDT_STRING, SS_LOCAL, SD_REF), @$); }
   ;
 symbol_without_type
-  : SYMBOL                                       { $$ = newSymbol($1, nullptr, nullptr, ST_UNKNOWN, SDT_UNKNOWN, SS_LOCAL, SD_REF); free($1); }
+  : SYMBOL                                       { $$ = located(newSymbol(arena, stringTable, $1, nullptr, nullptr, ST_UNKNOWN, SDT_UNKNOWN, SS_LOCAL, SD_REF), @$); }
   ;
 conditional
   : conditional_singleline                       { $$ = $1; }
   | conditional_begin                            { $$ = $1; }
   ;
 conditional_singleline
-  : IF expr THEN stmnt %prec NO_ELSE             { $$ = newBranch($2, $4, nullptr); }
-  | IF expr THEN stmnt ELSE stmnt                { $$ = newBranch($2, $4, $6); }
-  | IF expr THEN ELSE stmnt                      { $$ = newBranch($2, nullptr, $5); }
+  : IF expr THEN stmnt %prec NO_ELSE             { $$ = located(newBranch(arena, $2, $4, nullptr), @$); }
+  | IF expr THEN stmnt ELSE stmnt                { $$ = located(newBranch(arena, $2, $4, $6), @$); }
+  | IF expr THEN ELSE stmnt                      { $$ = located(newBranch(arena, $2, nullptr, $5), @$); }
   ;
 conditional_begin
-  : IF expr seps conditional_next                { $$ = newBranch($2, nullptr, $4); }
-  | IF expr seps stmnts seps conditional_next    { $$ = newBranch($2, $4, $6); }
+  : IF expr seps conditional_next                { $$ = located(newBranch(arena, $2, nullptr, $4), @$); }
+  | IF expr seps stmnts seps conditional_next    { $$ = located(newBranch(arena, $2, $4, $6), @$); }
   ;
 conditional_next
   : ENDIF                                        { $$ = nullptr; }
   | ELSE seps stmnts seps ENDIF                  { $$ = $3; }
   | ELSE seps ENDIF                              { $$ = nullptr; }
-  | ELSEIF expr seps conditional_next            { $$ = newBranch($2, nullptr, $4); }
-  | ELSEIF expr seps stmnts seps conditional_next { $$ = newBranch($2, $4, $6); }
+  | ELSEIF expr seps conditional_next            { $$ = located(newBranch(arena, $2, nullptr, $4), @$); }
+  | ELSEIF expr seps stmnts seps conditional_next { $$ = located(newBranch(arena, $2, $4, $6), @$); }
   ;
 loop
   : loop_do                                      { $$ = $1; }
@@ -351,22 +424,22 @@ loop
   | loop_for                                     { $$ = $1; }
   ;
 loop_do
-  : DO seps stmnts seps LOOP                     { $$ = newLoop($3); }
-  | DO seps LOOP                                 { $$ = newLoop(nullptr); }
+  : DO seps stmnts seps LOOP                     { $$ = located(newLoop(arena, $3), @$); }
+  | DO seps LOOP                                 { $$ = located(newLoop(arena, nullptr), @$); }
   ;
 loop_while
-  : WHILE expr seps stmnts seps ENDWHILE         { $$ = newLoopWhile($2, $4); }
-  | WHILE expr seps ENDWHILE                     { $$ = newLoopWhile($2, nullptr); }
+  : WHILE expr seps stmnts seps ENDWHILE         { $$ = located(newLoopWhile(arena, $2, $4), @$); }
+  | WHILE expr seps ENDWHILE                     { $$ = located(newLoopWhile(arena, $2, nullptr), @$); }
   ;
 loop_until
-  : REPEAT seps stmnts seps UNTIL expr           { $$ = newLoopUntil($6, $3); }
-  | REPEAT seps UNTIL expr                       { $$ = newLoopUntil($4, nullptr); }
+  : REPEAT seps stmnts seps UNTIL expr           { $$ = located(newLoopUntil(arena, $6, $3), @$); }
+  | REPEAT seps UNTIL expr                       { $$ = located(newLoopUntil(arena, $4, nullptr), @$); }
   ;
 loop_for
-  : FOR symbol EQ expr TO expr STEP expr seps stmnts seps loop_for_next { $$ = newLoopFor($2, $4, $6, $8, $12, $10); }
-  | FOR symbol EQ expr TO expr STEP expr seps loop_for_next             { $$ = newLoopFor($2, $4, $6, $8, $10, nullptr); }
-  | FOR symbol EQ expr TO expr seps stmnts seps loop_for_next           { $$ = newLoopFor($2, $4, $6, nullptr, $10, $8); }
-  | FOR symbol EQ expr TO expr seps loop_for_next                       { $$ = newLoopFor($2, $4, $6, nullptr, $8, nullptr); }
+  : FOR symbol EQ expr TO expr STEP expr seps stmnts seps loop_for_next { $$ = located(newLoopFor(arena, $2, $4, $6, $8, $12, $10), @$); }
+  | FOR symbol EQ expr TO expr STEP expr seps loop_for_next             { $$ = located(newLoopFor(arena, $2, $4, $6, $8, $10, nullptr), @$); }
+  | FOR symbol EQ expr TO expr seps stmnts seps loop_for_next           { $$ = located(newLoopFor(arena, $2, $4, $6, nullptr, $10, $8), @$); }
+  | FOR symbol EQ expr TO expr seps loop_for_next                       { $$ = located(newLoopFor(arena, $2, $4, $6, nullptr, $8, nullptr), @$); }
   ;
 loop_for_next
   : NEXT                                         { $$ = nullptr; }
@@ -377,9 +450,15 @@ loop_for_next
 void dberror(YYLTYPE *locp, dbscan_t scanner, const char* fmt, ...)
 {
     va_list args;
-    printf("Error: ");
     va_start(args, fmt);
-    vprintf(fmt, args);
+    va_list argsCopy;
+    va_copy(argsCopy, args);
+    int length = vsnprintf(nullptr, 0, fmt, argsCopy);
+    va_end(argsCopy);
+    std::string message(length > 0 ? length : 0, '\0');
+    if (length > 0)
+        vsnprintf(&message[0], length + 1, fmt, args);
     va_end(args);
-    printf("\n");
+
+    driver->reportError(*locp, message);
 }
@@ -0,0 +1,149 @@
+#include "odbc/parsers/db/ReservedWords.hpp"
+#include "odbc/parsers/db/Parser.y.h"
+#include <cstdint>
+
+namespace odbc {
+namespace db {
+
+namespace {
+
+// Words that were (?i:...) rules in the scanner match regardless of case,
+// the others only in lower case
+constexpr ReservedWord words[] = {
+    {"true",         TOK_BOOLEAN_LITERAL, false, true},
+    {"false",        TOK_BOOLEAN_LITERAL, false, false},
+    {"inc",          TOK_INC,             false, false},
+    {"dec",          TOK_DEC,             false, false},
+    {"or",           TOK_OR,              false, false},
+    {"and",          TOK_AND,             false, false},
+    {"not",          TOK_NOT,             false, false},
+    {"then",         TOK_THEN,            true,  false},
+    {"endif",        TOK_ENDIF,           true,  false},
+    {"elseif",       TOK_ELSEIF,          true,  false},
+    {"if",           TOK_IF,              true,  false},
+    {"else",         TOK_ELSE,            true,  false},
+    {"endwhile",     TOK_ENDWHILE,        true,  false},
+    {"while",        TOK_WHILE,           true,  false},
+    {"repeat",       TOK_REPEAT,          true,  false},
+    {"until",        TOK_UNTIL,           true,  false},
+    {"do",           TOK_DO,              true,  false},
+    {"loop",         TOK_LOOP,            true,  false},
+    {"for",          TOK_FOR,             true,  false},
+    {"to",           TOK_TO,              true,  false},
+    {"step",         TOK_STEP,            true,  false},
+    {"next",         TOK_NEXT,            true,  false},
+    {"endfunction",  TOK_ENDFUNCTION,     true,  false},
+    {"exitfunction", TOK_EXITFUNCTION,    true,  false},
+    {"function",     TOK_FUNCTION,        true,  false},
+    {"gosub",        TOK_GOSUB,           true,  false},
+    {"return",       TOK_RETURN,          true,  false},
+    {"dim",          TOK_DIM,             true,  false},
+    {"global",       TOK_GLOBAL,          true,  false},
+    {"local",        TOK_LOCAL,           true,  false},
+    {"as",           TOK_AS,              true,  false},
+    {"endtype",      TOK_ENDTYPE,         true,  false},
+    {"type",         TOK_TYPE,            true,  false},
+    {"boolean",      TOK_BOOLEAN,         true,  false},
+    {"integer",      TOK_INTEGER,         true,  false},
+    {"float",        TOK_FLOAT,           true,  false},
+    {"string",       TOK_STRING,          true,  false},
+};
+
+constexpr std::size_t wordCount = sizeof(words) / sizeof(*words);
+constexpr std::size_t tableSize = 128;
+constexpr uint32_t noSeed = 0xFFFFFFFF;
+
+// ----------------------------------------------------------------------------
+constexpr std::size_t length(const char* str)
+{
+    std::size_t len = 0;
+    while (str[len])
+        len++;
+    return len;
+}
+
+// ----------------------------------------------------------------------------
+// Identifiers only contain [a-zA-Z0-9_], where setting bit 5 lower-cases
+// letters and leaves digits alone, which is all the case folding needed
+constexpr uint32_t hashWord(const char* text, std::size_t len, uint32_t seed)
+{
+    uint32_t hash = 2166136261u ^ seed;
+    for (std::size_t i = 0; i != len; ++i)
+    {
+        hash ^= (uint8_t)(text[i] | 0x20);
+        hash *= 16777619u;
+    }
+    hash ^= hash >> 15;
+    return hash & (tableSize - 1);
+}
+
+// ----------------------------------------------------------------------------
+constexpr uint32_t findSeed()
+{
+    for (uint32_t seed = 0; seed != 1u << 16; ++seed)
+    {
+        bool used[tableSize] = {};
+        bool collision = false;
+        for (std::size_t i = 0; i != wordCount && collision == false; ++i)
+        {
+            uint32_t slot = hashWord(words[i].name, length(words[i].name), seed);
+            collision = used[slot];
+            used[slot] = true;
+        }
+        if (collision == false)
+            return seed;
+    }
+    return noSeed;
+}
+
+constexpr uint32_t seed = findSeed();
+static_assert(seed != noSeed, "No perfect hash found for the reserved words, increase tableSize");
+
+struct Table
+{
+    uint8_t slots[tableSize];    // Index into words plus one, 0 if empty
+    uint8_t maxLength;
+};
+
+// ----------------------------------------------------------------------------
+constexpr Table buildTable()
+{
+    Table table = {};
+    for (std::size_t i = 0; i != wordCount; ++i)
+    {
+        std::size_t len = length(words[i].name);
+        table.slots[hashWord(words[i].name, len, seed)] = (uint8_t)(i + 1);
+        if (len > table.maxLength)
+            table.maxLength = (uint8_t)len;
+    }
+    return table;
+}
+
+constexpr Table table = buildTable();
+
+}
+
+// ----------------------------------------------------------------------------
+const ReservedWord* findReservedWord(const char* text, std::size_t len)
+{
+    if (len > table.maxLength)
+        return nullptr;
+
+    uint8_t slot = table.slots[hashWord(text, len, seed)];
+    if (slot == 0)
+        return nullptr;
+
+    // A shorter name ends with a NUL, which never compares equal to an
+    // identifier character, so name is never read past its end
+    const ReservedWord* word = &words[slot - 1];
+    for (std::size_t i = 0; i != len; ++i)
+    {
+        char c = word->caseSensitive ? text[i] : (char)(text[i] | 0x20);
+        if (word->name[i] != c)
+            return nullptr;
+    }
+    return word->name[len] == '\0' ? word : nullptr;
+}
+
+}
+}
@@ -0,0 +1,66 @@
+#include "odbc/parsers/db/TokenBuffer.hpp"
+#include <algorithm>
+#include <cstring>
+
+namespace odbc {
+namespace db {
+
+// ----------------------------------------------------------------------------
+void TokenBuffer::push(int token, uint32_t offset, uint32_t length, const DBSTYPE& value)
+{
+    tokens_.push_back((int16_t)token);
+    offsets_.push_back(offset);
+    lengths_.push_back(length);
+    values_.push_back(value);
+}
+
+// ----------------------------------------------------------------------------
+void TokenBuffer::reserve(std::size_t count)
+{
+    tokens_.reserve(count);
+    offsets_.reserve(count);
+    lengths_.reserve(count);
+    values_.reserve(count);
+}
+
+// ----------------------------------------------------------------------------
+void TokenBuffer::clear()
+{
+    tokens_.clear();
+    offsets_.clear();
+    lengths_.clear();
+    values_.clear();
+}
+
+// ----------------------------------------------------------------------------
+std::vector<std::size_t> splitSource(const char* text, std::size_t size, std::size_t chunkCount)
+{
+    std::vector<std::size_t> starts;
+    starts.push_back(0);
+    if (chunkCount <= 1 || size == 0)
+        return starts;
+
+    // Nothing the scanner matches continues past the end of a line: remarks,
+    // block comments and string literals all stop there. Any line start is
+    // therefore a safe place to split, so take the first one after each
+    // chunk's share of the text.
+    const char* end = text + size;
+    std::size_t chunkSize = std::max<std::size_t>(size / chunkCount, 1);
+    std::size_t nextSplit = chunkSize;
+    while (nextSplit < size && starts.size() != chunkCount)
+    {
+        const char* from = text + nextSplit - 1;
+        const char* newline = (const char*)memchr(from, '\n', end - from);
+        if (newline == nullptr || newline + 1 == end)
+            break;
+
+        std::size_t offset = (std::size_t)(newline + 1 - text);
+        starts.push_back(offset);
+        nextSplit = offset + chunkSize;
+    }
+
+    return starts;
+}
+
+}
+}
@@ -0,0 +1,194 @@
+#include "odbc/parsers/keywords/CommandTrie.hpp"
+#include "odbc/parsers/keywords/KeywordName.hpp"
+#include <algorithm>
+#include <cctype>
+#include <deque>
+#include <utility>
+
+namespace odbc {
+
+const CommandTrie::KeywordID CommandTrie::notFound;
+const std::size_t CommandTrie::maxSize;
+const CommandTrie::NodeIndex CommandTrie::noNode;
+
+// ----------------------------------------------------------------------------
+static bool isSpace(char c)
+{
+    return c == ' ' || c == '\t';
+}
+
+// ----------------------------------------------------------------------------
+static bool isWordChar(char c)
+{
+    return isalnum((unsigned char)c) || c == '_';
+}
+
+// ----------------------------------------------------------------------------
+static std::string normalize(const std::string& name)
+{
+    std::string result;
+    result.reserve(name.size());
+    for (std::size_t i = 0; i != name.size(); ++i)
+    {
+        if (isSpace(name[i]))
+        {
+            if (result.empty() == false && result.back() != ' ')
+                result.push_back(' ');
+        }
+        else
+            result.push_back((char)toupper((unsigned char)name[i]));
+    }
+    if (result.empty() == false && result.back() == ' ')
+        result.pop_back();
+    return result;
+}
+
+// ----------------------------------------------------------------------------
+CommandTrie::CommandTrie() :
+    hash_(0)
+{
+    std::fill(std::begin(rootChildren_), std::end(rootChildren_), noNode);
+}
+
+// ----------------------------------------------------------------------------
+std::unique_ptr<CommandTrie> CommandTrie::fromNames(std::vector<std::string> names)
+{
+    // Sort by normalized name so that IDs don't depend on the order names
+    // were loaded in, and so that names sharing a prefix are next to each
+    // other
+    std::vector<std::pair<std::string, std::string>> sorted;
+    sorted.reserve(names.size());
+    for (auto& name : names)
+    {
+        std::string normalized = normalize(name);
+        if (normalized.empty() == false)
+            sorted.emplace_back(std::move(normalized), std::move(name));
+    }
+    std::sort(sorted.begin(), sorted.end());
+    sorted.erase(std::unique(sorted.begin(), sorted.end(), [](const auto& a, const auto& b) {
+        return a.first == b.first;
+    }), sorted.end());
+
+    if (sorted.size() > maxSize)
+        return nullptr;
+
+    std::unique_ptr<CommandTrie> trie(new CommandTrie);
+    trie->names_.reserve(sorted.size());
+    uint64_t hash = 14695981039346656037ull;  // FNV-1a, 64-bit
+    for (auto& name : sorted)
+    {
+        for (char c : name.second)
+        {
+            hash ^= (unsigned char)c;
+            hash *= 1099511628211ull;
+        }
+        hash *= 1099511628211ull;  // NUL between names
+        trie->names_.push_back(std::move(name.second));
+    }
+    trie->hash_ = hash;
+
+    // Breadth first, so the edges of a node can be allocated in one go and
+    // stay contiguous. Each entry is a node and the range of names below it,
+    // all of which share their first "depth" characters.
+    struct Pending
+    {
+        NodeIndex node;
+        std::size_t begin, end, depth;
+    };
+    std::deque<Pending> queue;
+    trie->nodes_.push_back({0, 0, notFound});
+    queue.push_back({0, 0, sorted.size(), 0});
+    while (queue.empty() == false)
+    {
+        Pending p = queue.front();
+        queue.pop_front();
+
+        // Sorting puts the name that ends here first
+        if (p.begin != p.end && sorted[p.begin].first.size() == p.depth)
+            trie->nodes_[p.node].keyword = KeywordID(p.begin++);
+
+        trie->nodes_[p.node].firstEdge = (uint32_t)trie->edgeChars_.size();
+        for (std::size_t i = p.begin; i != p.end; )
+        {
+            char c = sorted[i].first[p.depth];
+            std::size_t groupEnd = i + 1;
+            while (groupEnd != p.end && sorted[groupEnd].first[p.depth] == c)
+                groupEnd++;
+
+            NodeIndex child = (NodeIndex)trie->nodes_.size();
+            trie->nodes_.push_back({0, 0, notFound});
+            trie->edgeChars_.push_back(c);
+            trie->edgeTargets_.push_back(child);
+            trie->nodes_[p.node].edgeCount++;
+            if (p.node == 0)
+                trie->rootChildren_[(unsigned char)c] = child;
+            queue.push_back({child, i, groupEnd, p.depth + 1});
+
+            i = groupEnd;
+        }
+    }
+
+    return trie;
+}
+
+// ----------------------------------------------------------------------------
+CommandTrie::NodeIndex CommandTrie::child(NodeIndex node, char c) const
+{
+    if (node == 0)
+        return rootChildren_[(unsigned char)c];
+
+    const char* begin = edgeChars_.data() + nodes_[node].firstEdge;
+    const char* end = begin + nodes_[node].edgeCount;
+    const char* it = std::lower_bound(begin, end, c);
+    if (it == end || *it != c)
+        return noNode;
+    return edgeTargets_[it - edgeChars_.data()];
+}
+
+// ----------------------------------------------------------------------------
+CommandTrie::Match CommandTrie::longestMatch(std::string_view text) const
+{
+    Match best = {notFound, 0, 0};
+    KeywordNameHash hash;
+    NodeIndex node = 0;
+    std::size_t i = 0;
+    while (i < text.size())
+    {
+        char c = text[i];
+        std::size_t next = i + 1;
+        if (isSpace(c))
+        {
+            c = ' ';
+            while (next < text.size() && isSpace(text[next]))
+                next++;
+        }
+        else
+            c = (char)toupper((unsigned char)c);
+
+        node = child(node, c);
+        if (node == noNode)
+            break;
+        i = next;
+        hash.add(c);
+
+        // Don't stop in the middle of a word
+        if (nodes_[node].keyword != notFound &&
+            (i == text.size() || isWordChar(text[i]) == false || isWordChar(text[i - 1]) == false))
+        {
+            best.keyword = nodes_[node].keyword;
+            best.length = i;
+            best.hash = hash.value();
+        }
+    }
+
+    return best;
+}
+
+// ----------------------------------------------------------------------------
+CommandTrie::KeywordID CommandTrie::find(std::string_view name) const
+{
+    Match match = longestMatch(name);
+    return match.length == name.size() ? match.keyword : notFound;
+}
+
+}
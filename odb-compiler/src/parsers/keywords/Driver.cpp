@@ -3,13 +3,17 @@
 #include "odbc/parsers/keywords/Scanner.hpp"
 #include "odbc/parsers/keywords/Keyword.hpp"
 #include "odbc/parsers/keywords/KeywordsDB.hpp"
+#include "odbc/parsers/SourceBuffer.hpp"
 #include <cassert>
 #include <algorithm>
 
-static void strip(std::string& str)
+static std::string_view strip(std::string_view str)
 {
-    str.erase(str.begin(), std::find_if(str.begin(), str.end(), std::bind1st(std::not_equal_to<char>(), ' ')));
-    str.erase(std::find_if(str.rbegin(), str.rend(), std::bind1st(std::not_equal_to<char>(), ' ')).base(), str.end());
+    while (str.empty() == false && str.front() == ' ')
+        str.remove_prefix(1);
+    while (str.empty() == false && str.back() == ' ')
+        str.remove_suffix(1);
+    return str;
 }
 
 namespace odbc {
@@ -19,8 +23,6 @@ namespace kw {
 Driver::Driver(KeywordDB* targetDB) :
     location_({}),
     db_(targetDB),
-    keywordName_(nullptr),
-    helpFile_(nullptr),
     hasReturnType_(false)
 {
     kwlex_init(&scanner_);
@@ -38,31 +40,33 @@ Driver::~Driver()
 // ----------------------------------------------------------------------------
 bool Driver::parseString(const std::string& str)
 {
-    KWSTYPE pushedValue;
-    int pushedChar;
-    int parse_result;
-
-    YY_BUFFER_STATE buf = kw_scan_bytes(str.data(), str.length(), scanner_);
-
-    do
-    {
-        pushedChar = kwlex(&pushedValue, scanner_);
-        parse_result = kwpush_parse(parser_, pushedChar, &pushedValue, &location_, scanner_);
-    } while (parse_result == YYPUSH_MORE);
+    std::unique_ptr<SourceBuffer> source = SourceBuffer::fromString(str);
+    return source && parseBuffer(*source);
+}
 
-    kw_delete_buffer(buf, scanner_);
+// ----------------------------------------------------------------------------
+bool Driver::parseStream(FILE* fp)
+{
+    std::unique_ptr<SourceBuffer> source = SourceBuffer::fromStream(fp);
+    return source && parseBuffer(*source);
+}
 
-    return parse_result == 0;
+// ----------------------------------------------------------------------------
+bool Driver::parseFile(const std::string& fileName)
+{
+    std::unique_ptr<SourceBuffer> source = SourceBuffer::fromFile(fileName);
+    return source && parseBuffer(*source);
 }
 
 // ----------------------------------------------------------------------------
-bool Driver::parseStream(FILE* fp)
+bool Driver::parseBuffer(SourceBuffer& source)
 {
     KWSTYPE pushedValue;
     int pushedChar;
     int parse_result;
 
-    kwset_in(fp, scanner_);
+    tokenTrace_.beginInput();
+    YY_BUFFER_STATE buf = kw_scan_buffer(source.data(), source.scanSize(), scanner_);
 
     do
     {
@@ -70,57 +74,56 @@ bool Driver::parseStream(FILE* fp)
         parse_result = kwpush_parse(parser_, pushedChar, &pushedValue, &location_, scanner_);
     } while (parse_result == YYPUSH_MORE);
 
+    kw_delete_buffer(buf, scanner_);
+
+    // Views into the buffer of a keyword left unfinished by an error must not
+    // outlive it
+    keywordName_ = std::string_view();
+    helpFile_ = std::string_view();
+    hasReturnType_ = false;
+    args_.clear();
+    overloadEnds_.clear();
+
     return parse_result == 0;
 }
 
 // ----------------------------------------------------------------------------
-void Driver::setKeywordName(char* name)
+void Driver::setKeywordName(std::string_view name)
 {
-    if (keywordName_)
-        free(keywordName_);
     keywordName_ = name;
 }
 
 // ----------------------------------------------------------------------------
-void Driver::setHelpFile(char* path)
+void Driver::setHelpFile(std::string_view path)
 {
-    if (helpFile_)
-        free(helpFile_);
     helpFile_ = path;
 }
 
 // ----------------------------------------------------------------------------
 void Driver::finishKeyword()
 {
+    // This is the only place tokens are copied
     Keyword keyword;
-    keyword.name = keywordName_;
-    keyword.helpFile = helpFile_;
+    keyword.name = std::string(strip(keywordName_));
+    keyword.helpFile = std::string(helpFile_);
     keyword.hasReturnType = hasReturnType_;
-    for (auto& overload : currentOverloadList_)
+    keyword.overloads.resize(overloadEnds_.size());
+    std::size_t begin = 0;
+    for (std::size_t o = 0; o != overloadEnds_.size(); ++o)
     {
-        std::vector<std::string> overloadArgs;
-        for (auto& arg : overload)
-        {
-            overloadArgs.push_back(arg);
-            strip(overloadArgs.back());
-        }
-        keyword.overloads.push_back(overloadArgs);
+        auto& overload = keyword.overloads[o];
+        overload.reserve(overloadEnds_[o] - begin);
+        for (; begin != overloadEnds_[o]; ++begin)
+            overload.emplace_back(strip(args_[begin]));
     }
 
     db_->addKeyword(std::move(keyword));
 
-    free(keywordName_);  keywordName_ = nullptr;
-    free(helpFile_);     helpFile_ = nullptr;
+    keywordName_ = std::string_view();
+    helpFile_ = std::string_view();
     hasReturnType_ = false;
-
-    for (auto& overload : currentOverloadList_)
-        for (auto& arg : overload)
-            free(arg);
-    currentOverloadList_.clear();
-
-    for (auto& arg : currentArgList_)
-        free(arg);
-    currentArgList_.clear();
+    args_.clear();
+    overloadEnds_.clear();
 }
 
 // ----------------------------------------------------------------------------
@@ -129,29 +132,27 @@ void Driver::finishOverload()
 }
 
 // ----------------------------------------------------------------------------
-void Driver::addArg(char* arg)
+void Driver::addArg(std::string_view arg)
 {
-    currentArgList_.push_back(arg);
+    args_.push_back(arg);
 }
 
 // ----------------------------------------------------------------------------
 void Driver::finishArgs()
 {
-    currentOverloadList_.push_back(currentArgList_);
-    currentArgList_.clear();
+    overloadEnds_.push_back(args_.size());
 }
 
 // ----------------------------------------------------------------------------
-void Driver::addRetArg(char* arg)
+void Driver::addRetArg(std::string_view arg)
 {
-    currentArgList_.push_back(arg);
+    args_.push_back(arg);
 }
 
 // ----------------------------------------------------------------------------
 void Driver::finishRetArgs()
 {
-    currentOverloadList_.push_back(currentArgList_);
-    currentArgList_.clear();
+    overloadEnds_.push_back(args_.size());
 
     hasReturnType_ = true;
 }
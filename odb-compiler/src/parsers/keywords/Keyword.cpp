@@ -0,0 +1,120 @@
+#include "odbc/parsers/keywords/Keyword.hpp"
+#include <algorithm>
+#include <cctype>
+
+namespace odbc {
+
+const int Keyword::noOverload;
+
+// Number of argument types that fit into a dispatch key next to the arity
+static const std::size_t packedArgs = 28;
+
+// ----------------------------------------------------------------------------
+static KeywordArgType typeFromName(const std::string& word)
+{
+    static const struct { const char* name; KeywordArgType type; } types[] = {
+        {"integer", KeywordArgType::Integer},
+        {"int",     KeywordArgType::Integer},
+        {"long",    KeywordArgType::Integer},
+        {"short",   KeywordArgType::Integer},
+        {"dword",   KeywordArgType::Integer},
+        {"word",    KeywordArgType::Integer},
+        {"byte",    KeywordArgType::Integer},
+        {"bool",    KeywordArgType::Integer},
+        {"boolean", KeywordArgType::Integer},
+        {"uint",    KeywordArgType::Integer},
+        {"float",   KeywordArgType::Float},
+        {"double",  KeywordArgType::Float},
+        {"real",    KeywordArgType::Float},
+        {"string",  KeywordArgType::String},
+        {"lpstr",   KeywordArgType::String},
+        {"lpcstr",  KeywordArgType::String},
+    };
+    for (const auto& type : types)
+        if (word == type.name)
+            return type.type;
+    return KeywordArgType::Any;
+}
+
+// ----------------------------------------------------------------------------
+KeywordArgType parseKeywordArgType(std::string_view arg)
+{
+    std::vector<std::string> words;
+    for (std::size_t i = 0; i != arg.size(); )
+    {
+        if (isalnum((unsigned char)arg[i]) == false && arg[i] != '_')
+        {
+            i++;
+            continue;
+        }
+        std::string word;
+        for (; i != arg.size() && (isalnum((unsigned char)arg[i]) || arg[i] == '_'); ++i)
+            word.push_back((char)tolower((unsigned char)arg[i]));
+        words.push_back(std::move(word));
+    }
+    if (words.empty())
+        return KeywordArgType::Any;
+
+    // "x as Float", "value as double integer"
+    for (std::size_t i = 0; i + 1 < words.size(); ++i)
+        if (words[i] == "as")
+            return typeFromName(words.back());
+
+    // DBPro's "Double Integer" is an integer, not a double
+    if (words.size() >= 2 && words[0] == "double" && words[1] == "integer")
+        return KeywordArgType::Integer;
+
+    // "int pdfid", "Integer Value", "String"
+    KeywordArgType type = typeFromName(words[0]);
+    if (type != KeywordArgType::Any)
+        return type;
+
+    // "Text String", "Filename"
+    if (words.back() == "string" || words.back() == "filename")
+        return KeywordArgType::String;
+
+    return KeywordArgType::Any;
+}
+
+// ----------------------------------------------------------------------------
+uint64_t keywordDispatchKey(const KeywordArgType* args, std::size_t count)
+{
+    uint64_t key = (uint64_t)std::min(count, std::size_t(255)) << 56;
+    for (std::size_t i = 0; i != count && i != packedArgs; ++i)
+        key |= (uint64_t)args[i] << (2 * i);
+    return key;
+}
+
+// ----------------------------------------------------------------------------
+void Keyword::buildSignatures()
+{
+    signatures.clear();
+    dispatch.clear();
+    signatures.reserve(overloads.size());
+    dispatch.reserve(overloads.size());
+    for (const auto& overload : overloads)
+    {
+        std::vector<KeywordArgType> signature;
+        signature.reserve(overload.size());
+        for (const auto& arg : overload)
+            signature.push_back(parseKeywordArgType(arg));
+
+        dispatch.emplace_back(keywordDispatchKey(signature.data(), signature.size()), (uint32_t)signatures.size());
+        signatures.push_back(std::move(signature));
+    }
+    std::sort(dispatch.begin(), dispatch.end());
+}
+
+// ----------------------------------------------------------------------------
+int Keyword::resolveOverload(const KeywordArgType* args, std::size_t count) const
+{
+    return resolveKeywordOverload(dispatch.size(),
+        [this](std::size_t i) { return dispatch[i].first; },
+        [this](std::size_t i) { return dispatch[i].second; },
+        [this](uint32_t overload) {
+            return KeywordSignature{signatures[overload].data(), signatures[overload].size()};
+        },
+        args, count);
+}
+
+}
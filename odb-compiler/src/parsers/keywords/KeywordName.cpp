@@ -0,0 +1,56 @@
+#include "odbc/parsers/keywords/KeywordName.hpp"
+
+namespace odbc {
+
+// ----------------------------------------------------------------------------
+static bool isSpace(char c)
+{
+    return c == ' ' || c == '\t';
+}
+
+// ----------------------------------------------------------------------------
+uint64_t hashKeywordName(std::string_view name)
+{
+    KeywordNameHash hash;
+    hash.add(name);
+    return hash.value();
+}
+
+// ----------------------------------------------------------------------------
+bool keywordNamesEqual(std::string_view a, std::string_view b)
+{
+    std::size_t i = 0, j = 0;
+    while (i != a.size() && isSpace(a[i])) i++;
+    while (j != b.size() && isSpace(b[j])) j++;
+
+    while (i != a.size() && j != b.size())
+    {
+        if (isSpace(a[i]) || isSpace(b[j]))
+        {
+            // A run of whitespace on one side has to meet a run on the other
+            // side, unless both names end there
+            std::size_t endA = i, endB = j;
+            while (endA != a.size() && isSpace(a[endA])) endA++;
+            while (endB != b.size() && isSpace(b[endB])) endB++;
+            if (endA == a.size() && endB == b.size())
+                return true;
+            if (endA == i || endB == j || endA == a.size() || endB == b.size())
+                return false;
+            i = endA;
+            j = endB;
+            continue;
+        }
+
+        if (toupper((unsigned char)a[i]) != toupper((unsigned char)b[j]))
+            return false;
+        i++;
+        j++;
+    }
+
+    // Only trailing whitespace may be left over
+    while (i != a.size() && isSpace(a[i])) i++;
+    while (j != b.size() && isSpace(b[j])) j++;
+    return i == a.size() && j == b.size();
+}
+
+}
@@ -0,0 +1,468 @@
+#include "odbc/parsers/keywords/KeywordSnapshot.hpp"
+#include "odbc/parsers/keywords/Keyword.hpp"
+#include "odbc/parsers/keywords/KeywordName.hpp"
+#include "odbc/parsers/SourceBuffer.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <numeric>
+
+namespace odbc {
+
+const KeywordSnapshot::Index KeywordSnapshot::notFound;
+
+static const char snapshotMagic[4] = {'O', 'D', 'B', 'K'};
+static const uint32_t snapshotFormatVersion = 4;
+
+// ----------------------------------------------------------------------------
+KeywordSnapshot::KeywordSnapshot() :
+    header_(nullptr),
+    dispatch_(nullptr),
+    keywords_(nullptr),
+    overloads_(nullptr),
+    args_(nullptr),
+    argTypes_(nullptr),
+    buckets_(nullptr),
+    slots_(nullptr),
+    strings_(nullptr),
+    dataSize_(0)
+{
+}
+
+// ----------------------------------------------------------------------------
+KeywordSnapshot::~KeywordSnapshot()
+{
+}
+
+// ----------------------------------------------------------------------------
+uint32_t KeywordSnapshot::slot(uint64_t hash, uint32_t seed, uint32_t slotCount)
+{
+    // splitmix64 finalizer, so every seed gives an unrelated slot
+    uint64_t x = hash + (uint64_t)(seed + 1) * 0x9E3779B97F4A7C15ull;
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+    x ^= x >> 31;
+    return (uint32_t)(x % slotCount);
+}
+
+// ----------------------------------------------------------------------------
+bool KeywordSnapshot::buildIndex(const std::vector<const Keyword*>& sorted,
+                                 std::vector<uint32_t>* buckets, std::vector<uint32_t>* slots)
+{
+    buckets->clear();
+    slots->clear();
+    if (sorted.empty())
+        return true;
+
+    std::vector<uint64_t> hashes(sorted.size());
+    for (std::size_t i = 0; i != sorted.size(); ++i)
+        hashes[i] = hashKeywordName(sorted[i]->name);
+
+    // Names that differ only in case or whitespace are the same keyword to
+    // find(), so a set holding both can't be indexed. They hash the same,
+    // as do the practically nonexistent distinct names with colliding
+    // 64-bit hashes, and no seed separates those either.
+    std::vector<uint64_t> sortedHashes(hashes);
+    std::sort(sortedHashes.begin(), sortedHashes.end());
+    if (std::adjacent_find(sortedHashes.begin(), sortedHashes.end()) != sortedHashes.end())
+        return false;
+
+    // About four names per bucket and a few more slots than names. With
+    // that much room, almost every bucket finds a seed within a few tries.
+    const uint32_t maxSeed = 1u << 16;
+    uint32_t bucketCount = (uint32_t)(sorted.size() + 3) / 4;
+    uint32_t slotCount = (uint32_t)(sorted.size() + sorted.size() / 4 + 1);
+    std::vector<std::vector<uint32_t>> members;
+    std::vector<uint32_t> order;
+    std::vector<uint32_t> taken;
+    for (int attempt = 0; attempt != 4; ++attempt, slotCount *= 2)
+    {
+        members.assign(bucketCount, std::vector<uint32_t>());
+        for (uint32_t i = 0; i != sorted.size(); ++i)
+            members[(hashes[i] >> 32) % bucketCount].push_back(i);
+
+        // Place the largest buckets first, while most slots are still free
+        order.resize(bucketCount);
+        std::iota(order.begin(), order.end(), 0);
+        std::stable_sort(order.begin(), order.end(), [&members](uint32_t a, uint32_t b) {
+            return members[a].size() > members[b].size();
+        });
+
+        buckets->assign(bucketCount, 0);
+        slots->assign(slotCount, notFound);
+        bool success = true;
+        for (uint32_t bucket : order)
+        {
+            uint32_t seed;
+            for (seed = 0; seed != maxSeed; ++seed)
+            {
+                taken.clear();
+                for (uint32_t i : members[bucket])
+                {
+                    uint32_t s = slot(hashes[i], seed, slotCount);
+                    if ((*slots)[s] != notFound || std::find(taken.begin(), taken.end(), s) != taken.end())
+                        break;
+                    taken.push_back(s);
+                }
+                if (taken.size() == members[bucket].size())
+                    break;
+            }
+            if (seed == maxSeed)
+            {
+                success = false;
+                break;
+            }
+
+            (*buckets)[bucket] = seed;
+            for (std::size_t m = 0; m != taken.size(); ++m)
+                (*slots)[taken[m]] = members[bucket][m];
+        }
+
+        if (success)
+            return true;
+    }
+
+    buckets->clear();
+    slots->clear();
+    return false;
+}
+
+// ----------------------------------------------------------------------------
+bool KeywordSnapshot::serialize(const std::vector<const Keyword*>& keywords, std::vector<char>* data)
+{
+    std::vector<const Keyword*> sorted(keywords);
+    std::sort(sorted.begin(), sorted.end(), [](const Keyword* a, const Keyword* b) {
+        return a->name < b->name;
+    });
+
+    std::vector<KeywordEntry> keywordTable;
+    std::vector<OverloadEntry> overloadTable;
+    std::vector<DispatchEntry> dispatchTable;
+    std::vector<StringEntry> argTable;
+    std::vector<KeywordArgType> argTypes;
+    std::vector<char> strings;
+    auto addString = [&strings](const std::string& str) {
+        StringEntry entry = {(uint32_t)strings.size(), (uint32_t)str.length()};
+        strings.insert(strings.end(), str.begin(), str.end());
+        strings.push_back('\0');
+        return entry;
+    };
+
+    keywordTable.reserve(sorted.size());
+    for (const Keyword* keyword : sorted)
+    {
+        StringEntry name = addString(keyword->name);
+        StringEntry helpFile = addString(keyword->helpFile);
+
+        KeywordEntry entry;
+        entry.nameOffset = name.offset;
+        entry.nameLength = name.length;
+        entry.helpFileOffset = helpFile.offset;
+        entry.helpFileLength = helpFile.length;
+        entry.firstOverload = (uint32_t)overloadTable.size();
+        entry.overloadCount = (uint32_t)keyword->overloads.size();
+        entry.flags = keyword->hasReturnType ? HAS_RETURN_TYPE : 0;
+        keywordTable.push_back(entry);
+
+        // The types are parsed again rather than taken from the keyword's
+        // signatures, which callers don't have to have built
+        std::size_t firstDispatch = dispatchTable.size();
+        for (const auto& overload : keyword->overloads)
+        {
+            uint32_t firstArg = (uint32_t)argTable.size();
+            overloadTable.push_back({firstArg, (uint32_t)overload.size()});
+            for (const auto& arg : overload)
+            {
+                argTable.push_back(addString(arg));
+                argTypes.push_back(parseKeywordArgType(arg));
+            }
+
+            uint64_t key = keywordDispatchKey(argTypes.data() + firstArg, overload.size());
+            dispatchTable.push_back({key, (uint32_t)(dispatchTable.size() - firstDispatch), 0});
+        }
+        std::sort(dispatchTable.begin() + firstDispatch, dispatchTable.end(),
+            [](const DispatchEntry& a, const DispatchEntry& b) {
+                if (a.key != b.key)
+                    return a.key < b.key;
+                return a.overload < b.overload;
+            });
+    }
+
+    std::vector<uint32_t> buckets;
+    std::vector<uint32_t> slots;
+    if (buildIndex(sorted, &buckets, &slots) == false)
+        return false;
+
+    Header header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, snapshotMagic, sizeof(snapshotMagic));
+    header.formatVersion = snapshotFormatVersion;
+    header.odbcVersion = ODBC_VERSION;
+    header.keywordCount = (uint32_t)keywordTable.size();
+    header.overloadCount = (uint32_t)overloadTable.size();
+    header.argCount = (uint32_t)argTable.size();
+    header.stringsSize = (uint32_t)strings.size();
+    header.bucketCount = (uint32_t)buckets.size();
+    header.slotCount = (uint32_t)slots.size();
+
+    data->clear();
+    auto append = [data](const void* src, std::size_t size) {
+        data->insert(data->end(), (const char*)src, (const char*)src + size);
+    };
+    data->reserve(sizeof(header)
+               + dispatchTable.size() * sizeof(DispatchEntry)
+               + keywordTable.size() * sizeof(KeywordEntry)
+               + overloadTable.size() * sizeof(OverloadEntry)
+               + argTable.size() * sizeof(StringEntry)
+               + (buckets.size() + slots.size()) * sizeof(uint32_t)
+               + argTypes.size() * sizeof(KeywordArgType)
+               + strings.size());
+    // The dispatch table goes first so its 64-bit keys are aligned
+    append(&header, sizeof(header));
+    append(dispatchTable.data(), dispatchTable.size() * sizeof(DispatchEntry));
+    append(keywordTable.data(), keywordTable.size() * sizeof(KeywordEntry));
+    append(overloadTable.data(), overloadTable.size() * sizeof(OverloadEntry));
+    append(argTable.data(), argTable.size() * sizeof(StringEntry));
+    append(buckets.data(), buckets.size() * sizeof(uint32_t));
+    append(slots.data(), slots.size() * sizeof(uint32_t));
+    append(argTypes.data(), argTypes.size() * sizeof(KeywordArgType));
+    append(strings.data(), strings.size());
+    return true;
+}
+
+// ----------------------------------------------------------------------------
+std::unique_ptr<KeywordSnapshot> KeywordSnapshot::fromKeywords(const std::vector<const Keyword*>& keywords)
+{
+    std::unique_ptr<KeywordSnapshot> snapshot(new KeywordSnapshot);
+    if (serialize(keywords, &snapshot->owned_) == false)
+        return nullptr;
+    if (snapshot->setData(snapshot->owned_.data(), snapshot->owned_.size()) == false)
+        return nullptr;
+    return snapshot;
+}
+
+// ----------------------------------------------------------------------------
+std::unique_ptr<KeywordSnapshot> KeywordSnapshot::load(const std::string& fileName)
+{
+    std::unique_ptr<KeywordSnapshot> snapshot(new KeywordSnapshot);
+    snapshot->mapping_ = SourceBuffer::fromFile(fileName);
+    if (snapshot->mapping_ == nullptr)
+        return nullptr;
+    if (snapshot->setData(snapshot->mapping_->data(), snapshot->mapping_->size()) == false)
+        return nullptr;
+    return snapshot;
+}
+
+// ----------------------------------------------------------------------------
+bool KeywordSnapshot::write(const std::string& fileName, const std::vector<const Keyword*>& keywords)
+{
+    std::vector<char> data;
+    if (serialize(keywords, &data) == false)
+        return false;
+    return writeFile(fileName, data.data(), data.size());
+}
+
+// ----------------------------------------------------------------------------
+bool KeywordSnapshot::save(const std::string& fileName) const
+{
+    return writeFile(fileName, (const char*)header_, dataSize_);
+}
+
+// ----------------------------------------------------------------------------
+bool KeywordSnapshot::writeFile(const std::string& fileName, const char* data, std::size_t size)
+{
+    FILE* fp = fopen(fileName.c_str(), "wb");
+    if (fp == nullptr)
+        return false;
+
+    bool success = fwrite(data, 1, size, fp) == size;
+    if (fclose(fp) != 0)
+        success = false;
+    if (success == false)
+        remove(fileName.c_str());
+    return success;
+}
+
+// ----------------------------------------------------------------------------
+bool KeywordSnapshot::setData(const char* data, std::size_t size)
+{
+    if (size < sizeof(Header))
+        return false;
+
+    const Header* header = (const Header*)data;
+    if (memcmp(header->magic, snapshotMagic, sizeof(snapshotMagic)) != 0 ||
+        header->formatVersion != snapshotFormatVersion ||
+        header->odbcVersion != ODBC_VERSION)
+    {
+        return false;
+    }
+
+    std::size_t expectedSize = sizeof(Header)
+        + (std::size_t)header->overloadCount * sizeof(DispatchEntry)
+        + (std::size_t)header->keywordCount * sizeof(KeywordEntry)
+        + (std::size_t)header->overloadCount * sizeof(OverloadEntry)
+        + (std::size_t)header->argCount * sizeof(StringEntry)
+        + ((std::size_t)header->bucketCount + header->slotCount) * sizeof(uint32_t)
+        + (std::size_t)header->argCount * sizeof(KeywordArgType)
+        + header->stringsSize;
+    if (size != expectedSize)
+        return false;
+
+    header_ = header;
+    data += sizeof(Header);
+    dispatch_ = (const DispatchEntry*)data;
+    data += header->overloadCount * sizeof(DispatchEntry);
+    keywords_ = (const KeywordEntry*)data;
+    data += header->keywordCount * sizeof(KeywordEntry);
+    overloads_ = (const OverloadEntry*)data;
+    data += header->overloadCount * sizeof(OverloadEntry);
+    args_ = (const StringEntry*)data;
+    data += header->argCount * sizeof(StringEntry);
+    buckets_ = (const uint32_t*)data;
+    data += header->bucketCount * sizeof(uint32_t);
+    slots_ = (const uint32_t*)data;
+    data += header->slotCount * sizeof(uint32_t);
+    argTypes_ = (const KeywordArgType*)data;
+    data += header->argCount * sizeof(KeywordArgType);
+    strings_ = data;
+    dataSize_ = size;
+
+    // Check every reference once here so the accessors don't have to
+    auto validString = [header](uint32_t offset, uint32_t length) {
+        return (uint64_t)offset + length < header->stringsSize;
+    };
+    for (uint32_t i = 0; i != header->keywordCount; ++i)
+    {
+        const KeywordEntry& keyword = keywords_[i];
+        if (validString(keyword.nameOffset, keyword.nameLength) == false ||
+            validString(keyword.helpFileOffset, keyword.helpFileLength) == false ||
+            (uint64_t)keyword.firstOverload + keyword.overloadCount > header->overloadCount)
+        {
+            return false;
+        }
+        if (i > 0 && name(i - 1) >= name(i))
+            return false;
+        for (uint32_t d = 0; d != keyword.overloadCount; ++d)
+        {
+            const DispatchEntry* entry = dispatch_ + keyword.firstOverload + d;
+            if (entry->overload >= keyword.overloadCount || (d > 0 && entry[-1].key > entry->key))
+                return false;
+        }
+    }
+    for (uint32_t i = 0; i != header->overloadCount; ++i)
+        if ((uint64_t)overloads_[i].firstArg + overloads_[i].argCount > header->argCount)
+            return false;
+    for (uint32_t i = 0; i != header->argCount; ++i)
+        if (validString(args_[i].offset, args_[i].length) == false ||
+            (uint8_t)argTypes_[i] > (uint8_t)KeywordArgType::String)
+        {
+            return false;
+        }
+    if ((header->bucketCount == 0) != (header->keywordCount == 0) ||
+        (header->slotCount == 0) != (header->keywordCount == 0))
+    {
+        return false;
+    }
+    for (uint32_t i = 0; i != header->slotCount; ++i)
+        if (slots_[i] != notFound && slots_[i] >= header->keywordCount)
+            return false;
+
+    return true;
+}
+
+// ----------------------------------------------------------------------------
+KeywordSnapshot::Index KeywordSnapshot::find(std::string_view name) const
+{
+    return find(name, hashKeywordName(name));
+}
+
+// ----------------------------------------------------------------------------
+KeywordSnapshot::Index KeywordSnapshot::find(std::string_view name, uint64_t hash) const
+{
+    if (header_->keywordCount == 0)
+        return notFound;
+
+    uint32_t seed = buckets_[(hash >> 32) % header_->bucketCount];
+    Index keyword = slots_[slot(hash, seed, header_->slotCount)];
+    if (keyword == notFound || keywordNamesEqual(this->name(keyword), name) == false)
+        return notFound;
+    return keyword;
+}
+
+// ----------------------------------------------------------------------------
+std::string_view KeywordSnapshot::string(uint32_t offset, uint32_t length) const
+{
+    return std::string_view(strings_ + offset, length);
+}
+
+// ----------------------------------------------------------------------------
+std::string_view KeywordSnapshot::name(Index keyword) const
+{
+    return string(keywords_[keyword].nameOffset, keywords_[keyword].nameLength);
+}
+
+// ----------------------------------------------------------------------------
+std::string_view KeywordSnapshot::helpFile(Index keyword) const
+{
+    return string(keywords_[keyword].helpFileOffset, keywords_[keyword].helpFileLength);
+}
+
+// ----------------------------------------------------------------------------
+std::size_t KeywordSnapshot::argCount(Index keyword, std::size_t overload) const
+{
+    return overloads_[keywords_[keyword].firstOverload + overload].argCount;
+}
+
+// ----------------------------------------------------------------------------
+std::string_view KeywordSnapshot::arg(Index keyword, std::size_t overload, std::size_t arg) const
+{
+    const StringEntry& entry = args_[overloads_[keywords_[keyword].firstOverload + overload].firstArg + arg];
+    return string(entry.offset, entry.length);
+}
+
+// ----------------------------------------------------------------------------
+KeywordArgType KeywordSnapshot::argType(Index keyword, std::size_t overload, std::size_t arg) const
+{
+    return argTypes_[overloads_[keywords_[keyword].firstOverload + overload].firstArg + arg];
+}
+
+// ----------------------------------------------------------------------------
+int KeywordSnapshot::resolveOverload(Index keyword, const KeywordArgType* args, std::size_t count) const
+{
+    const KeywordEntry& entry = keywords_[keyword];
+    const DispatchEntry* dispatch = dispatch_ + entry.firstOverload;
+    const OverloadEntry* overloads = overloads_ + entry.firstOverload;
+    return resolveKeywordOverload(entry.overloadCount,
+        [dispatch](std::size_t i) { return dispatch[i].key; },
+        [dispatch](std::size_t i) { return dispatch[i].overload; },
+        [this, overloads](uint32_t overload) {
+            return KeywordSignature{argTypes_ + overloads[overload].firstArg,
+                                    overloads[overload].argCount};
+        },
+        args, count);
+}
+
+// ----------------------------------------------------------------------------
+Keyword KeywordSnapshot::toKeyword(Index keyword) const
+{
+    Keyword result;
+    result.name = std::string(name(keyword));
+    result.helpFile = std::string(helpFile(keyword));
+    result.hasReturnType = hasReturnType(keyword);
+    result.overloads.resize(overloadCount(keyword));
+    result.signatures.resize(overloadCount(keyword));
+    for (std::size_t o = 0; o != result.overloads.size(); ++o)
+        for (std::size_t a = 0; a != argCount(keyword, o); ++a)
+        {
+            result.overloads[o].emplace_back(arg(keyword, o, a));
+            result.signatures[o].push_back(argType(keyword, o, a));
+        }
+
+    const DispatchEntry* dispatch = dispatch_ + keywords_[keyword].firstOverload;
+    result.dispatch.reserve(overloadCount(keyword));
+    for (std::size_t d = 0; d != overloadCount(keyword); ++d)
+        result.dispatch.emplace_back(dispatch[d].key, dispatch[d].overload);
+    return result;
+}
+
+}
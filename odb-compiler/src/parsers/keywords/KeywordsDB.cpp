@@ -1,14 +1,209 @@
 #include "odbc/parsers/keywords/KeywordsDB.hpp"
 #include "odbc/parsers/keywords/Driver.hpp"
-#include <cstdio>
-#include <iostream>
+#include "odbc/parsers/SourceBuffer.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <filesystem>
+#include <thread>
 
 namespace odbc {
 
 // ----------------------------------------------------------------------------
-bool KeywordDB::loadFromDirectory(const std::string& dir)
+bool KeywordDB::loadFromDirectory(const std::string& dir, unsigned threads)
 {
-    return false;
+    if (frozen_)
+        return false;
+
+    std::vector<std::string> fileNames;
+    std::error_code ec;
+    for (const auto& entry : std::filesystem::directory_iterator(dir, ec))
+        if (entry.is_regular_file() && entry.path().extension() == ".ini")
+            fileNames.push_back(entry.path().string());
+    if (ec)
+        return false;
+    std::sort(fileNames.begin(), fileNames.end());
+
+    // Each file is parsed into its own DB, so workers share nothing but the
+    // index of the next file to parse
+    std::vector<KeywordDB> fileDBs(fileNames.size());
+    std::unique_ptr<bool[]> fileResults(new bool[fileNames.size()]);
+    std::atomic<std::size_t> nextFile(0);
+    auto worker = [&]() {
+        for (std::size_t i = nextFile++; i < fileNames.size(); i = nextFile++)
+            fileResults[i] = fileDBs[i].appendFromFile(fileNames[i]);
+    };
+
+    if (threads == 0)
+        threads = std::max(std::thread::hardware_concurrency(), 1u);
+    if (threads > fileNames.size())
+        threads = (unsigned)fileNames.size();
+
+    if (threads <= 1)
+        worker();
+    else
+    {
+        std::vector<std::thread> pool;
+        pool.reserve(threads);
+        for (unsigned t = 0; t != threads; ++t)
+            pool.emplace_back(worker);
+        for (auto& thread : pool)
+            thread.join();
+    }
+
+    // Merge in file name order. Map nodes are moved over as they are, so
+    // no keyword is copied.
+    bool success = true;
+    std::vector<KeywordConflict>& conflicts = report_.conflicts;
+    std::size_t firstConflict = conflicts.size();
+    for (std::size_t i = 0; i != fileNames.size(); ++i)
+    {
+        if (fileResults[i] == false)
+            success = false;
+        std::size_t fileIndex = addKeywordFile(fileNames[i]);
+
+        KeywordLoadReport& fileReport = fileDBs[i].report_;
+        for (auto& file : fileReport.files)
+            report_.files.push_back(std::move(file));
+        for (auto& conflict : fileReport.conflicts)
+            conflicts.push_back(std::move(conflict));
+
+        auto& fileMap = fileDBs[i].map_;
+        while (fileMap.empty() == false)
+        {
+            auto node = fileMap.extract(fileMap.begin());
+            uint64_t hash = hashKeywordName(node.key());
+            if (isKnown(node.key(), hash))
+            {
+                conflicts.push_back({node.key(), firstFileOf(node.key(), hash), fileNames[i]});
+                continue;
+            }
+
+            report_.keywordCount++;
+            report_.overloadCount += node.mapped().overloads.size();
+            const Keyword* keyword = &map_.insert(std::move(node)).position->second;
+            index_.emplace(hash, AddedKeyword{keyword, fileIndex});
+        }
+    }
+
+    // Keywords within a file come out of an unordered_map, so sort to keep
+    // the report stable
+    std::sort(conflicts.begin() + firstConflict, conflicts.end(),
+        [](const KeywordConflict& a, const KeywordConflict& b) {
+            if (a.secondFile != b.secondFile)
+                return a.secondFile < b.secondFile;
+            return a.name < b.name;
+        });
+
+    return success;
+}
+
+// ----------------------------------------------------------------------------
+static void keywordNameOf(std::string_view text, std::string* name)
+{
+    // The keyword scanner skips characters it has no rule for, so the name
+    // the parser sees is what's left of the text without them and without
+    // spaces at either end
+    name->clear();
+    for (char c : text)
+        if (isalnum((unsigned char)c) || c == '_' || c == ' ' || c == '$' || c == '#')
+            name->push_back(c);
+
+    std::size_t begin = name->find_first_not_of(' ');
+    if (begin == std::string::npos)
+    {
+        name->clear();
+        return;
+    }
+    name->erase(name->find_last_not_of(' ') + 1);
+    name->erase(0, begin);
+}
+
+// ----------------------------------------------------------------------------
+bool KeywordDB::indexDirectory(const std::string& dir)
+{
+    if (frozen_)
+        return false;
+
+    std::vector<std::string> fileNames;
+    std::error_code ec;
+    for (const auto& entry : std::filesystem::directory_iterator(dir, ec))
+        if (entry.is_regular_file() && entry.path().extension() == ".ini")
+            fileNames.push_back(entry.path().string());
+    if (ec)
+        return false;
+    std::sort(fileNames.begin(), fileNames.end());
+
+    bool success = true;
+    std::size_t firstConflict = report_.conflicts.size();
+    std::string nameBuffer;
+    for (auto& fileName : fileNames)
+    {
+        auto start = std::chrono::steady_clock::now();
+        KeywordLoadReport::File file;
+        file.fileName = fileName;
+        file.keywordCount = 0;
+
+        std::unique_ptr<SourceBuffer> source = SourceBuffer::fromFile(fileName);
+        file.success = (source != nullptr);
+        std::string_view contents;
+        std::size_t fileIndex = 0;
+        if (source)
+        {
+            contents = std::string_view(source->data(), source->size());
+
+            // Added before the names so a name defined twice in this file
+            // can report it as the first definition too
+            fileIndex = indexedFiles_.size();
+            indexedFiles_.push_back({fileName, nullptr});
+        }
+
+        // The name comes from the text before the first '=' of each line.
+        // Lines without one are left for the parser to complain about.
+        for (std::size_t lineBegin = 0; lineBegin < contents.size(); )
+        {
+            std::size_t lineEnd = lineBegin;
+            while (lineEnd != contents.size() && contents[lineEnd] != '\n')
+                lineEnd++;
+            std::string_view line(contents.data() + lineBegin, lineEnd - lineBegin);
+            lineBegin = lineEnd + 1;
+
+            std::size_t eq = line.find('=');
+            if (eq == std::string_view::npos)
+                continue;
+            keywordNameOf(line.substr(0, eq), &nameBuffer);
+            std::string_view name = nameBuffer;
+            if (name.empty())
+                continue;
+
+            file.keywordCount++;
+            uint64_t hash = hashKeywordName(name);
+            if (isKnown(name, hash))
+            {
+                report_.conflicts.push_back({std::string(name), firstFileOf(name, hash), fileName});
+                continue;
+            }
+
+            indexedNames_.emplace(hash, IndexedName{std::string(name), fileIndex});
+            report_.keywordCount++;
+        }
+
+        if (file.success == false)
+            success = false;
+
+        file.parseTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        report_.files.push_back(std::move(file));
+    }
+
+    std::sort(report_.conflicts.begin() + firstConflict, report_.conflicts.end(),
+        [](const KeywordConflict& a, const KeywordConflict& b) {
+            if (a.secondFile != b.secondFile)
+                return a.secondFile < b.secondFile;
+            return a.name < b.name;
+        });
+
+    return success;
 }
 
 // ----------------------------------------------------------------------------
@@ -16,54 +211,294 @@ bool KeywordDB::appendFromFile(const std::string& fileName)
 {
     bool result;
 
-    FILE* fp = fopen(fileName.c_str(), "rb");
-    if (fp == nullptr)
+    if (frozen_)
+        return false;
+
+    std::unique_ptr<SourceBuffer> source = SourceBuffer::fromFile(fileName);
+    if (source == nullptr)
         return false;
 
+    std::size_t definedBefore = report_.keywordCount + report_.conflicts.size();
+    auto start = std::chrono::steady_clock::now();
+
+    currentFile_ = addKeywordFile(fileName);
     odbc::kw::Driver driver(this);
-    result = driver.parseStream(fp);
+    result = driver.parseBuffer(*source);
+    currentFile_ = noFile;
+
+    KeywordLoadReport::File file;
+    file.fileName = fileName;
+    file.success = result;
+    file.keywordCount = report_.keywordCount + report_.conflicts.size() - definedBefore;
+    file.parseTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    report_.files.push_back(std::move(file));
 
-    fclose(fp);
     return result;
 }
 
 // ----------------------------------------------------------------------------
-bool KeywordDB::exists(const std::string& keyword)
+bool KeywordDB::exists(std::string_view keyword) const
+{
+    return exists(keyword, hashKeywordName(keyword));
+}
+
+// ----------------------------------------------------------------------------
+bool KeywordDB::exists(std::string_view keyword, uint64_t hash) const
+{
+    if (snapshot_ && snapshot_->find(keyword, hash) != KeywordSnapshot::notFound)
+        return true;
+    return isKnown(keyword, hash);
+}
+
+// ----------------------------------------------------------------------------
+bool KeywordDB::loadSnapshot(const std::string& fileName)
+{
+    if (frozen_)
+        return false;
+
+    std::unique_ptr<KeywordSnapshot> snapshot = KeywordSnapshot::load(fileName);
+    if (snapshot == nullptr)
+        return false;
+    snapshotKeywords_.clear();
+    snapshot_ = std::move(snapshot);
+    return true;
+}
+
+// ----------------------------------------------------------------------------
+bool KeywordDB::loadSnapshotOrDirectory(const std::string& fileName, const std::string& dir)
+{
+    if (frozen_)
+        return false;
+
+    // Adding or removing a file changes the directory's time, editing one
+    // only changes the file's
+    std::error_code ec;
+    auto snapshotTime = std::filesystem::last_write_time(fileName, ec);
+    bool stale = bool(ec);
+    if (stale == false && dir.empty() == false)
+    {
+        if (std::filesystem::last_write_time(dir, ec) > snapshotTime)
+            stale = true;
+        for (const auto& entry : std::filesystem::directory_iterator(dir, ec))
+            if (entry.is_regular_file() && entry.path().extension() == ".ini" &&
+                entry.last_write_time(ec) > snapshotTime)
+            {
+                stale = true;
+                break;
+            }
+    }
+
+    if (stale == false && loadSnapshot(fileName))
+        return true;
+    if (dir.empty())
+        return false;
+    return indexDirectory(dir);
+}
+
+// ----------------------------------------------------------------------------
+bool KeywordDB::writeSnapshot(const std::string& fileName) const
 {
-    return map_.find(keyword) != map_.end();
+    if (frozen_)
+        return snapshot_->save(fileName);
+
+    std::vector<const Keyword*> keywords;
+    keywords.reserve(map_.size() + indexedNames_.size());
+    for (const auto& it : map_)
+        keywords.push_back(&it.second);
+    for (const auto& it : indexedNames_)
+        if (const Keyword* keyword = lookupIndexed(it.second.name, it.first))
+            keywords.push_back(keyword);
+    return KeywordSnapshot::write(fileName, keywords);
+}
+
+// ----------------------------------------------------------------------------
+bool KeywordDB::freeze()
+{
+    if (frozen_)
+        return false;
+
+    // Keywords that were added win over those of a loaded snapshot, same as
+    // for exists()
+    std::vector<const Keyword*> keywords;
+    std::vector<Keyword> fromSnapshot;
+    keywords.reserve(map_.size() + indexedNames_.size() + (snapshot_ ? snapshot_->size() : 0));
+    for (const auto& it : map_)
+        keywords.push_back(&it.second);
+    for (const auto& it : indexedNames_)
+        if (const Keyword* keyword = lookupIndexed(it.second.name, it.first))
+            keywords.push_back(keyword);
+    if (snapshot_)
+    {
+        fromSnapshot.reserve(snapshot_->size());
+        for (KeywordSnapshot::Index i = 0; i != snapshot_->size(); ++i)
+            if (isKnown(snapshot_->name(i), hashKeywordName(snapshot_->name(i))) == false)
+                fromSnapshot.push_back(snapshot_->toKeyword(i));
+        for (const auto& keyword : fromSnapshot)
+            keywords.push_back(&keyword);
+    }
+
+    std::unique_ptr<KeywordSnapshot> frozen = KeywordSnapshot::fromKeywords(keywords);
+    if (frozen == nullptr)
+        return false;
+
+    snapshotKeywords_.clear();
+    snapshot_ = std::move(frozen);
+    decltype(map_)().swap(map_);
+    decltype(index_)().swap(index_);
+    decltype(keywordFiles_)().swap(keywordFiles_);
+    decltype(indexedNames_)().swap(indexedNames_);
+    decltype(indexedFiles_)().swap(indexedFiles_);
+    frozen_ = true;
+    return true;
 }
 
 // ----------------------------------------------------------------------------
-bool KeywordDB::addKeyword(Keyword keyword)
+bool KeywordDB::addKeyword(Keyword&& keyword)
 {
-    std::cout << keyword.name << "=" << keyword.helpFile << ": ";
-    if (keyword.hasReturnType)
-        std::cout << "(";
-    for (const auto& overload : keyword.overloads)
+    if (frozen_)
+        return false;
+
+    uint64_t hash = hashKeywordName(keyword.name);
+    if (isKnown(keyword.name, hash))
     {
-        std::cout << "[";
-        auto it = overload.begin();
-        if (it != overload.end())
-            std::cout << *it++;
-        while (it != overload.end())
-            std::cout << ", " << *it++;
-        std::cout << "]";
+        std::string firstFile = firstFileOf(keyword.name, hash);
+        report_.conflicts.push_back({std::move(keyword.name), std::move(firstFile),
+                                     currentFile_ != noFile ? keywordFiles_[currentFile_] : std::string()});
+        return false;
     }
-    if (keyword.hasReturnType)
-        std::cout << ")";
-    std::cout << std::endl;
 
-    auto result = map_.insert({keyword.name, keyword});
-    return result.second;
+    keyword.buildSignatures();
+
+    // The key needs its own copy of the name, everything else is moved
+    std::string name = keyword.name;
+    std::size_t overloadCount = keyword.overloads.size();
+    auto result = map_.try_emplace(std::move(name), std::move(keyword));
+    index_.emplace(hash, AddedKeyword{&result.first->second, currentFile_});
+
+    report_.keywordCount++;
+    report_.overloadCount += overloadCount;
+    return true;
 }
 
 // ----------------------------------------------------------------------------
-const Keyword* KeywordDB::lookup(const std::string& keyword) const
+std::unique_ptr<CommandTrie> KeywordDB::createCommandTrie() const
 {
-    auto result = map_.find(keyword);
-    if (result == map_.end())
+    return CommandTrie::fromNames(getKeywordNames());
+}
+
+// ----------------------------------------------------------------------------
+std::vector<std::string> KeywordDB::getKeywordNames() const
+{
+    std::vector<std::string> names;
+    names.reserve(map_.size() + indexedNames_.size() + (snapshot_ ? snapshot_->size() : 0));
+    for (const auto& it : map_)
+        names.push_back(it.first);
+    for (const auto& it : indexedNames_)
+        names.push_back(it.second.name);
+    if (snapshot_)
+        for (KeywordSnapshot::Index i = 0; i != snapshot_->size(); ++i)
+            names.emplace_back(snapshot_->name(i));
+
+    return names;
+}
+
+// ----------------------------------------------------------------------------
+const Keyword* KeywordDB::lookup(std::string_view keyword) const
+{
+    return lookup(keyword, hashKeywordName(keyword));
+}
+
+// ----------------------------------------------------------------------------
+const Keyword* KeywordDB::lookup(std::string_view keyword, uint64_t hash) const
+{
+    auto range = index_.equal_range(hash);
+    for (auto it = range.first; it != range.second; ++it)
+        if (keywordNamesEqual(it->second.keyword->name, keyword))
+            return it->second.keyword;
+    if (const Keyword* indexed = lookupIndexed(keyword, hash))
+        return indexed;
+    return lookupSnapshot(keyword, hash);
+}
+
+// ----------------------------------------------------------------------------
+bool KeywordDB::isKnown(std::string_view keyword, uint64_t hash) const
+{
+    auto range = index_.equal_range(hash);
+    for (auto it = range.first; it != range.second; ++it)
+        if (keywordNamesEqual(it->second.keyword->name, keyword))
+            return true;
+
+    auto indexed = indexedNames_.equal_range(hash);
+    for (auto it = indexed.first; it != indexed.second; ++it)
+        if (keywordNamesEqual(it->second.name, keyword))
+            return true;
+
+    return false;
+}
+
+// ----------------------------------------------------------------------------
+const Keyword* KeywordDB::lookupSnapshot(std::string_view keyword, uint64_t hash) const
+{
+    if (snapshot_ == nullptr)
         return nullptr;
-    return &result->second;
+    KeywordSnapshot::Index index = snapshot_->find(keyword, hash);
+    if (index == KeywordSnapshot::notFound)
+        return nullptr;
+
+    // Copies are kept until the snapshot is replaced, so the keyword stays
+    // valid after the lock is released
+    std::lock_guard<std::mutex> lock(snapshotMutex_);
+    auto it = snapshotKeywords_.find(index);
+    if (it == snapshotKeywords_.end())
+        it = snapshotKeywords_.emplace(index, snapshot_->toKeyword(index)).first;
+    return &it->second;
+}
+
+// ----------------------------------------------------------------------------
+std::string KeywordDB::firstFileOf(std::string_view keyword, uint64_t hash) const
+{
+    auto range = index_.equal_range(hash);
+    for (auto it = range.first; it != range.second; ++it)
+        if (keywordNamesEqual(it->second.keyword->name, keyword))
+            return it->second.file != noFile ? keywordFiles_[it->second.file] : std::string();
+
+    auto indexed = indexedNames_.equal_range(hash);
+    for (auto it = indexed.first; it != indexed.second; ++it)
+        if (keywordNamesEqual(it->second.name, keyword))
+            return indexedFiles_[it->second.file].fileName;
+
+    return std::string();
+}
+
+// ----------------------------------------------------------------------------
+std::size_t KeywordDB::addKeywordFile(const std::string& fileName)
+{
+    keywordFiles_.push_back(fileName);
+    return keywordFiles_.size() - 1;
+}
+
+// ----------------------------------------------------------------------------
+const Keyword* KeywordDB::lookupIndexed(std::string_view keyword, uint64_t hash) const
+{
+    auto range = indexedNames_.equal_range(hash);
+    for (auto it = range.first; it != range.second; ++it)
+    {
+        if (keywordNamesEqual(it->second.name, keyword) == false)
+            continue;
+
+        // Parsed files are never unloaded, so the keyword stays valid after
+        // the lock is released
+        std::lock_guard<std::mutex> lock(indexedMutex_);
+        IndexedFile& file = indexedFiles_[it->second.file];
+        if (file.db == nullptr)
+        {
+            file.db.reset(new KeywordDB);
+            file.db->appendFromFile(file.fileName);
+        }
+        return file.db->lookup(keyword, hash);
+    }
+
+    return nullptr;
 }
 
 }
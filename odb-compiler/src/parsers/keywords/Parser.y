@@ -8,6 +8,7 @@
 
     #define driver (static_cast<odbc::kw::Driver*>(kwget_extra(scanner)))
     #define error(x, ...) kwerror(kwpushed_loc, scanner, x, __VA_ARGS__)
+    #define view(x) std::string_view((x).str, (std::size_t)(x).length)
 
     using namespace odbc;
 }
@@ -17,6 +18,12 @@
     #include <stdint.h>
     typedef void* kwscan_t;
 
+    /* Tokens point into the buffer being scanned and are not NUL terminated */
+    typedef struct kwstring_t {
+        const char* str;
+        int length;
+    } kwstring_t;
+
     namespace odbc {
         namespace kw {
             class Driver;
@@ -59,7 +66,7 @@
 
 /* This is the union that will become known as YYSTYPE in the generated code */
 %union {
-    char* string;
+    kwstring_t string;
 }
 
 %define api.token.prefix {TOK_}
@@ -73,8 +80,6 @@
 
 %type<kw_help> kw_help;
 
-%destructor { free($$); } <string>
-
 %start start
 
 %%
@@ -101,7 +106,7 @@ keyword
   | kw_help EQ start_retargs               { driver->finishKeyword(); }
   ;
 kw_help
-  : WORDS EQ HELPFILE                      { driver->setKeywordName($1); driver->setHelpFile($3); }
+  : WORDS EQ HELPFILE                      { driver->setKeywordName(view($1)); driver->setHelpFile(view($3)); }
   ;
 start_normarg_overloads
   : normarg_overloads                      {  }
@@ -136,12 +141,12 @@ args
   | arg                                    {  }
   ;
 arg
-  : WORDS                                  { driver->addArg($1); }
-  | WORDS LB options RB                    { driver->addArg($1); }
+  : WORDS                                  { driver->addArg(view($1)); }
+  | WORDS LB options RB                    { driver->addArg(view($1)); }
   ;
 options
-  : WORDS COMMA options                    { free($1); }
-  | WORDS                                  { free($1); }
+  : WORDS COMMA options                    {  }
+  | WORDS                                  {  }
   ;
 %%
 
@@ -0,0 +1,50 @@
+#include "odbc/parsers/keywords/KeywordsDB.hpp"
+#include <algorithm>
+#include <filesystem>
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+/*
+ * Parses every .ini file in a directory and writes the resulting keyword set
+ * to a snapshot file that KeywordDB::loadSnapshot() can map.
+ */
+int main(int argc, char** argv)
+{
+    if (argc != 3)
+    {
+        printf("Usage: %s <keyword directory> <output file>\n", argv[0]);
+        return 1;
+    }
+
+    // Sort so that the same input always produces the same snapshot
+    std::vector<std::string> fileNames;
+    std::error_code ec;
+    for (const auto& entry : std::filesystem::directory_iterator(argv[1], ec))
+        if (entry.is_regular_file() && entry.path().extension() == ".ini")
+            fileNames.push_back(entry.path().string());
+    if (ec)
+    {
+        fprintf(stderr, "Failed to read directory %s: %s\n", argv[1], ec.message().c_str());
+        return 1;
+    }
+    std::sort(fileNames.begin(), fileNames.end());
+
+    // A file that doesn't parse completely shouldn't break the build. Its
+    // keywords up to the error are still kept.
+    odbc::KeywordDB db;
+    for (const auto& fileName : fileNames)
+        if (db.appendFromFile(fileName) == false)
+            fprintf(stderr, "Warning: Failed to parse %s\n", fileName.c_str());
+    for (const auto& conflict : db.getLoadReport().conflicts)
+        fprintf(stderr, "Warning: %s: Keyword \"%s\" is already defined\n",
+                conflict.secondFile.c_str(), conflict.name.c_str());
+
+    if (db.writeSnapshot(argv[2]) == false)
+    {
+        fprintf(stderr, "Failed to write %s\n", argv[2]);
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,19 @@
+#pragma once
+
+#include <cstdio>
+#include <filesystem>
+#include <random>
+#include <string>
+
+/*!
+ * Returns a path in the temp directory that starts with name and ends with
+ * extension. A random part in between keeps tests running at the same time,
+ * e.g. from two build directories, from using the same files.
+ */
+inline std::filesystem::path uniqueTempPath(const std::string& name, const std::string& extension = "")
+{
+    static std::mt19937_64 rng(std::random_device{}());
+    char suffix[17];
+    snprintf(suffix, sizeof(suffix), "%016llx", (unsigned long long)rng());
+    return std::filesystem::temp_directory_path() / (name + "_" + suffix + extension);
+}
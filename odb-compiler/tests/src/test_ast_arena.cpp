@@ -0,0 +1,88 @@
+#include <gmock/gmock.h>
+#include "odbc/ast/Arena.hpp"
+#include "odbc/ast/Node.hpp"
+#include "odbc/parsers/db/Driver.hpp"
+#include <cstdint>
+
+#define NAME ast_arena
+
+using namespace testing;
+
+class NAME : public Test
+{
+public:
+};
+
+using namespace odbc;
+
+TEST_F(NAME, allocations_are_aligned)
+{
+    ast::Arena arena(1024);
+    for (int i = 0; i != 100; ++i)
+    {
+        arena.allocate(1, 1);
+        void* p = arena.allocate(sizeof(double), alignof(double));
+        ASSERT_THAT((std::uintptr_t)p % alignof(double), Eq(0u));
+    }
+}
+
+TEST_F(NAME, oversized_allocation_gets_own_chunk)
+{
+    ast::Arena arena(1024);
+    char* small = (char*)arena.allocate(16, 1);
+    char* big = (char*)arena.allocate(4096, 1);
+    char* small2 = (char*)arena.allocate(16, 1);
+    ASSERT_THAT(big, NotNull());
+    ASSERT_THAT(small2, Eq(small + 16));
+}
+
+TEST_F(NAME, strdup_copies_string)
+{
+    ast::Arena arena;
+    const char* str = "hello world";
+    char* copy = arena.strdup(str);
+    ASSERT_THAT(copy, StrEq("hello world"));
+    ASSERT_THAT(copy, Ne(str));
+    ASSERT_THAT(arena.strndup(str, 5), StrEq("hello"));
+}
+
+TEST_F(NAME, released_nodes_are_reused)
+{
+    ast::Arena arena;
+    ast::node_t* a = ast::newIntegerLiteral(&arena, 1);
+    std::size_t used = arena.bytesUsed();
+    ast::freeNode(&arena, a);
+    ast::node_t* b = ast::newIntegerLiteral(&arena, 2);
+    ASSERT_THAT(b, Eq(a));
+    ASSERT_THAT(arena.bytesUsed(), Eq(used));
+}
+
+TEST_F(NAME, reset_keeps_peak)
+{
+    ast::Arena arena(1024);
+    for (int i = 0; i != 1000; ++i)
+        ast::newIntegerLiteral(&arena, i);
+    std::size_t peak = arena.bytesUsed();
+    ASSERT_THAT(peak, Ge(1000 * sizeof(ast::node_t)));
+
+    arena.reset();
+    ASSERT_THAT(arena.bytesUsed(), Eq(0u));
+    ASSERT_THAT(arena.bytesReserved(), Le(1024u));
+    ASSERT_THAT(arena.peakBytesUsed(), Eq(peak));
+
+    ast::newIntegerLiteral(&arena, 1);
+    ASSERT_THAT(arena.peakBytesUsed(), Eq(peak));
+}
+
+TEST_F(NAME, driver_frees_ast_by_resetting_arena)
+{
+    db::Driver driver;
+    ASSERT_THAT(driver.parseString("a=1\nb=2\n"), IsTrue());
+    ASSERT_THAT(driver.getAST(), NotNull());
+    ASSERT_THAT(driver.getArena()->bytesUsed(), Gt(0u));
+
+    driver.freeAST();
+    ASSERT_THAT(driver.getAST(), IsNull());
+    ASSERT_THAT(driver.getArena()->bytesUsed(), Eq(0u));
+    ASSERT_THAT(driver.getArena()->peakBytesUsed(), Gt(0u));
+}
@@ -0,0 +1,229 @@
+#include <gmock/gmock.h>
+#include "odbc/ast/Arena.hpp"
+#include "odbc/ast/FlatAST.hpp"
+#include "odbc/ast/Node.hpp"
+#include "odbc/ast/StringTable.hpp"
+#include "odbc/ast/Traversal.hpp"
+#include "odbc/tests/TempPath.hpp"
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#define NAME ast_flat
+
+using namespace testing;
+using namespace odbc;
+
+class NAME : public Test
+{
+public:
+    NAME() : strings(&arena) {}
+
+    ast::node_t* newVariable(const char* name)
+    {
+        return ast::newSymbol(&arena, &strings, strings.intern(name), nullptr, nullptr,
+                              ast::ST_VARIABLE, ast::SDT_INTEGER, ast::SS_LOCAL, ast::SD_REF);
+    }
+
+    // a = 1 + 2.5
+    // b = "hello"
+    // a = true
+    ast::node_t* newProgram()
+    {
+        ast::node_t* block = ast::newBlock(&arena, ast::newAssignment(&arena, newVariable("a"),
+            ast::newOp(&arena, ast::newIntegerLiteral(&arena, 1), ast::newFloatLiteral(&arena, 2.5), ast::OP_ADD)), nullptr);
+        ast::appendStatementToBlock(&arena, block, ast::newAssignment(&arena, newVariable("b"),
+            ast::newStringLiteral(&arena, arena.strdup("hello"))));
+        ast::appendStatementToBlock(&arena, block, ast::newAssignment(&arena, newVariable("a"),
+            ast::newBooleanLiteral(&arena, true)));
+        return block;
+    }
+
+    // Flattens a tree into a string so two trees can be compared
+    static std::string describe(ast::node_t* root)
+    {
+        std::string s;
+        ast::Traversal().preOrder(root, [&s](ast::node_t* node) {
+            s += std::to_string(node->info.type) + "(";
+            switch (node->info.type)
+            {
+                case ast::NT_SYMBOL:
+                    s += node->symbol.name;
+                    s += ":" + std::to_string(node->symbol.flags);
+                    break;
+                case ast::NT_OP:
+                    s += std::to_string(node->op.operation);
+                    break;
+                case ast::NT_LITERAL:
+                    switch (node->literal.type)
+                    {
+                        case ast::LT_BOOLEAN: s += node->literal.value.b ? "true" : "false"; break;
+                        case ast::LT_INTEGER: s += std::to_string(node->literal.value.i); break;
+                        case ast::LT_FLOAT: s += std::to_string(node->literal.value.f); break;
+                        case ast::LT_STRING: s += node->literal.value.s; break;
+                    }
+                    break;
+                default:
+                    break;
+            }
+            s += node->base.left ? "L" : "";
+            s += node->base.right ? "R" : "";
+            ast::SourceSpan span = ast::getSpan(node);
+            s += "@" + std::to_string(span.offset) + "+" + std::to_string(span.length);
+            s += ")";
+            return true;
+        });
+        return s;
+    }
+
+    ast::Arena arena;
+    ast::StringTable strings;
+};
+
+TEST_F(NAME, round_trip_preserves_tree)
+{
+    ast::node_t* original = newProgram();
+    ast::FlatAST flat;
+    flat.build(original);
+
+    ast::Arena otherArena;
+    ast::StringTable otherStrings(&otherArena);
+    ast::node_t* copy = flat.toTree(&otherArena, &otherStrings);
+    ASSERT_THAT(copy, NotNull());
+    ASSERT_THAT(describe(copy), Eq(describe(original)));
+
+    // Block tails are rebuilt too, so appending still works
+    ASSERT_THAT(copy->block.tail, Eq(copy->block.next->block.next));
+}
+
+TEST_F(NAME, children_come_before_parents)
+{
+    ast::FlatAST flat;
+    flat.build(newProgram());
+
+    ASSERT_THAT(flat.type(flat.root()), Eq(ast::NT_BLOCK));
+    for (ast::FlatAST::Index i = 0; i != flat.nodeCount(); ++i)
+    {
+        if (flat.left(i) != ast::FlatAST::none)
+            ASSERT_THAT(flat.left(i), Lt(i));
+        if (flat.right(i) != ast::FlatAST::none)
+            ASSERT_THAT(flat.right(i), Lt(i));
+    }
+}
+
+TEST_F(NAME, literal_and_name_accessors)
+{
+    ast::FlatAST flat;
+    flat.build(newProgram());
+
+    std::vector<std::string> names;
+    std::vector<std::string> values;
+    for (ast::FlatAST::Index i = 0; i != flat.nodeCount(); ++i)
+    {
+        if (flat.type(i) == ast::NT_SYMBOL)
+            names.push_back(flat.name(i));
+        if (flat.type(i) != ast::NT_LITERAL)
+            continue;
+        switch (flat.node(i).subtype)
+        {
+            case ast::LT_BOOLEAN: values.push_back(flat.booleanValue(i) ? "true" : "false"); break;
+            case ast::LT_INTEGER: values.push_back(std::to_string(flat.integerValue(i))); break;
+            case ast::LT_FLOAT: values.push_back(std::to_string(flat.floatValue(i))); break;
+            case ast::LT_STRING: values.push_back(flat.stringValue(i)); break;
+        }
+    }
+
+    ASSERT_THAT(names, UnorderedElementsAre("a", "b", "a"));
+    ASSERT_THAT(values, UnorderedElementsAre("1", std::to_string(2.5), "hello", "true"));
+
+    // "a" is stored once even though two symbols use it
+    for (ast::FlatAST::Index i = 0, first = ast::FlatAST::none; i != flat.nodeCount(); ++i)
+        if (flat.type(i) == ast::NT_SYMBOL && std::string(flat.name(i)) == "a")
+        {
+            if (first == ast::FlatAST::none)
+                first = i;
+            else
+                ASSERT_THAT(flat.name(i), Eq(flat.name(first)));
+        }
+}
+
+TEST_F(NAME, command_keyword_ids_round_trip)
+{
+    ast::node_t* block = ast::newBlock(&arena, ast::newKeywordCommand(&arena, &strings, 4711, "SYNC ON", 7, nullptr), nullptr);
+    ast::appendStatementToBlock(&arena, block, ast::newKeywordCommand(&arena, &strings, ast::NO_KEYWORD_ID, "PRINT", 5,
+        ast::newIntegerLiteral(&arena, 1)));
+
+    ast::FlatAST flat;
+    flat.build(block);
+    ast::node_t* copy = flat.toTree(&arena, &strings);
+    ASSERT_THAT(copy, NotNull());
+    ASSERT_THAT(copy->block.statement->command.name, StrEq("SYNC ON"));
+    ASSERT_THAT(copy->block.statement->command.keywordID, Eq(4711u));
+    ASSERT_THAT(copy->block.next->block.statement->command.name, StrEq("PRINT"));
+    ASSERT_THAT(copy->block.next->block.statement->command.keywordID, Eq(ast::NO_KEYWORD_ID));
+}
+
+TEST_F(NAME, uses_less_than_half_the_memory)
+{
+    ast::node_t* block = newProgram();
+    for (int i = 0; i != 10000; ++i)
+        ast::appendStatementToBlock(&arena, block, ast::newAssignment(&arena, newVariable("a"),
+            ast::newOp(&arena, ast::newIntegerLiteral(&arena, i), newVariable("b"), ast::OP_MUL)));
+
+    int nodeCount = 0;
+    ast::Traversal().preOrder(block, [&nodeCount](ast::node_t*) { nodeCount++; return true; });
+
+    ast::FlatAST flat;
+    flat.build(block);
+    ASSERT_THAT(flat.nodeCount(), Eq(std::size_t(nodeCount)));
+    ASSERT_THAT(flat.memoryUsage(), Lt(nodeCount * sizeof(ast::node_t) / 2));
+}
+
+TEST_F(NAME, empty_tree)
+{
+    ast::FlatAST flat;
+    flat.build(nullptr);
+    ASSERT_THAT(flat.empty(), IsTrue());
+    ASSERT_THAT(flat.root(), Eq(ast::FlatAST::none));
+    ASSERT_THAT(flat.toTree(&arena, &strings), IsNull());
+}
+
+TEST_F(NAME, save_and_load_round_trip)
+{
+    std::string fileName = uniqueTempPath("odbc_flat_ast_test", ".odbast").string();
+    ast::node_t* original = newProgram();
+    ast::FlatAST flat;
+    flat.build(original);
+    ASSERT_THAT(flat.save(fileName, 1234), IsTrue());
+
+    ast::FlatAST loaded;
+    ASSERT_THAT(loaded.load(fileName, 4321), IsFalse());
+    ASSERT_THAT(loaded.load(fileName, 1234), IsTrue());
+    ASSERT_THAT(loaded.nodeCount(), Eq(flat.nodeCount()));
+    ASSERT_THAT(describe(loaded.toTree(&arena, &strings)), Eq(describe(original)));
+
+    std::filesystem::remove(fileName);
+}
+
+TEST_F(NAME, spans_round_trip)
+{
+    // One span is too long for the 16-bit lengths and goes to the side table
+    ast::node_t* original = newProgram();
+    ast::setSpan(original->block.statement, {0, 12});
+    ast::setSpan(original->block.statement->assignment.symbol, {0, 1});
+    ast::setSpan(original->block.next->block.statement, {100, 200000});
+    ast::setSpan(original->block.next->block.next->block.statement, {300000, 8});
+
+    ast::FlatAST flat;
+    flat.build(original);
+    ASSERT_THAT(flat.span(flat.root()).length, Eq(0u));
+    ASSERT_THAT(describe(flat.toTree(&arena, &strings)), Eq(describe(original)));
+
+    std::string fileName = uniqueTempPath("odbc_flat_ast_spans_test", ".odbast").string();
+    ASSERT_THAT(flat.save(fileName, 1234), IsTrue());
+    ast::FlatAST loaded;
+    ASSERT_THAT(loaded.load(fileName, 1234), IsTrue());
+    ASSERT_THAT(describe(loaded.toTree(&arena, &strings)), Eq(describe(original)));
+
+    std::filesystem::remove(fileName);
+}
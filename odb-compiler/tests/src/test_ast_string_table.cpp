@@ -0,0 +1,87 @@
+#include <gmock/gmock.h>
+#include "odbc/ast/Arena.hpp"
+#include "odbc/ast/StringTable.hpp"
+#include "odbc/ast/Node.hpp"
+#include "odbc/parsers/db/Driver.hpp"
+#include <string>
+
+#define NAME ast_string_table
+
+using namespace testing;
+
+class NAME : public Test
+{
+public:
+};
+
+using namespace odbc;
+
+TEST_F(NAME, equal_strings_get_equal_ids)
+{
+    ast::Arena arena;
+    ast::StringTable strings(&arena);
+
+    ast::StringTable::ID a = strings.intern("foo");
+    ast::StringTable::ID b = strings.intern("bar");
+    ast::StringTable::ID c = strings.intern("foo bar", 3);
+
+    ASSERT_THAT(a, Ne(b));
+    ASSERT_THAT(a, Eq(c));
+    ASSERT_THAT(strings.get(a), StrEq("foo"));
+    ASSERT_THAT(strings.get(b), StrEq("bar"));
+    ASSERT_THAT(strings.length(a), Eq(3u));
+    ASSERT_THAT(strings.size(), Eq(2u));
+}
+
+TEST_F(NAME, stored_copy_is_shared)
+{
+    ast::Arena arena;
+    ast::StringTable strings(&arena);
+
+    std::string name = "player_x";
+    const char* first = strings.get(strings.intern(name.c_str()));
+    const char* second = strings.get(strings.intern(name.c_str()));
+    ASSERT_THAT(first, Eq(second));
+    ASSERT_THAT(first, Ne(name.c_str()));
+}
+
+TEST_F(NAME, ids_survive_growing_the_table)
+{
+    ast::Arena arena;
+    ast::StringTable strings(&arena);
+
+    for (int i = 0; i != 10000; ++i)
+        ASSERT_THAT(strings.intern(("sym" + std::to_string(i)).c_str()), Eq((ast::StringTable::ID)i));
+    for (int i = 0; i != 10000; ++i)
+    {
+        ASSERT_THAT(strings.intern(("sym" + std::to_string(i)).c_str()), Eq((ast::StringTable::ID)i));
+        ASSERT_THAT(strings.get(i), StrEq("sym" + std::to_string(i)));
+    }
+}
+
+TEST_F(NAME, clear_forgets_strings)
+{
+    ast::Arena arena;
+    ast::StringTable strings(&arena);
+
+    strings.intern("foo");
+    strings.intern("bar");
+    strings.clear();
+    arena.reset();
+    ASSERT_THAT(strings.size(), Eq(0u));
+    ASSERT_THAT(strings.intern("bar"), Eq(0u));
+}
+
+TEST_F(NAME, parsed_symbols_share_name_id)
+{
+    db::Driver driver;
+    ASSERT_THAT(driver.parseString("a=1\nb=2\na=3\n"), IsTrue());
+
+    ast::node_t* block = driver.getAST();
+    ast::node_t* a1 = block->block.statement->assignment.symbol;
+    ast::node_t* b = block->block.next->block.statement->assignment.symbol;
+    ast::node_t* a2 = block->block.next->block.next->block.statement->assignment.symbol;
+    ASSERT_THAT(a1->symbol.nameID, Eq(a2->symbol.nameID));
+    ASSERT_THAT(a1->symbol.name, Eq(a2->symbol.name));
+    ASSERT_THAT(a1->symbol.nameID, Ne(b->symbol.nameID));
+}
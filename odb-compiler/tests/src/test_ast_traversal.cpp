@@ -0,0 +1,147 @@
+#include <gmock/gmock.h>
+#include "odbc/ast/Arena.hpp"
+#include "odbc/ast/Node.hpp"
+#include "odbc/ast/Traversal.hpp"
+#include <sstream>
+#include <vector>
+
+#define NAME ast_traversal
+
+using namespace testing;
+using namespace odbc;
+
+class NAME : public Test
+{
+public:
+    // Builds the expression (1 + 2) * 3
+    ast::node_t* newExpression()
+    {
+        return ast::newOp(&arena,
+            ast::newOp(&arena, ast::newIntegerLiteral(&arena, 1), ast::newIntegerLiteral(&arena, 2), ast::OP_ADD),
+            ast::newIntegerLiteral(&arena, 3),
+            ast::OP_MUL);
+    }
+
+    // Builds a block list long enough to overflow the stack if walked
+    // recursively
+    ast::node_t* newLongBlock(int statementCount)
+    {
+        ast::node_t* block = ast::newBlock(&arena, ast::newIntegerLiteral(&arena, 0), nullptr);
+        for (int i = 1; i != statementCount; ++i)
+            ast::appendStatementToBlock(&arena, block, ast::newIntegerLiteral(&arena, i));
+        return block;
+    }
+
+    static std::vector<int> literals(const std::vector<ast::node_t*>& nodes)
+    {
+        std::vector<int> values;
+        for (ast::node_t* node : nodes)
+            values.push_back(node->info.type == ast::NT_LITERAL ? node->literal.value.i : -1);
+        return values;
+    }
+
+    ast::Arena arena;
+};
+
+TEST_F(NAME, pre_order_visits_parent_first)
+{
+    std::vector<ast::node_t*> visited;
+    ast::Traversal().preOrder(newExpression(), [&visited](ast::node_t* node) {
+        visited.push_back(node);
+        return true;
+    });
+
+    ASSERT_THAT(literals(visited), ElementsAre(-1, -1, 1, 2, 3));
+    ASSERT_THAT(visited[0]->op.operation, Eq(ast::OP_MUL));
+    ASSERT_THAT(visited[1]->op.operation, Eq(ast::OP_ADD));
+}
+
+TEST_F(NAME, pre_order_visits_statements_in_source_order)
+{
+    // 0, loop { 1, 2 }, 3
+    ast::node_t* body = ast::newBlock(&arena, ast::newIntegerLiteral(&arena, 1), nullptr);
+    ast::appendStatementToBlock(&arena, body, ast::newIntegerLiteral(&arena, 2));
+    ast::node_t* block = ast::newBlock(&arena, ast::newIntegerLiteral(&arena, 0), nullptr);
+    ast::appendStatementToBlock(&arena, block, ast::newLoop(&arena, body));
+    ast::appendStatementToBlock(&arena, block, ast::newIntegerLiteral(&arena, 3));
+
+    std::vector<ast::node_t*> visited;
+    ast::Traversal().preOrder(block, [&visited](ast::node_t* node) {
+        if (node->info.type != ast::NT_BLOCK)
+            visited.push_back(node);
+        return true;
+    });
+
+    ASSERT_THAT(literals(visited), ElementsAre(0, -1, 1, 2, 3));
+    ASSERT_THAT(visited[1]->info.type, Eq(ast::NT_LOOP));
+}
+
+TEST_F(NAME, post_order_visits_children_first)
+{
+    std::vector<ast::node_t*> visited;
+    ast::Traversal().postOrder(newExpression(), [&visited](ast::node_t* node) {
+        visited.push_back(node);
+        return true;
+    });
+
+    ASSERT_THAT(literals(visited), ElementsAre(1, 2, -1, 3, -1));
+    ASSERT_THAT(visited[2]->op.operation, Eq(ast::OP_ADD));
+    ASSERT_THAT(visited[4]->op.operation, Eq(ast::OP_MUL));
+}
+
+TEST_F(NAME, returning_false_stops_the_walk)
+{
+    int count = 0;
+    auto stopAtSecond = [&count](ast::node_t*) { return ++count < 2; };
+
+    ASSERT_THAT(ast::Traversal().preOrder(newExpression(), stopAtSecond), IsFalse());
+    ASSERT_THAT(count, Eq(2));
+    count = 0;
+    ASSERT_THAT(ast::Traversal().postOrder(newExpression(), stopAtSecond), IsFalse());
+    ASSERT_THAT(count, Eq(2));
+}
+
+TEST_F(NAME, empty_tree)
+{
+    int count = 0;
+    auto visit = [&count](ast::node_t*) { count++; return true; };
+
+    ASSERT_THAT(ast::Traversal().preOrder(nullptr, visit), IsTrue());
+    ASSERT_THAT(ast::Traversal().postOrder(nullptr, visit), IsTrue());
+    ASSERT_THAT(count, Eq(0));
+}
+
+TEST_F(NAME, long_block_is_walked_without_recursion)
+{
+    const int statementCount = 1000000;
+    ast::node_t* block = newLongBlock(statementCount);
+
+    int count = 0;
+    auto visit = [&count](ast::node_t*) { count++; return true; };
+    ASSERT_THAT(ast::Traversal().preOrder(block, visit), IsTrue());
+    ASSERT_THAT(count, Eq(statementCount * 2));
+    count = 0;
+    ASSERT_THAT(ast::Traversal().postOrder(block, visit), IsTrue());
+    ASSERT_THAT(count, Eq(statementCount * 2));
+}
+
+TEST_F(NAME, long_block_is_freed_without_recursion)
+{
+    ast::node_t* block = newLongBlock(1000000);
+    std::size_t used = arena.bytesUsed();
+    ast::freeNodeRecursive(&arena, block);
+
+    // All nodes went back to the free list, so building the block again
+    // must not need any new memory
+    newLongBlock(1000000);
+    ASSERT_THAT(arena.bytesUsed(), Eq(used));
+}
+
+#ifdef ODBC_DOT_EXPORT
+TEST_F(NAME, long_block_is_exported_without_recursion)
+{
+    std::ostringstream ss;
+    ast::dumpToDOT(ss, newLongBlock(1000000));
+    ASSERT_THAT(ss.str().size(), Gt(0u));
+}
+#endif
@@ -0,0 +1,111 @@
+#include <gmock/gmock.h>
+#include "odbc/parsers/keywords/CommandTrie.hpp"
+#include "odbc/parsers/keywords/KeywordsDB.hpp"
+#include <cstring>
+
+#define NAME command_trie
+
+using namespace testing;
+
+class NAME : public Test
+{
+public:
+    void SetUp() override
+    {
+        trie = odbc::CommandTrie::fromNames({
+            "MAKE OBJECT",
+            "MAKE OBJECT SPHERE",
+            "MAKE OBJECT CUBE",
+            "LOAD 3DSOUND",
+            "LOAD",
+            "STR$",
+            "PRINT"
+        });
+        ASSERT_THAT(trie, NotNull());
+    }
+
+    odbc::CommandTrie::Match match(const char* text)
+    {
+        return trie->longestMatch(text);
+    }
+
+    std::unique_ptr<odbc::CommandTrie> trie;
+};
+
+using namespace odbc;
+
+TEST_F(NAME, longest_command_wins)
+{
+    CommandTrie::Match m = match("make object sphere 1, 10\n");
+    ASSERT_THAT(m.keyword, Eq(trie->find("MAKE OBJECT SPHERE")));
+    ASSERT_THAT(m.length, Eq(strlen("make object sphere")));
+
+    m = match("make object 1\n");
+    ASSERT_THAT(m.keyword, Eq(trie->find("MAKE OBJECT")));
+    ASSERT_THAT(m.length, Eq(strlen("make object")));
+}
+
+TEST_F(NAME, falls_back_to_shorter_command)
+{
+    CommandTrie::Match m = match("make object spheres\n");
+    ASSERT_THAT(trie->name(m.keyword), StrEq("MAKE OBJECT"));
+    ASSERT_THAT(m.length, Eq(strlen("make object")));
+
+    m = match("load \"file.wav\"");
+    ASSERT_THAT(trie->name(m.keyword), StrEq("LOAD"));
+    ASSERT_THAT(m.length, Eq(4u));
+}
+
+TEST_F(NAME, case_and_whitespace_are_ignored)
+{
+    CommandTrie::Match m = match("MaKe \t  oBjEcT   CUBE 1");
+    ASSERT_THAT(trie->name(m.keyword), StrEq("MAKE OBJECT CUBE"));
+    ASSERT_THAT(m.length, Eq(strlen("MaKe \t  oBjEcT   CUBE")));
+}
+
+TEST_F(NAME, match_doesnt_end_inside_a_word)
+{
+    ASSERT_THAT(match("loaded = 1").keyword, Eq(CommandTrie::notFound));
+    ASSERT_THAT(match("printer").keyword, Eq(CommandTrie::notFound));
+    ASSERT_THAT(match("make objects").keyword, Eq(CommandTrie::notFound));
+    ASSERT_THAT(match("print").length, Eq(5u));
+}
+
+TEST_F(NAME, names_may_end_in_symbols)
+{
+    CommandTrie::Match m = match("str$(5)");
+    ASSERT_THAT(trie->name(m.keyword), StrEq("STR$"));
+    ASSERT_THAT(m.length, Eq(4u));
+    ASSERT_THAT(match("str(5)").keyword, Eq(CommandTrie::notFound));
+}
+
+TEST_F(NAME, ids_are_sorted_and_dense)
+{
+    ASSERT_THAT(trie->size(), Eq(7u));
+    for (CommandTrie::KeywordID id = 0; id + 1 < trie->size(); ++id)
+        ASSERT_THAT(trie->name(id), Lt(trie->name(id + 1)));
+    for (CommandTrie::KeywordID id = 0; id != trie->size(); ++id)
+        ASSERT_THAT(trie->find(trie->name(id)), Eq(id));
+}
+
+TEST_F(NAME, same_names_give_same_hash)
+{
+    auto other = CommandTrie::fromNames({"PRINT", "STR$", "LOAD", "LOAD 3DSOUND",
+                                         "MAKE OBJECT CUBE", "MAKE OBJECT SPHERE", "MAKE OBJECT"});
+    ASSERT_THAT(other->hash(), Eq(trie->hash()));
+    auto different = CommandTrie::fromNames({"PRINT"});
+    ASSERT_THAT(different->hash(), Ne(trie->hash()));
+}
+
+TEST_F(NAME, created_from_keyword_db)
+{
+    KeywordDB db;
+    Keyword keyword;
+    keyword.name = "SYNC ON";
+    db.addKeyword(std::move(keyword));
+
+    auto fromDB = db.createCommandTrie();
+    ASSERT_THAT(fromDB, NotNull());
+    ASSERT_THAT(fromDB->size(), Eq(1u));
+    ASSERT_THAT(fromDB->longestMatch("sync on\n").length, Eq(7u));
+}
@@ -0,0 +1,116 @@
+#include <gmock/gmock.h>
+#include "odbc/ast/Arena.hpp"
+#include "odbc/ast/Node.hpp"
+#include "odbc/ast/StringTable.hpp"
+#include "odbc/parsers/CompletionIndex.hpp"
+#include "odbc/parsers/keywords/KeywordsDB.hpp"
+#include <string>
+#include <vector>
+
+#define NAME completion_index
+
+using namespace testing;
+using namespace odbc;
+
+class NAME : public Test
+{
+public:
+    NAME() : strings(&arena) {}
+
+    void addKeyword(const std::string& name)
+    {
+        Keyword keyword;
+        keyword.name = name;
+        db.addKeyword(std::move(keyword));
+    }
+
+    ast::node_t* newSymbol(const char* name, ast::SymbolType type)
+    {
+        return ast::newSymbol(&arena, &strings, strings.intern(name), nullptr, nullptr,
+                              type, ast::SDT_INTEGER, ast::SS_LOCAL, ast::SD_REF);
+    }
+
+    std::vector<std::string> names(const std::vector<CompletionIndex::Match>& matches)
+    {
+        std::vector<std::string> result;
+        for (const auto& match : matches)
+            result.emplace_back(match.name);
+        return result;
+    }
+
+    ast::Arena arena;
+    ast::StringTable strings;
+    KeywordDB db;
+    CompletionIndex index;
+};
+
+TEST_F(NAME, completes_keywords)
+{
+    addKeyword("MAKE OBJECT CUBE");
+    addKeyword("MAKE OBJECT");
+    addKeyword("MAKE OBJECT SPHERE");
+    addKeyword("MAKE MATRIX");
+    addKeyword("SYNC");
+    index.addKeywords(db);
+
+    ASSERT_THAT(index.size(), Eq(5u));
+    ASSERT_THAT(names(index.complete("make obj", 10)),
+                ElementsAre("MAKE OBJECT", "MAKE OBJECT CUBE", "MAKE OBJECT SPHERE"));
+    ASSERT_THAT(names(index.complete("Make\t  Obj", 10)),
+                ElementsAre("MAKE OBJECT", "MAKE OBJECT CUBE", "MAKE OBJECT SPHERE"));
+    ASSERT_THAT(names(index.complete("make object ", 10)),
+                ElementsAre("MAKE OBJECT CUBE", "MAKE OBJECT SPHERE"));
+    ASSERT_THAT(names(index.complete("make", 10)),
+                ElementsAre("MAKE MATRIX", "MAKE OBJECT", "MAKE OBJECT CUBE", "MAKE OBJECT SPHERE"));
+    ASSERT_THAT(index.complete("delete", 10), IsEmpty());
+    ASSERT_THAT(index.complete("make object cubes", 10), IsEmpty());
+}
+
+TEST_F(NAME, returns_shortest_matches_first)
+{
+    addKeyword("POSITION OBJECT");
+    addKeyword("POINT CAMERA");
+    addKeyword("POINT");
+    addKeyword("POSITION CAMERA");
+    addKeyword("PI");
+    index.addKeywords(db);
+
+    ASSERT_THAT(names(index.complete("p", 3)), ElementsAre("PI", "POINT", "POINT CAMERA"));
+    ASSERT_THAT(names(index.complete("", 2)), ElementsAre("PI", "POINT"));
+    ASSERT_THAT(index.complete("p", 0), IsEmpty());
+}
+
+TEST_F(NAME, completes_symbols)
+{
+    ast::node_t* block = ast::newBlock(&arena, newSymbol("playerX", ast::ST_VARIABLE), nullptr);
+    ast::appendStatementToBlock(&arena, block, newSymbol("playerY", ast::ST_VARIABLE));
+    ast::appendStatementToBlock(&arena, block, newSymbol("playerX", ast::ST_VARIABLE));
+    ast::appendStatementToBlock(&arena, block, newSymbol("PlayerDied", ast::ST_FUNC));
+    index.addSymbols(block);
+
+    auto matches = index.complete("PLAYER", 10);
+    ASSERT_THAT(names(matches), ElementsAre("playerX", "playerY", "PlayerDied"));
+    ASSERT_THAT(matches[0].type, Eq(ast::ST_VARIABLE));
+    ASSERT_THAT(matches[2].type, Eq(ast::ST_FUNC));
+}
+
+TEST_F(NAME, keywords_and_symbols_together)
+{
+    addKeyword("SCREEN WIDTH");
+    index.addKeywords(db);
+    index.addSymbols(newSymbol("screenScale", ast::ST_VARIABLE));
+
+    auto matches = index.complete("scre", 10);
+    ASSERT_THAT(names(matches), ElementsAre("screenScale", "SCREEN WIDTH"));
+    ASSERT_THAT(matches[1].type, Eq(ast::ST_COMMAND));
+}
+
+TEST_F(NAME, many_keywords)
+{
+    for (int i = 0; i != 10000; ++i)
+        addKeyword("COMMAND " + std::to_string(i));
+    index.addKeywords(db);
+
+    ASSERT_THAT(names(index.complete("command 12", 3)), ElementsAre("COMMAND 12", "COMMAND 120", "COMMAND 121"));
+    ASSERT_THAT(index.complete("command", 50).size(), Eq(50u));
+}
@@ -0,0 +1,128 @@
+#include <gmock/gmock.h>
+#include "odbc/parsers/db/Driver.hpp"
+#include "odbc/parsers/db/TokenBuffer.hpp"
+#include "odbc/ast/Node.hpp"
+#include <string>
+
+#define NAME db_chunked_lexing
+
+using namespace testing;
+
+class NAME : public Test
+{
+public:
+    static std::string manyLines(int count)
+    {
+        std::string source;
+        for (int i = 0; i != count; ++i)
+            source += "var" + std::to_string(i % 50) + "=" + std::to_string(i) + "\n";
+        return source;
+    }
+};
+
+using namespace odbc;
+
+TEST_F(NAME, split_starts_at_zero)
+{
+    std::string source = manyLines(100);
+    auto starts = db::splitSource(source.data(), source.size(), 1);
+    ASSERT_THAT(starts, ElementsAre(0));
+    starts = db::splitSource(source.data(), 0, 4);
+    ASSERT_THAT(starts, ElementsAre(0));
+}
+
+TEST_F(NAME, split_at_line_starts)
+{
+    std::string source = manyLines(1000);
+    auto starts = db::splitSource(source.data(), source.size(), 8);
+    ASSERT_THAT(starts.size(), Eq(8u));
+    ASSERT_THAT(starts[0], Eq(0u));
+    for (std::size_t i = 1; i != starts.size(); ++i)
+    {
+        EXPECT_THAT(starts[i], Gt(starts[i - 1]));
+        EXPECT_THAT(starts[i], Lt(source.size()));
+        EXPECT_THAT(source[starts[i] - 1], Eq('\n'));
+    }
+}
+
+TEST_F(NAME, remarks_and_quotes_dont_span_lines)
+{
+    // The scanner ends remarks and string literals at the end of the line,
+    // so none of these keep a split from the lines after them
+    std::string source;
+    for (int i = 0; i != 100; ++i)
+        source += i % 2 ? "REMSTART no remend on this line\n" : "a$=\"unterminated\n";
+
+    auto starts = db::splitSource(source.data(), source.size(), 4);
+    ASSERT_THAT(starts.size(), Eq(4u));
+    for (std::size_t i = 1; i != starts.size(); ++i)
+        EXPECT_THAT(source[starts[i] - 1], Eq('\n'));
+}
+
+TEST_F(NAME, remstart_in_string_literal_is_ignored)
+{
+    std::string source;
+    for (int i = 0; i != 100; ++i)
+        source += "a$ = \"remstart\"\n";
+
+    auto starts = db::splitSource(source.data(), source.size(), 4);
+    EXPECT_THAT(starts.size(), Eq(4u));
+}
+
+TEST_F(NAME, token_buffer_stores_fields_separately)
+{
+    db::TokenBuffer tokens;
+    DBSTYPE value;
+    value.integer_value = 42;
+    tokens.push(TOK_INTEGER_LITERAL, 10, 2, value);
+    value.symbol = 7;
+    tokens.push(TOK_SYMBOL, 13, 3, value);
+
+    ASSERT_THAT(tokens.size(), Eq(2u));
+    EXPECT_THAT(tokens.token(0), Eq(TOK_INTEGER_LITERAL));
+    EXPECT_THAT(tokens.offset(0), Eq(10u));
+    EXPECT_THAT(tokens.length(0), Eq(2u));
+    EXPECT_THAT(tokens.value(0).integer_value, Eq(42));
+    EXPECT_THAT(tokens.token(1), Eq(TOK_SYMBOL));
+    EXPECT_THAT(tokens.value(1).symbol, Eq(7u));
+
+    tokens.clear();
+    EXPECT_THAT(tokens.size(), Eq(0u));
+}
+
+TEST_F(NAME, chunked_parse_matches_lockstep_parse)
+{
+    std::string source = manyLines(20000);
+    source += "remstart not code remend\nname=\"hello\"\nremstart\n";
+    source += manyLines(20000);
+
+    db::Driver lockstep;
+    ASSERT_THAT(lockstep.parseString(source), IsTrue());
+
+    db::Driver chunked;
+    chunked.setLexerThreads(4, 1);
+    ASSERT_THAT(chunked.parseString(source), IsTrue());
+
+    ast::node_t* a = lockstep.getAST();
+    ast::node_t* b = chunked.getAST();
+    int statements = 0;
+    for (; a && b; a = a->block.next, b = b->block.next, statements++)
+    {
+        ASSERT_THAT(b->block.statement->info.type, Eq(a->block.statement->info.type));
+        if (a->block.statement->info.type == ast::NT_ASSIGNMENT)
+            ASSERT_THAT(b->block.statement->assignment.symbol->symbol.name,
+                        StrEq(a->block.statement->assignment.symbol->symbol.name));
+    }
+    EXPECT_THAT(a, IsNull());
+    EXPECT_THAT(b, IsNull());
+    EXPECT_THAT(statements, Gt(20000));
+}
+
+TEST_F(NAME, chunked_parse_reports_syntax_errors)
+{
+    std::string source = manyLines(20000) + "a==2\n" + manyLines(100);
+
+    db::Driver driver;
+    driver.setLexerThreads(4, 1);
+    EXPECT_THAT(driver.parseString(source), IsFalse());
+}
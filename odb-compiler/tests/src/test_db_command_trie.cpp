@@ -0,0 +1,82 @@
+#include <gmock/gmock.h>
+#include "odbc/parsers/db/Driver.hpp"
+#include "odbc/parsers/keywords/CommandTrie.hpp"
+#include "odbc/ast/Node.hpp"
+
+#define NAME db_command_trie
+
+using namespace testing;
+
+class NAME : public Test
+{
+public:
+    void SetUp() override
+    {
+        commands = odbc::CommandTrie::fromNames({
+            "MAKE OBJECT",
+            "MAKE OBJECT SPHERE",
+            "SYNC ON",
+            "SYNC",
+            "TIMER",
+            "LOOP SOUND"
+        });
+        driver = new odbc::db::Driver;
+        driver->setCommandTrie(commands.get());
+    }
+    void TearDown() override { delete driver; }
+
+    std::unique_ptr<odbc::CommandTrie> commands;
+    odbc::db::Driver* driver;
+};
+
+using namespace odbc;
+
+TEST_F(NAME, multi_word_command_is_one_token)
+{
+    ASSERT_THAT(driver->parseString("sync on\n"), IsTrue());
+    ast::node_t* stmnt = driver->getAST()->block.statement;
+    ASSERT_THAT(stmnt->info.type, Eq(ast::NT_COMMAND));
+    ASSERT_THAT(stmnt->command.keywordID, Eq(commands->find("SYNC ON")));
+    ASSERT_THAT(stmnt->command.name, StrEq("SYNC ON"));
+    ASSERT_THAT(stmnt->command.args, IsNull());
+}
+
+TEST_F(NAME, longest_command_is_matched)
+{
+    ASSERT_THAT(driver->parseString("MAKE  OBJECT SPHERE(1,10)\n"), IsTrue());
+    ast::node_t* stmnt = driver->getAST()->block.statement;
+    ASSERT_THAT(stmnt->info.type, Eq(ast::NT_COMMAND));
+    ASSERT_THAT(stmnt->command.keywordID, Eq(commands->find("MAKE OBJECT SPHERE")));
+    ASSERT_THAT(stmnt->command.args, NotNull());
+}
+
+TEST_F(NAME, command_in_expression)
+{
+    ASSERT_THAT(driver->parseString("a=timer()\n"), IsTrue());
+    ast::node_t* value = driver->getAST()->block.statement->assignment.statement;
+    ASSERT_THAT(value->info.type, Eq(ast::NT_COMMAND));
+    ASSERT_THAT(value->command.keywordID, Eq(commands->find("TIMER")));
+}
+
+TEST_F(NAME, command_starting_with_reserved_word)
+{
+    ASSERT_THAT(driver->parseString("loop sound(1)\n"), IsTrue());
+    ast::node_t* stmnt = driver->getAST()->block.statement;
+    ASSERT_THAT(stmnt->info.type, Eq(ast::NT_COMMAND));
+    ASSERT_THAT(stmnt->command.keywordID, Eq(commands->find("LOOP SOUND")));
+}
+
+TEST_F(NAME, symbols_that_only_start_like_commands)
+{
+    ASSERT_THAT(driver->parseString("syncrate=60\n"), IsTrue());
+    ast::node_t* stmnt = driver->getAST()->block.statement;
+    ASSERT_THAT(stmnt->info.type, Eq(ast::NT_ASSIGNMENT));
+    ASSERT_THAT(stmnt->assignment.symbol->symbol.name, StrEq("syncrate"));
+}
+
+TEST_F(NAME, no_commands_without_trie)
+{
+    driver->setCommandTrie(nullptr);
+    ASSERT_THAT(driver->parseString("timer()\n"), IsTrue());
+    ASSERT_THAT(driver->getAST()->block.statement->info.type, Eq(ast::NT_SYMBOL));
+}
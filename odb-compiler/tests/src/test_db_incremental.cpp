@@ -0,0 +1,173 @@
+#include <gmock/gmock.h>
+#include "odbc/parsers/db/IncrementalParser.hpp"
+#include "odbc/ast/Node.hpp"
+#include <string>
+
+#define NAME db_incremental
+
+using namespace testing;
+
+class NAME : public Test
+{
+public:
+    static std::string manyLines(int count)
+    {
+        std::string source;
+        for (int i = 0; i != count; ++i)
+            source += "var" + std::to_string(i % 50) + "=" + std::to_string(i) + "\n";
+        return source;
+    }
+
+    // The incremental result must be what parsing the edited source from
+    // scratch gives
+    static void expectSameAsFullParse(const odbc::db::IncrementalParser& parser)
+    {
+        odbc::db::IncrementalParser full;
+        ASSERT_THAT(full.parse(parser.text()), IsTrue());
+        ASSERT_THAT(parser.hasErrors(), IsFalse());
+        ASSERT_THAT(parser.statementCount(), Eq(full.statementCount()));
+        for (std::size_t i = 0; i != full.statementCount(); ++i)
+        {
+            EXPECT_THAT(parser.statement(i).offset, Eq(full.statement(i).offset));
+            EXPECT_THAT(parser.statement(i).length, Eq(full.statement(i).length));
+            EXPECT_THAT(parser.statement(i).block->block.statement->info.type,
+                        Eq(full.statement(i).block->block.statement->info.type));
+        }
+
+        std::size_t blocks = 0;
+        for (odbc::ast::node_t* block = parser.getAST(); block; block = block->block.next)
+            blocks++;
+        EXPECT_THAT(blocks, Eq(full.statementCount()));
+    }
+};
+
+using namespace odbc;
+
+TEST_F(NAME, edit_reparses_one_line)
+{
+    db::IncrementalParser parser;
+    ASSERT_THAT(parser.parse(manyLines(100)), IsTrue());
+
+    // "var10=10\n" becomes "var10=1234\n"
+    uint32_t offset = parser.statement(10).offset + 6;
+    ASSERT_THAT(parser.edit(offset, 2, "1234", 4), IsTrue());
+    EXPECT_THAT(parser.lastReparsed().offset, Eq(parser.statement(10).offset));
+    EXPECT_THAT(parser.lastReparsed().length, Eq(11u));
+
+    ast::node_t* stmnt = parser.statement(10).block->block.statement;
+    ASSERT_THAT(stmnt->info.type, Eq(ast::NT_ASSIGNMENT));
+    EXPECT_THAT(stmnt->assignment.statement->literal.value.i, Eq(1234));
+    expectSameAsFullParse(parser);
+}
+
+TEST_F(NAME, later_statements_move)
+{
+    db::IncrementalParser parser;
+    ASSERT_THAT(parser.parse(manyLines(100)), IsTrue());
+
+    ASSERT_THAT(parser.edit(0, 0, "first=1\n", 8), IsTrue());
+    ASSERT_THAT(parser.statementCount(), Eq(101u));
+    expectSameAsFullParse(parser);
+
+    // Nodes inside a moved statement still have their old spans
+    ast::node_t* stmnt = parser.statement(50).block->block.statement;
+    ast::SourceSpan span = parser.spanOf(stmnt->assignment.statement, 50);
+    EXPECT_THAT(parser.text().substr(span.offset, span.length), StrEq("49"));
+}
+
+TEST_F(NAME, edits_join_and_split_lines)
+{
+    db::IncrementalParser parser;
+    ASSERT_THAT(parser.parse(manyLines(20)), IsTrue());
+
+    // Replacing a newline with a colon puts two statements on one line
+    uint32_t newline = parser.statement(5).offset + parser.statement(5).length;
+    ASSERT_THAT(parser.edit(newline, 1, ":", 1), IsTrue());
+    expectSameAsFullParse(parser);
+
+    ASSERT_THAT(parser.edit(newline, 1, "\n", 1), IsTrue());
+    expectSameAsFullParse(parser);
+
+    ASSERT_THAT(parser.edit(parser.statement(3).offset, parser.statement(3).length + 1, "", 0), IsTrue());
+    ASSERT_THAT(parser.statementCount(), Eq(19u));
+    expectSameAsFullParse(parser);
+}
+
+TEST_F(NAME, edit_inside_loop_reparses_loop)
+{
+    db::IncrementalParser parser;
+    ASSERT_THAT(parser.parse("var0=0\ndo\nfoo()\nloop\nvar1=1\n"), IsTrue());
+    ASSERT_THAT(parser.statementCount(), Eq(3u));
+
+    ASSERT_THAT(parser.edit(10, 3, "bar", 3), IsTrue());
+    EXPECT_THAT(parser.lastReparsed().offset, Eq(7u));
+    EXPECT_THAT(parser.lastReparsed().length, Eq(14u));
+    ast::node_t* loop = parser.statement(1).block->block.statement;
+    ASSERT_THAT(loop->info.type, Eq(ast::NT_LOOP));
+    EXPECT_THAT(loop->loop.body->block.statement->symbol.name, StrEq("bar"));
+    expectSameAsFullParse(parser);
+}
+
+TEST_F(NAME, failed_text_is_parsed_again_by_later_edits)
+{
+    db::IncrementalParser parser;
+    ASSERT_THAT(parser.parse("var0=0\n"), IsTrue());
+
+    std::string typed = "do\nfoo()\n";
+    EXPECT_THAT(parser.edit(7, 0, typed.data(), (uint32_t)typed.size()), IsFalse());
+    EXPECT_THAT(parser.hasErrors(), IsTrue());
+    EXPECT_THAT(parser.statement(0).block, NotNull());
+
+    ASSERT_THAT(parser.edit((uint32_t)parser.size(), 0, "loop\n", 5), IsTrue());
+    EXPECT_THAT(parser.hasErrors(), IsFalse());
+    EXPECT_THAT(parser.errors(), IsEmpty());
+    ASSERT_THAT(parser.statementCount(), Eq(2u));
+    EXPECT_THAT(parser.statement(1).block->block.statement->info.type, Eq(ast::NT_LOOP));
+    expectSameAsFullParse(parser);
+}
+
+TEST_F(NAME, errors_are_in_source_offsets_and_not_printed)
+{
+    db::IncrementalParser parser;
+    ASSERT_THAT(parser.parse("var0=0\nvar1=1\nvar2=2\n"), IsTrue());
+
+    // "var1=1\n" becomes "var1=)\n", which is parsed on its own
+    testing::internal::CaptureStdout();
+    EXPECT_THAT(parser.edit(12, 1, ")", 1), IsFalse());
+    EXPECT_THAT(testing::internal::GetCapturedStdout(), StrEq(""));
+    ASSERT_THAT(parser.errors().size(), Eq(1u));
+    EXPECT_THAT(parser.errors()[0].span.offset, Eq(12u));
+    EXPECT_THAT(parser.errors()[0].message, Not(IsEmpty()));
+}
+
+TEST_F(NAME, edit_out_of_range_fails)
+{
+    db::IncrementalParser parser;
+    ASSERT_THAT(parser.parse("var0=0\n"), IsTrue());
+    EXPECT_THAT(parser.edit(8, 0, "a", 1), IsFalse());
+    EXPECT_THAT(parser.edit(5, 3, "", 0), IsFalse());
+    EXPECT_THAT(parser.text(), StrEq("var0=0\n"));
+}
+
+TEST_F(NAME, reparsed_region_does_not_grow_with_source)
+{
+    for (int lines : {100, 10000})
+    {
+        db::IncrementalParser parser;
+        ASSERT_THAT(parser.parse(manyLines(lines)), IsTrue());
+        std::size_t i = parser.statementCount() / 2;
+        ASSERT_THAT(parser.edit(parser.statement(i).offset, 1, "x", 1), IsTrue());
+        EXPECT_THAT(parser.lastReparsed().length, Le(16u));
+    }
+}
+
+TEST_F(NAME, statement_at_offset)
+{
+    db::IncrementalParser parser;
+    ASSERT_THAT(parser.parse("var0=0\n\nvar1=1\n"), IsTrue());
+    EXPECT_THAT(parser.statementAt(0), Eq(0u));
+    EXPECT_THAT(parser.statementAt(5), Eq(0u));
+    EXPECT_THAT(parser.statementAt(7), Eq(2u));
+    EXPECT_THAT(parser.statementAt(8), Eq(1u));
+    EXPECT_THAT(parser.statementAt(15), Eq(2u));
+}
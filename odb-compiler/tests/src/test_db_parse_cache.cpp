@@ -0,0 +1,132 @@
+#include <gmock/gmock.h>
+#include "odbc/parsers/db/Driver.hpp"
+#include "odbc/ast/Arena.hpp"
+#include "odbc/ast/FlatAST.hpp"
+#include "odbc/ast/Node.hpp"
+#include "odbc/ast/StringTable.hpp"
+#include "odbc/tests/TempPath.hpp"
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+#define NAME db_parse_cache
+
+using namespace testing;
+
+class NAME : public Test
+{
+public:
+    void SetUp() override
+    {
+        cacheDir = uniqueTempPath("odbc_parse_cache_test");
+        std::filesystem::remove_all(cacheDir);
+        std::filesystem::create_directories(cacheDir);
+    }
+
+    void TearDown() override
+    {
+        std::filesystem::remove_all(cacheDir);
+    }
+
+    int cacheEntryCount() const
+    {
+        int count = 0;
+        for (const auto& entry : std::filesystem::directory_iterator(cacheDir))
+            if (entry.path().extension() == ".odbast")
+                count++;
+        return count;
+    }
+
+    std::filesystem::path cacheDir;
+};
+
+using namespace odbc;
+
+TEST_F(NAME, cached_ast_matches_parsed_ast)
+{
+    db::Driver first;
+    first.setCacheDirectory(cacheDir.string());
+    ASSERT_THAT(first.parseString("a=1\nb=\"hello\"\n"), IsTrue());
+    ASSERT_THAT(cacheEntryCount(), Eq(1));
+
+    db::Driver second;
+    second.setCacheDirectory(cacheDir.string());
+    ASSERT_THAT(second.parseString("a=1\nb=\"hello\"\n"), IsTrue());
+
+    ast::node_t* block = second.getAST();
+    ASSERT_THAT(block, NotNull());
+    ASSERT_THAT(block->block.statement->assignment.symbol->symbol.name, StrEq("a"));
+    ASSERT_THAT(block->block.statement->assignment.statement->literal.value.i, Eq(1));
+    ASSERT_THAT(block->block.next->block.statement->assignment.symbol->symbol.name, StrEq("b"));
+    ASSERT_THAT(block->block.next->block.statement->assignment.statement->literal.value.s, StrEq("hello"));
+    ASSERT_THAT(block->block.next->block.next, IsNull());
+}
+
+TEST_F(NAME, parser_is_skipped_when_entry_exists)
+{
+    const std::string source = "a=1\n";
+
+    // Plant an entry for this source with a different AST. If the driver
+    // returns it, the parser didn't run.
+    ast::Arena arena;
+    ast::StringTable strings(&arena);
+    ast::node_t* planted = ast::newBlock(&arena, ast::newAssignment(&arena,
+        ast::newSymbol(&arena, &strings, strings.intern("planted"), nullptr, nullptr,
+                       ast::ST_VARIABLE, ast::SDT_INTEGER, ast::SS_LOCAL, ast::SD_REF),
+        ast::newIntegerLiteral(&arena, 42)), nullptr);
+    ast::FlatAST flat;
+    flat.build(planted);
+
+    db::Driver driver;
+    driver.setCacheDirectory(cacheDir.string());
+    ASSERT_THAT(driver.parseString(source), IsTrue());
+    ASSERT_THAT(cacheEntryCount(), Eq(1));
+    std::filesystem::path entry = std::filesystem::directory_iterator(cacheDir)->path();
+    uint64_t hash = ast::FlatAST::hashSource(source.data(), source.size());
+    ASSERT_THAT(flat.save(entry.string(), hash), IsTrue());
+
+    driver.freeAST();
+    ASSERT_THAT(driver.parseString(source), IsTrue());
+    ASSERT_THAT(driver.getAST()->block.statement->assignment.symbol->symbol.name, StrEq("planted"));
+}
+
+TEST_F(NAME, different_source_is_not_served_from_cache)
+{
+    db::Driver driver;
+    driver.setCacheDirectory(cacheDir.string());
+    ASSERT_THAT(driver.parseString("a=1\n"), IsTrue());
+    driver.freeAST();
+    ASSERT_THAT(driver.parseString("b=1\n"), IsTrue());
+    ASSERT_THAT(driver.getAST()->block.statement->assignment.symbol->symbol.name, StrEq("b"));
+    ASSERT_THAT(cacheEntryCount(), Eq(2));
+}
+
+TEST_F(NAME, damaged_entry_falls_back_to_parsing)
+{
+    db::Driver driver;
+    driver.setCacheDirectory(cacheDir.string());
+    ASSERT_THAT(driver.parseString("a=1\n"), IsTrue());
+
+    // Cut the entry short
+    std::filesystem::path entry = std::filesystem::directory_iterator(cacheDir)->path();
+    std::filesystem::resize_file(entry, std::filesystem::file_size(entry) - 1);
+
+    driver.freeAST();
+    ASSERT_THAT(driver.parseString("a=1\n"), IsTrue());
+    ASSERT_THAT(driver.getAST()->block.statement->assignment.symbol->symbol.name, StrEq("a"));
+}
+
+TEST_F(NAME, second_source_is_cached_on_its_own)
+{
+    db::Driver driver;
+    driver.setCacheDirectory(cacheDir.string());
+    ASSERT_THAT(driver.parseString("a=1\n"), IsTrue());
+    ASSERT_THAT(driver.parseString("b=2\n"), IsTrue());
+
+    // The entry for the second source must only contain "b"
+    db::Driver other;
+    other.setCacheDirectory(cacheDir.string());
+    ASSERT_THAT(other.parseString("b=2\n"), IsTrue());
+    ASSERT_THAT(other.getAST()->block.statement->assignment.symbol->symbol.name, StrEq("b"));
+    ASSERT_THAT(other.getAST()->block.next, IsNull());
+}
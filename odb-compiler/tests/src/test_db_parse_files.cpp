@@ -0,0 +1,86 @@
+#include <gmock/gmock.h>
+#include "odbc/parsers/db/Driver.hpp"
+#include "odbc/ast/Node.hpp"
+#include "odbc/tests/TempPath.hpp"
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#define NAME db_parse_files
+
+using namespace testing;
+
+class NAME : public Test
+{
+public:
+    void TearDown() override
+    {
+        for (const auto& fileName : fileNames)
+            std::filesystem::remove(fileName);
+    }
+
+    void writeFile(const std::string& contents)
+    {
+        std::string fileName = uniqueTempPath("odbc_parse_files_test", ".dba").string();
+        std::ofstream out(fileName, std::ios::binary);
+        out << contents;
+        fileNames.push_back(fileName);
+    }
+
+    std::vector<std::string> fileNames;
+};
+
+using namespace odbc;
+
+TEST_F(NAME, one_ast_per_file_in_order)
+{
+    // Each file assigns to a differently named variable so we can tell the
+    // ASTs apart
+    for (int i = 0; i != 32; ++i)
+    {
+        std::string source;
+        for (int j = 0; j != 100; ++j)
+            source += "var" + std::to_string(i) + "=" + std::to_string(j) + "\n";
+        writeFile(source);
+    }
+
+    auto drivers = db::Driver::parseFiles(fileNames, 4);
+    ASSERT_THAT(drivers.size(), Eq(fileNames.size()));
+    for (std::size_t i = 0; i != drivers.size(); ++i)
+    {
+        ASSERT_THAT(drivers[i], NotNull());
+        ast::node_t* block = drivers[i]->getAST();
+        ASSERT_THAT(block, NotNull());
+        ASSERT_THAT(block->block.statement->assignment.symbol->symbol.name,
+                    StrEq("var" + std::to_string(i)));
+    }
+}
+
+TEST_F(NAME, failed_files_are_null)
+{
+    writeFile("a=1\n");
+    fileNames.push_back("this/file/does/not/exist.dba");
+    writeFile("b=2\n");
+
+    auto drivers = db::Driver::parseFiles(fileNames, 2);
+    ASSERT_THAT(drivers.size(), Eq(3u));
+    ASSERT_THAT(drivers[0], NotNull());
+    ASSERT_THAT(drivers[1], IsNull());
+    ASSERT_THAT(drivers[2], NotNull());
+}
+
+TEST_F(NAME, more_threads_than_files)
+{
+    writeFile("a=1\n");
+
+    auto drivers = db::Driver::parseFiles(fileNames, 16);
+    ASSERT_THAT(drivers.size(), Eq(1u));
+    ASSERT_THAT(drivers[0], NotNull());
+}
+
+TEST_F(NAME, no_files)
+{
+    auto drivers = db::Driver::parseFiles(fileNames);
+    ASSERT_THAT(drivers.size(), Eq(0u));
+}
@@ -0,0 +1,52 @@
+#include <gmock/gmock.h>
+#include "odbc/parsers/db/Driver.hpp"
+#include "odbc/ast/Node.hpp"
+#include <string>
+
+#define NAME db_parse_scaling
+
+using namespace testing;
+
+class NAME : public Test
+{
+public:
+};
+
+using namespace odbc;
+
+TEST_F(NAME, tail_is_maintained_for_long_programs)
+{
+    // Appends go through the tail of the first block. If it ever fell behind,
+    // appending would walk the list again and parsing would turn quadratic.
+    // The timings are in benchmarks/src/bench_db_parse_scaling.cpp.
+    std::string source;
+    for (int i = 0; i != 1000; ++i)
+        source += "a=" + std::to_string(i) + "\n";
+
+    db::Driver driver;
+    ASSERT_THAT(driver.parseString(source), IsTrue());
+
+    ast::node_t* block = driver.getAST();
+    ast::node_t* last = block;
+    int count = 1;
+    for (; last->block.next; last = last->block.next)
+        count++;
+    ASSERT_THAT(count, Eq(1000));
+    ASSERT_THAT(block->block.tail, Eq(last));
+    ASSERT_THAT(last->block.statement->assignment.statement->literal.value.i, Eq(999));
+}
+
+TEST_F(NAME, flat_program_keeps_statement_order)
+{
+    db::Driver driver;
+    ASSERT_THAT(driver.parseString("a=1\nb=2\nc=3\n"), IsTrue());
+
+    ast::node_t* block = driver.getAST();
+    ASSERT_THAT(block, NotNull());
+    ASSERT_THAT(block->info.type, Eq(ast::NT_BLOCK));
+    ASSERT_THAT(block->block.statement->assignment.symbol->symbol.name, StrEq("a"));
+    ASSERT_THAT(block->block.next->block.statement->assignment.symbol->symbol.name, StrEq("b"));
+    ASSERT_THAT(block->block.next->block.next->block.statement->assignment.symbol->symbol.name, StrEq("c"));
+    ASSERT_THAT(block->block.next->block.next->block.next, IsNull());
+    ASSERT_THAT(block->block.tail, Eq(block->block.next->block.next));
+}
@@ -0,0 +1,54 @@
+#include <gmock/gmock.h>
+#include "odbc/parsers/db/Parser.y.h"
+#include "odbc/parsers/db/ReservedWords.hpp"
+#include <cstring>
+#include <string>
+
+#define NAME db_reserved_words
+
+using namespace testing;
+using namespace odbc;
+
+class NAME : public Test
+{
+public:
+    const db::ReservedWord* find(const std::string& text)
+    {
+        return db::findReservedWord(text.data(), text.size());
+    }
+};
+
+TEST_F(NAME, finds_reserved_words)
+{
+    for (const char* name : {"then", "endif", "elseif", "if", "else", "endwhile", "while", "repeat",
+                             "until", "do", "loop", "for", "to", "step", "next", "endfunction",
+                             "exitfunction", "function", "gosub", "return", "dim", "global", "local",
+                             "as", "endtype", "type", "boolean", "integer", "float", "string",
+                             "inc", "dec", "or", "and", "not", "true", "false"})
+    {
+        ASSERT_THAT(find(name), NotNull()) << name;
+        ASSERT_THAT(find(name)->name, StrEq(name));
+    }
+
+    ASSERT_THAT(find("endfunction")->token, Eq(TOK_ENDFUNCTION));
+    ASSERT_THAT(find("exitfunction")->token, Eq(TOK_EXITFUNCTION));
+    ASSERT_THAT(find("true")->token, Eq(TOK_BOOLEAN_LITERAL));
+    ASSERT_THAT(find("true")->value, IsTrue());
+    ASSERT_THAT(find("false")->value, IsFalse());
+}
+
+TEST_F(NAME, case_matches_the_old_rules)
+{
+    ASSERT_THAT(find("AND"), NotNull());
+    ASSERT_THAT(find("Not"), NotNull());
+    ASSERT_THAT(find("TRUE"), NotNull());
+    ASSERT_THAT(find("IF"), IsNull());
+    ASSERT_THAT(find("While"), IsNull());
+}
+
+TEST_F(NAME, symbols_are_not_reserved)
+{
+    for (const char* name : {"i", "iff", "endif_", "endiff", "fo", "a", "an", "andy", "while2",
+                             "_if", "ENDIF1", "exitfunctions", "x", "playerX", "iF_"})
+        ASSERT_THAT(find(name), IsNull()) << name;
+}
@@ -0,0 +1,99 @@
+#include <gmock/gmock.h>
+#include "odbc/parsers/db/Driver.hpp"
+#include "odbc/ast/Node.hpp"
+#include "odbc/tests/ParserTestHarness.hpp"
+#include <string>
+
+#define NAME db_source_spans
+
+using namespace testing;
+
+class NAME : public ParserTestHarness
+{
+public:
+};
+
+using namespace odbc;
+
+TEST_F(NAME, expressions_cover_their_operands)
+{
+    ASSERT_THAT(driver->parseString("var0=0\na=1+2\n"), IsTrue());
+
+    ast::node_t* stmnt = driver->getAST()->block.next->block.statement;
+    ASSERT_THAT(stmnt->info.type, Eq(ast::NT_ASSIGNMENT));
+    EXPECT_THAT(ast::getSpan(stmnt).offset, Eq(7u));
+    EXPECT_THAT(ast::getSpan(stmnt).length, Eq(5u));
+
+    ast::node_t* op = stmnt->assignment.statement;
+    ASSERT_THAT(op->info.type, Eq(ast::NT_OP));
+    EXPECT_THAT(ast::getSpan(op).offset, Eq(9u));
+    EXPECT_THAT(ast::getSpan(op).length, Eq(3u));
+    EXPECT_THAT(ast::getSpan(op->op.right).offset, Eq(11u));
+    EXPECT_THAT(ast::getSpan(op->op.right).length, Eq(1u));
+    EXPECT_THAT(ast::getSpan(stmnt->assignment.symbol).offset, Eq(7u));
+    EXPECT_THAT(ast::getSpan(stmnt->assignment.symbol).length, Eq(1u));
+}
+
+TEST_F(NAME, statements_span_several_lines)
+{
+    ASSERT_THAT(driver->parseString("do\nfoo()\nloop\n"), IsTrue());
+
+    ast::node_t* loop = driver->getAST()->block.statement;
+    ASSERT_THAT(loop->info.type, Eq(ast::NT_LOOP));
+    EXPECT_THAT(ast::getSpan(loop).offset, Eq(0u));
+    EXPECT_THAT(ast::getSpan(loop).length, Eq(13u));
+
+    ast::node_t* call = loop->loop.body->block.statement;
+    ASSERT_THAT(call->info.type, Eq(ast::NT_SYMBOL));
+    EXPECT_THAT(ast::getSpan(call).offset, Eq(3u));
+    EXPECT_THAT(ast::getSpan(call).length, Eq(5u));
+}
+
+TEST_F(NAME, blocks_have_empty_spans)
+{
+    ASSERT_THAT(driver->parseString("var0=0\n"), IsTrue());
+    EXPECT_THAT(ast::getSpan(driver->getAST()).length, Eq(0u));
+}
+
+TEST_F(NAME, line_and_column_from_offset)
+{
+    ASSERT_THAT(driver->parseString("var0=0\n\nvar1=1+var0\n"), IsTrue());
+
+    ast::node_t* stmnt = driver->getAST()->block.next->block.statement;
+    ast::SourceSpan span = ast::getSpan(stmnt->assignment.statement);
+    const LineIndex& lines = driver->getLineIndex();
+    EXPECT_THAT(lines.lineOf(span.offset), Eq(3u));
+    EXPECT_THAT(lines.columnOf(span.offset), Eq(6u));
+}
+
+TEST_F(NAME, chunked_parse_has_same_spans)
+{
+    std::string source;
+    for (int i = 0; i != 5000; ++i)
+        source += "var" + std::to_string(i % 50) + "=" + std::to_string(i) + "+1\n";
+
+    ASSERT_THAT(driver->parseString(source), IsTrue());
+    db::Driver chunked;
+    chunked.setLexerThreads(4, 1);
+    ASSERT_THAT(chunked.parseString(source), IsTrue());
+
+    ast::node_t* a = driver->getAST();
+    ast::node_t* b = chunked.getAST();
+    for (; a && b; a = a->block.next, b = b->block.next)
+    {
+        ast::node_t* x = a->block.statement->assignment.statement;
+        ast::node_t* y = b->block.statement->assignment.statement;
+        ASSERT_THAT(ast::getSpan(y).offset, Eq(ast::getSpan(x).offset));
+        ASSERT_THAT(ast::getSpan(y).length, Eq(ast::getSpan(x).length));
+    }
+    EXPECT_THAT(a, IsNull());
+    EXPECT_THAT(b, IsNull());
+}
+
+TEST_F(NAME, long_spans_are_cut_short)
+{
+    ast::node_t node = {};
+    ast::setSpan(&node, {100, 0x2000000});
+    EXPECT_THAT(ast::getSpan(&node).offset, Eq(100u));
+    EXPECT_THAT(ast::getSpan(&node).length, Eq(0xFFFFFFu));
+}
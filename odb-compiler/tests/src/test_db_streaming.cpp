@@ -0,0 +1,79 @@
+#include <gmock/gmock.h>
+#include "odbc/parsers/db/Driver.hpp"
+#include "odbc/ast/Node.hpp"
+#include <string>
+#include <vector>
+
+#define NAME db_streaming
+
+using namespace testing;
+
+class NAME : public Test
+{
+public:
+    void SetUp() override { driver = new odbc::db::Driver; }
+    void TearDown() override { delete driver; }
+    odbc::db::Driver* driver;
+};
+
+using namespace odbc;
+
+TEST_F(NAME, callback_sees_every_toplevel_statement_in_order)
+{
+    std::vector<ast::NodeType> types;
+    driver->setStatementCallback([&types](ast::node_t* stmnt) {
+        types.push_back(stmnt->info.type);
+        return false;
+    });
+
+    ASSERT_THAT(driver->parseString("a=1\nb=2\nfoo()\n"), IsTrue());
+    ASSERT_THAT(driver->getAST(), IsNull());
+    ASSERT_THAT(types, ElementsAre(ast::NT_ASSIGNMENT, ast::NT_ASSIGNMENT, ast::NT_SYMBOL));
+}
+
+TEST_F(NAME, kept_statements_stay_valid)
+{
+    std::vector<ast::node_t*> kept;
+    driver->setStatementCallback([&kept](ast::node_t* stmnt) {
+        kept.push_back(stmnt);
+        return true;
+    });
+
+    ASSERT_THAT(driver->parseString("a=1\nb=2\n"), IsTrue());
+    ASSERT_THAT(kept.size(), Eq(2u));
+    ASSERT_THAT(kept[0]->assignment.symbol->symbol.name, StrEq("a"));
+    ASSERT_THAT(kept[1]->assignment.symbol->symbol.name, StrEq("b"));
+}
+
+TEST_F(NAME, memory_is_bounded_by_statement_size)
+{
+    int count = 0;
+    driver->setStatementCallback([&count](ast::node_t* stmnt) {
+        count++;
+        return false;
+    });
+
+    std::string source;
+    for (int i = 0; i != 100000; ++i)
+        source += "a=1\n";
+
+    ASSERT_THAT(driver->parseString(source), IsTrue());
+    ASSERT_THAT(count, Eq(100000));
+
+    // Freed statements go back to the arena's free list and are reused by
+    // the next one, so the arena never grows past a handful of nodes
+    ASSERT_THAT(driver->getArena()->peakBytesUsed(), Lt(4096u));
+}
+
+TEST_F(NAME, empty_callback_builds_ast_again)
+{
+    driver->setStatementCallback([](ast::node_t*) { return false; });
+    driver->setStatementCallback(nullptr);
+
+    ASSERT_THAT(driver->parseString("a=1\nb=2\n"), IsTrue());
+    ast::node_t* block = driver->getAST();
+    ASSERT_THAT(block, NotNull());
+    ASSERT_THAT(block->info.type, Eq(ast::NT_BLOCK));
+    ASSERT_THAT(block->block.next, NotNull());
+    ASSERT_THAT(block->block.next->block.next, IsNull());
+}
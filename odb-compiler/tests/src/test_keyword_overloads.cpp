@@ -0,0 +1,131 @@
+#include <gmock/gmock.h>
+#include "odbc/parsers/keywords/Keyword.hpp"
+#include "odbc/parsers/keywords/KeywordsDB.hpp"
+#include "odbc/parsers/keywords/KeywordSnapshot.hpp"
+
+#define NAME keyword_overloads
+
+using namespace testing;
+using namespace odbc;
+
+using T = KeywordArgType;
+
+class NAME : public Test
+{
+public:
+    const Keyword* addKeyword(const std::string& name, std::vector<std::vector<std::string>> overloads)
+    {
+        Keyword keyword;
+        keyword.name = name;
+        keyword.overloads = std::move(overloads);
+        db.addKeyword(std::move(keyword));
+        return db.lookup(name);
+    }
+
+    KeywordDB db;
+};
+
+TEST_F(NAME, arg_types)
+{
+    EXPECT_THAT(parseKeywordArgType("x as Float"), Eq(T::Float));
+    EXPECT_THAT(parseKeywordArgType("fontName as String"), Eq(T::String));
+    EXPECT_THAT(parseKeywordArgType("wordWrap as Boolean"), Eq(T::Integer));
+    EXPECT_THAT(parseKeywordArgType("value as Double Integer"), Eq(T::Integer));
+    EXPECT_THAT(parseKeywordArgType("int pdfid"), Eq(T::Integer));
+    EXPECT_THAT(parseKeywordArgType("LPSTR filestr2"), Eq(T::String));
+    EXPECT_THAT(parseKeywordArgType("float resolution"), Eq(T::Float));
+    EXPECT_THAT(parseKeywordArgType("Integer Value"), Eq(T::Integer));
+    EXPECT_THAT(parseKeywordArgType("Float Value"), Eq(T::Float));
+    EXPECT_THAT(parseKeywordArgType("Double Integer Value"), Eq(T::Integer));
+    EXPECT_THAT(parseKeywordArgType("String"), Eq(T::String));
+    EXPECT_THAT(parseKeywordArgType("Filename"), Eq(T::String));
+    EXPECT_THAT(parseKeywordArgType("Object Number"), Eq(T::Any));
+    EXPECT_THAT(parseKeywordArgType("X"), Eq(T::Any));
+    EXPECT_THAT(parseKeywordArgType(""), Eq(T::Any));
+}
+
+TEST_F(NAME, signatures_are_built_when_added)
+{
+    const Keyword* keyword = addKeyword("DBLOADPDF", {{"int pdfid", "LPSTR filestr2", "float resolution"}});
+    ASSERT_THAT(keyword, NotNull());
+    ASSERT_THAT(keyword->signatures.size(), Eq(1u));
+    ASSERT_THAT(keyword->signatures[0], ElementsAre(T::Integer, T::String, T::Float));
+}
+
+TEST_F(NAME, resolve_by_arity)
+{
+    const Keyword* keyword = addKeyword("POSITION OBJECT", {
+        {"Object Number", "X", "Y", "Z"},
+        {"Object Number"}});
+    ASSERT_THAT(keyword->resolveOverload({T::Integer}), Eq(1));
+    ASSERT_THAT(keyword->resolveOverload({T::Integer, T::Float, T::Float, T::Float}), Eq(0));
+    ASSERT_THAT(keyword->resolveOverload({T::Integer, T::Float}), Eq(Keyword::noOverload));
+}
+
+TEST_F(NAME, resolve_by_type)
+{
+    const Keyword* keyword = addKeyword("a2Line", {
+        {"x1 as Float", "y1 as Float", "color as Integer"},
+        {"x1 as Integer", "y1 as Integer", "color as Integer"},
+        {"text as String", "y1 as Float", "color as Integer"}});
+    ASSERT_THAT(keyword->resolveOverload({T::Float, T::Float, T::Integer}), Eq(0));
+    ASSERT_THAT(keyword->resolveOverload({T::Integer, T::Integer, T::Integer}), Eq(1));
+    ASSERT_THAT(keyword->resolveOverload({T::String, T::Float, T::Integer}), Eq(2));
+
+    // Integer and float convert into each other, strings don't
+    ASSERT_THAT(keyword->resolveOverload({T::Integer, T::Float, T::Integer}), Eq(0));
+    ASSERT_THAT(keyword->resolveOverload({T::String, T::String, T::Integer}), Eq(Keyword::noOverload));
+
+    // Unknown argument types match anything, first overload wins a tie
+    ASSERT_THAT(keyword->resolveOverload({T::Any, T::Any, T::Any}), Eq(0));
+}
+
+TEST_F(NAME, resolve_long_argument_lists)
+{
+    std::vector<std::string> a(40, "Integer Value"), b(40, "Integer Value");
+    b.back() = "String";
+    const Keyword* keyword = addKeyword("LONG", {a, b});
+
+    std::vector<T> call(40, T::Integer);
+    ASSERT_THAT(keyword->resolveOverload(call), Eq(0));
+    call.back() = T::String;
+    ASSERT_THAT(keyword->resolveOverload(call), Eq(1));
+}
+
+TEST_F(NAME, snapshot_keywords_have_signatures)
+{
+    addKeyword("SYNC RATE", {{"Integer Value"}});
+    ASSERT_THAT(db.freeze(), IsTrue());
+    const KeywordSnapshot* snapshot = db.getSnapshot();
+    Keyword keyword = snapshot->toKeyword(snapshot->find("SYNC RATE"));
+    ASSERT_THAT(keyword.resolveOverload({T::Integer}), Eq(0));
+}
+
+TEST_F(NAME, snapshot_resolves_without_copying)
+{
+    addKeyword("a2Line", {
+        {"x1 as Float", "y1 as Float", "color as Integer"},
+        {"x1 as Integer", "y1 as Integer", "color as Integer"},
+        {"text as String", "y1 as Float", "color as Integer"},
+        {"Object Number"}});
+    ASSERT_THAT(db.freeze(), IsTrue());
+    const KeywordSnapshot* snapshot = db.getSnapshot();
+    KeywordSnapshot::Index line = snapshot->find("a2Line");
+    ASSERT_THAT(line, Ne(KeywordSnapshot::notFound));
+
+    EXPECT_THAT(snapshot->argType(line, 2, 0), Eq(T::String));
+    EXPECT_THAT(snapshot->resolveOverload(line, {T::Float, T::Float, T::Integer}), Eq(0));
+    EXPECT_THAT(snapshot->resolveOverload(line, {T::Integer, T::Integer, T::Integer}), Eq(1));
+    EXPECT_THAT(snapshot->resolveOverload(line, {T::String, T::Float, T::Integer}), Eq(2));
+    EXPECT_THAT(snapshot->resolveOverload(line, {T::Integer, T::Float, T::Integer}), Eq(0));
+    EXPECT_THAT(snapshot->resolveOverload(line, {T::Integer}), Eq(3));
+    EXPECT_THAT(snapshot->resolveOverload(line, {T::String, T::String, T::Integer}), Eq(Keyword::noOverload));
+    EXPECT_THAT(snapshot->resolveOverload(line, {}), Eq(Keyword::noOverload));
+
+    // The tables copied out are the ones buildSignatures() makes
+    Keyword copied = snapshot->toKeyword(line);
+    Keyword built = copied;
+    built.buildSignatures();
+    EXPECT_THAT(copied.signatures, Eq(built.signatures));
+    EXPECT_THAT(copied.dispatch, Eq(built.dispatch));
+}
@@ -0,0 +1,169 @@
+#include <gmock/gmock.h>
+#include "odbc/parsers/keywords/KeywordsDB.hpp"
+#include "odbc/parsers/keywords/KeywordSnapshot.hpp"
+#include "odbc/tests/TempPath.hpp"
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+
+#define NAME keyword_snapshot
+
+using namespace testing;
+
+class NAME : public Test
+{
+public:
+    void SetUp() override
+    {
+        fileName = uniqueTempPath("odbc_keyword_snapshot_test", ".odbkw").string();
+
+        odbc::Keyword keyword;
+        keyword.name = "MAKE OBJECT SPHERE";
+        keyword.helpFile = "sphere.htm";
+        keyword.overloads = {{"Object Number", "Radius"}, {"Object Number", "Radius", "Rows", "Columns"}};
+        db.addKeyword(std::move(keyword));
+
+        keyword.name = "OBJECT EXIST";
+        keyword.helpFile = "exist.htm";
+        keyword.overloads = {{"Object Number"}};
+        keyword.hasReturnType = true;
+        db.addKeyword(std::move(keyword));
+
+        keyword.name = "SYNC";
+        keyword.helpFile = "sync.htm";
+        keyword.overloads = {{}};
+        keyword.hasReturnType = false;
+        db.addKeyword(std::move(keyword));
+    }
+
+    void TearDown() override
+    {
+        std::filesystem::remove(fileName);
+    }
+
+    odbc::KeywordDB db;
+    std::string fileName;
+};
+
+using namespace odbc;
+
+TEST_F(NAME, write_and_load)
+{
+    ASSERT_THAT(db.writeSnapshot(fileName), IsTrue());
+
+    KeywordDB loaded;
+    ASSERT_THAT(loaded.loadSnapshot(fileName), IsTrue());
+    const KeywordSnapshot* snapshot = loaded.getSnapshot();
+    ASSERT_THAT(snapshot, NotNull());
+    ASSERT_THAT(snapshot->size(), Eq(3u));
+
+    KeywordSnapshot::Index sphere = snapshot->find("MAKE OBJECT SPHERE");
+    ASSERT_THAT(sphere, Ne(KeywordSnapshot::notFound));
+    ASSERT_THAT(snapshot->name(sphere), Eq("MAKE OBJECT SPHERE"));
+    ASSERT_THAT(snapshot->helpFile(sphere), Eq("sphere.htm"));
+    ASSERT_THAT(snapshot->hasReturnType(sphere), IsFalse());
+    ASSERT_THAT(snapshot->overloadCount(sphere), Eq(2u));
+    ASSERT_THAT(snapshot->argCount(sphere, 0), Eq(2u));
+    ASSERT_THAT(snapshot->argCount(sphere, 1), Eq(4u));
+    ASSERT_THAT(snapshot->arg(sphere, 1, 3), Eq("Columns"));
+
+    KeywordSnapshot::Index exist = snapshot->find("OBJECT EXIST");
+    ASSERT_THAT(exist, Ne(KeywordSnapshot::notFound));
+    ASSERT_THAT(snapshot->hasReturnType(exist), IsTrue());
+
+    KeywordSnapshot::Index sync = snapshot->find("SYNC");
+    ASSERT_THAT(sync, Ne(KeywordSnapshot::notFound));
+    ASSERT_THAT(snapshot->overloadCount(sync), Eq(1u));
+    ASSERT_THAT(snapshot->argCount(sync, 0), Eq(0u));
+
+    ASSERT_THAT(loaded.exists("SYNC"), IsTrue());
+    ASSERT_THAT(loaded.exists("SYNC ON"), IsFalse());
+    ASSERT_THAT(snapshot->find("MAKE OBJECT"), Eq(KeywordSnapshot::notFound));
+}
+
+TEST_F(NAME, to_keyword_copies_everything)
+{
+    std::vector<const Keyword*> keywords = {db.lookup("MAKE OBJECT SPHERE")};
+    auto snapshot = KeywordSnapshot::fromKeywords(keywords);
+    ASSERT_THAT(snapshot, NotNull());
+
+    Keyword keyword = snapshot->toKeyword(0);
+    ASSERT_THAT(keyword.name, Eq("MAKE OBJECT SPHERE"));
+    ASSERT_THAT(keyword.helpFile, Eq("sphere.htm"));
+    ASSERT_THAT(keyword.hasReturnType, IsFalse());
+    ASSERT_THAT(keyword.overloads, Eq(db.lookup("MAKE OBJECT SPHERE")->overloads));
+}
+
+TEST_F(NAME, names_differing_only_in_case_are_rejected)
+{
+    Keyword lower = *db.lookup("SYNC");
+    lower.name = "sync";
+    Keyword spaced = *db.lookup("MAKE OBJECT SPHERE");
+    spaced.name = "MAKE  OBJECT\tSPHERE";
+
+    ASSERT_THAT(KeywordSnapshot::fromKeywords({db.lookup("SYNC"), &lower}), IsNull());
+    ASSERT_THAT(KeywordSnapshot::fromKeywords({db.lookup("MAKE OBJECT SPHERE"), &spaced}), IsNull());
+    ASSERT_THAT(KeywordSnapshot::write(fileName, {db.lookup("SYNC"), &lower}), IsFalse());
+    ASSERT_THAT(std::filesystem::exists(fileName), IsFalse());
+}
+
+TEST_F(NAME, empty_snapshot_finds_nothing)
+{
+    auto snapshot = KeywordSnapshot::fromKeywords({});
+    ASSERT_THAT(snapshot, NotNull());
+    ASSERT_THAT(snapshot->find("SYNC"), Eq(KeywordSnapshot::notFound));
+}
+
+TEST_F(NAME, damaged_file_is_rejected)
+{
+    ASSERT_THAT(db.writeSnapshot(fileName), IsTrue());
+    std::filesystem::resize_file(fileName, std::filesystem::file_size(fileName) - 1);
+
+    KeywordDB loaded;
+    ASSERT_THAT(loaded.loadSnapshot(fileName), IsFalse());
+    ASSERT_THAT(loaded.getSnapshot(), IsNull());
+}
+
+TEST_F(NAME, stale_snapshot_falls_back_to_directory)
+{
+    std::filesystem::path dir = uniqueTempPath("odbc_keyword_snapshot_dir");
+    std::filesystem::create_directories(dir);
+    std::ofstream(dir / "a.ini", std::ios::binary) << "PHY START=c.htm=c\n";
+    ASSERT_THAT(db.writeSnapshot(fileName), IsTrue());
+
+    // Newer than the directory and the file it holds
+    auto now = std::filesystem::last_write_time(fileName);
+    std::filesystem::last_write_time(dir, now - std::chrono::hours(2));
+    std::filesystem::last_write_time(dir / "a.ini", now - std::chrono::hours(2));
+    KeywordDB fresh;
+    ASSERT_THAT(fresh.loadSnapshotOrDirectory(fileName, dir.string()), IsTrue());
+    EXPECT_THAT(fresh.getSnapshot(), NotNull());
+    EXPECT_THAT(fresh.exists("SYNC"), IsTrue());
+    EXPECT_THAT(fresh.exists("PHY START"), IsFalse());
+
+    // An edited file makes it stale
+    std::filesystem::last_write_time(dir / "a.ini", now + std::chrono::hours(1));
+    KeywordDB edited;
+    ASSERT_THAT(edited.loadSnapshotOrDirectory(fileName, dir.string()), IsTrue());
+    EXPECT_THAT(edited.getSnapshot(), IsNull());
+    EXPECT_THAT(edited.exists("PHY START"), IsTrue());
+
+    // So does an added or removed one
+    std::filesystem::last_write_time(dir / "a.ini", now - std::chrono::hours(2));
+    std::filesystem::last_write_time(dir, now + std::chrono::hours(1));
+    KeywordDB added;
+    ASSERT_THAT(added.loadSnapshotOrDirectory(fileName, dir.string()), IsTrue());
+    EXPECT_THAT(added.getSnapshot(), IsNull());
+
+    KeywordDB missing;
+    ASSERT_THAT(missing.loadSnapshotOrDirectory("this/file/does/not/exist.odbkw", dir.string()), IsTrue());
+    EXPECT_THAT(missing.exists("PHY START"), IsTrue());
+
+    std::filesystem::remove_all(dir);
+}
+
+TEST_F(NAME, missing_file_is_rejected)
+{
+    KeywordDB loaded;
+    ASSERT_THAT(loaded.loadSnapshot("this/file/does/not/exist.odbkw"), IsFalse());
+}
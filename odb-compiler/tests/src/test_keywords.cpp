@@ -1,6 +1,9 @@
 #include <gmock/gmock.h>
 #include "odbc/parsers/keywords/Driver.hpp"
 #include "odbc/parsers/keywords/KeywordsDB.hpp"
+#include "odbc/tests/TempPath.hpp"
+#include <filesystem>
+#include <fstream>
 
 #define NAME parse_keywords
 
@@ -265,3 +268,27 @@ TEST_F(NAME, parse_multiple_lines)
     ASSERT_THAT(keywords->lookup("SOME WOWEE")->overloads[0].size(), Eq(1));
     ASSERT_THAT(keywords->lookup("SOME WOWEE")->overloads[0][0], Eq("c"));
 }
+
+TEST_F(NAME, parse_file)
+{
+    std::string fileName = uniqueTempPath("odbc_parse_keywords_test", ".ini").string();
+    {
+        std::ofstream out(fileName, std::ios::binary);
+        out << "FIRST COMMAND=first.htm=a, b\n"
+            << "SECOND COMMAND=second.htm=[ c ][(d)]\n";
+    }
+    ASSERT_THAT(driver->parseFile(fileName), IsTrue());
+    std::filesystem::remove(fileName);
+
+    // Keywords must not refer to the file's buffer anymore
+    ASSERT_THAT(keywords->lookup("FIRST COMMAND"), NotNull());
+    ASSERT_THAT(keywords->lookup("FIRST COMMAND")->helpFile, StrEq("first.htm"));
+    ASSERT_THAT(keywords->lookup("FIRST COMMAND")->overloads[0], ElementsAre("a", "b"));
+    ASSERT_THAT(keywords->lookup("SECOND COMMAND"), NotNull());
+    ASSERT_THAT(keywords->lookup("SECOND COMMAND")->overloads[0], ElementsAre("c"));
+}
+
+TEST_F(NAME, parse_missing_file)
+{
+    ASSERT_THAT(driver->parseFile("does/not/exist.ini"), IsFalse());
+}
@@ -0,0 +1,89 @@
+#include <gmock/gmock.h>
+#include "odbc/parsers/keywords/KeywordsDB.hpp"
+#include "odbc/tests/TempPath.hpp"
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+#define NAME keywords_directory
+
+using namespace testing;
+
+class NAME : public Test
+{
+public:
+    void SetUp() override
+    {
+        dir = uniqueTempPath("odbc_keywords_directory_test");
+        std::filesystem::remove_all(dir);
+        std::filesystem::create_directories(dir);
+    }
+
+    void TearDown() override
+    {
+        std::filesystem::remove_all(dir);
+    }
+
+    void writeFile(const std::string& name, const std::string& contents)
+    {
+        std::ofstream out(dir / name, std::ios::binary);
+        out << contents;
+    }
+
+    std::filesystem::path dir;
+};
+
+using namespace odbc;
+
+TEST_F(NAME, loads_all_ini_files)
+{
+    for (int i = 0; i != 20; ++i)
+        writeFile("plugin" + std::to_string(i) + ".ini",
+                  "PLUGIN" + std::to_string(i) + " COMMAND=help.htm=a\n");
+    writeFile("readme.txt", "NOT A KEYWORD=help.htm=a\n");
+
+    KeywordDB db;
+    ASSERT_THAT(db.loadFromDirectory(dir.string(), 4), IsTrue());
+    for (int i = 0; i != 20; ++i)
+        ASSERT_THAT(db.lookup("PLUGIN" + std::to_string(i) + " COMMAND"), NotNull());
+    ASSERT_THAT(db.lookup("NOT A KEYWORD"), IsNull());
+    ASSERT_THAT(db.getLoadReport().conflicts, IsEmpty());
+}
+
+TEST_F(NAME, first_file_wins_on_conflict)
+{
+    writeFile("a.ini", "SHARED COMMAND=a.htm=a\n");
+    writeFile("b.ini", "SHARED COMMAND=b.htm=b\n");
+    writeFile("c.ini", "SHARED COMMAND=c.htm=c\n");
+
+    // The outcome must not depend on which thread finishes first
+    for (unsigned threads : {1u, 2u, 3u})
+    {
+        KeywordDB db;
+        ASSERT_THAT(db.loadFromDirectory(dir.string(), threads), IsTrue());
+        ASSERT_THAT(db.lookup("SHARED COMMAND"), NotNull());
+        ASSERT_THAT(db.lookup("SHARED COMMAND")->helpFile, StrEq("a.htm"));
+
+        ASSERT_THAT(db.getLoadReport().conflicts.size(), Eq(2u));
+        ASSERT_THAT(db.getLoadReport().conflicts[0].name, StrEq("SHARED COMMAND"));
+        ASSERT_THAT(db.getLoadReport().conflicts[0].firstFile, EndsWith("a.ini"));
+        ASSERT_THAT(db.getLoadReport().conflicts[0].secondFile, EndsWith("b.ini"));
+        ASSERT_THAT(db.getLoadReport().conflicts[1].secondFile, EndsWith("c.ini"));
+    }
+}
+
+TEST_F(NAME, failed_file_doesnt_stop_others)
+{
+    writeFile("good.ini", "GOOD COMMAND=help.htm=a\n");
+    writeFile("bad.ini", "this is not a keyword file\n");
+
+    KeywordDB db;
+    ASSERT_THAT(db.loadFromDirectory(dir.string()), IsFalse());
+    ASSERT_THAT(db.lookup("GOOD COMMAND"), NotNull());
+}
+
+TEST_F(NAME, missing_directory)
+{
+    KeywordDB db;
+    ASSERT_THAT(db.loadFromDirectory((dir / "does_not_exist").string()), IsFalse());
+}
@@ -0,0 +1,172 @@
+#include <gmock/gmock.h>
+#include "odbc/parsers/keywords/KeywordsDB.hpp"
+#include "odbc/parsers/keywords/KeywordSnapshot.hpp"
+#include "odbc/tests/TempPath.hpp"
+#include <atomic>
+#include <filesystem>
+#include <string>
+#include <thread>
+#include <vector>
+
+#define NAME keywords_freeze
+
+using namespace testing;
+
+class NAME : public Test
+{
+public:
+    void addKeyword(const std::string& name, std::vector<std::vector<std::string>> overloads)
+    {
+        odbc::Keyword keyword;
+        keyword.name = name;
+        keyword.helpFile = name + ".htm";
+        keyword.overloads = std::move(overloads);
+        db.addKeyword(std::move(keyword));
+    }
+
+    odbc::KeywordDB db;
+};
+
+using namespace odbc;
+
+TEST_F(NAME, frozen_keywords_are_in_snapshot)
+{
+    addKeyword("MAKE OBJECT SPHERE", {{"Object Number", "Radius"}});
+    addKeyword("SYNC", {{}});
+    ASSERT_THAT(db.freeze(), IsTrue());
+    ASSERT_THAT(db.isFrozen(), IsTrue());
+
+    const KeywordSnapshot* snapshot = db.getSnapshot();
+    ASSERT_THAT(snapshot, NotNull());
+    ASSERT_THAT(snapshot->size(), Eq(2u));
+    KeywordSnapshot::Index sphere = snapshot->find("MAKE OBJECT SPHERE");
+    ASSERT_THAT(sphere, Ne(KeywordSnapshot::notFound));
+    ASSERT_THAT(snapshot->helpFile(sphere), Eq("MAKE OBJECT SPHERE.htm"));
+    ASSERT_THAT(snapshot->arg(sphere, 0, 1), Eq("Radius"));
+    ASSERT_THAT(db.exists("SYNC"), IsTrue());
+    ASSERT_THAT(db.exists("SYNC ON"), IsFalse());
+}
+
+TEST_F(NAME, lookup_finds_frozen_keywords)
+{
+    addKeyword("MAKE OBJECT SPHERE", {{"Object Number", "Radius"}});
+    ASSERT_THAT(db.freeze(), IsTrue());
+
+    const Keyword* keyword = db.lookup("make object  sphere");
+    ASSERT_THAT(keyword, NotNull());
+    ASSERT_THAT(keyword->name, StrEq("MAKE OBJECT SPHERE"));
+    ASSERT_THAT(keyword->helpFile, StrEq("MAKE OBJECT SPHERE.htm"));
+    ASSERT_THAT(keyword->overloads, Eq(std::vector<std::vector<std::string>>{{"Object Number", "Radius"}}));
+    ASSERT_THAT(db.lookup("MAKE OBJECT SPHERE"), Eq(keyword));
+    ASSERT_THAT(db.lookup("SYNC"), IsNull());
+}
+
+TEST_F(NAME, frozen_db_cant_be_changed)
+{
+    addKeyword("SYNC", {{}});
+    ASSERT_THAT(db.freeze(), IsTrue());
+    ASSERT_THAT(db.freeze(), IsFalse());
+
+    Keyword keyword;
+    keyword.name = "SYNC ON";
+    ASSERT_THAT(db.addKeyword(std::move(keyword)), IsFalse());
+    ASSERT_THAT(db.exists("SYNC ON"), IsFalse());
+    ASSERT_THAT(db.appendFromFile("does_not_matter.ini"), IsFalse());
+    ASSERT_THAT(db.loadSnapshot("does_not_matter.odbkw"), IsFalse());
+}
+
+TEST_F(NAME, freeze_merges_loaded_snapshot)
+{
+    std::string fileName = uniqueTempPath("odbc_keywords_freeze_test", ".odbkw").string();
+    addKeyword("FROM SNAPSHOT", {{"a"}});
+    addKeyword("IN BOTH", {{"old"}});
+    ASSERT_THAT(db.writeSnapshot(fileName), IsTrue());
+
+    KeywordDB other;
+    ASSERT_THAT(other.loadSnapshot(fileName), IsTrue());
+    Keyword keyword;
+    keyword.name = "IN BOTH";
+    keyword.overloads = {{"new"}};
+    other.addKeyword(std::move(keyword));
+    ASSERT_THAT(other.freeze(), IsTrue());
+    std::filesystem::remove(fileName);
+
+    const KeywordSnapshot* snapshot = other.getSnapshot();
+    ASSERT_THAT(snapshot->size(), Eq(2u));
+    ASSERT_THAT(snapshot->find("FROM SNAPSHOT"), Ne(KeywordSnapshot::notFound));
+    ASSERT_THAT(snapshot->arg(snapshot->find("IN BOTH"), 0, 0), Eq("new"));
+}
+
+TEST_F(NAME, lookup_finds_snapshot_keywords)
+{
+    std::string fileName = uniqueTempPath("odbc_keywords_freeze_test", ".odbkw").string();
+    addKeyword("FROM SNAPSHOT", {{"a"}});
+    addKeyword("IN BOTH", {{"old"}});
+    ASSERT_THAT(db.writeSnapshot(fileName), IsTrue());
+
+    KeywordDB other;
+    ASSERT_THAT(other.loadSnapshot(fileName), IsTrue());
+    std::filesystem::remove(fileName);
+    Keyword keyword;
+    keyword.name = "IN BOTH";
+    keyword.overloads = {{"new"}};
+    other.addKeyword(std::move(keyword));
+
+    ASSERT_THAT(other.lookup("FROM SNAPSHOT"), NotNull());
+    ASSERT_THAT(other.lookup("FROM SNAPSHOT")->overloads[0][0], StrEq("a"));
+    ASSERT_THAT(other.lookup("IN BOTH")->overloads[0][0], StrEq("new"));
+}
+
+TEST_F(NAME, frozen_db_writes_its_snapshot)
+{
+    std::string fileName = uniqueTempPath("odbc_keywords_frozen_test", ".odbkw").string();
+    addKeyword("SYNC", {{}});
+    ASSERT_THAT(db.freeze(), IsTrue());
+    ASSERT_THAT(db.writeSnapshot(fileName), IsTrue());
+
+    KeywordDB loaded;
+    ASSERT_THAT(loaded.loadSnapshot(fileName), IsTrue());
+    std::filesystem::remove(fileName);
+    ASSERT_THAT(loaded.exists("SYNC"), IsTrue());
+}
+
+TEST_F(NAME, perfect_hash_finds_every_keyword)
+{
+    for (int i = 0; i != 5000; ++i)
+        addKeyword("COMMAND " + std::to_string(i), {{"a"}});
+    ASSERT_THAT(db.freeze(), IsTrue());
+
+    const KeywordSnapshot* snapshot = db.getSnapshot();
+    for (int i = 0; i != 5000; ++i)
+    {
+        std::string name = "COMMAND " + std::to_string(i);
+        KeywordSnapshot::Index found = snapshot->find(name);
+        ASSERT_THAT(found, Ne(KeywordSnapshot::notFound));
+        ASSERT_THAT(snapshot->name(found), Eq(name));
+    }
+    for (int i = 5000; i != 6000; ++i)
+        ASSERT_THAT(snapshot->find("COMMAND " + std::to_string(i)), Eq(KeywordSnapshot::notFound));
+    ASSERT_THAT(snapshot->find(""), Eq(KeywordSnapshot::notFound));
+}
+
+TEST_F(NAME, concurrent_lookups)
+{
+    for (int i = 0; i != 1000; ++i)
+        addKeyword("COMMAND " + std::to_string(i), {{"a"}});
+    ASSERT_THAT(db.freeze(), IsTrue());
+
+    const KeywordDB& shared = db;
+    std::atomic<int> found(0);
+    std::vector<std::thread> threads;
+    for (int t = 0; t != 4; ++t)
+        threads.emplace_back([&shared, &found]() {
+            for (int i = 0; i != 1000; ++i)
+                if (shared.exists("COMMAND " + std::to_string(i)) &&
+                    shared.lookup("COMMAND " + std::to_string(i)) != nullptr)
+                    found++;
+        });
+    for (auto& thread : threads)
+        thread.join();
+
+    ASSERT_THAT(found.load(), Eq(4000));
+}
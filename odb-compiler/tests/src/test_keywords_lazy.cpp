@@ -0,0 +1,183 @@
+#include <gmock/gmock.h>
+#include "odbc/parsers/keywords/KeywordsDB.hpp"
+#include "odbc/tests/TempPath.hpp"
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#define NAME keywords_lazy
+
+using namespace testing;
+
+class NAME : public Test
+{
+public:
+    void SetUp() override
+    {
+        dir = uniqueTempPath("odbc_keywords_lazy_test");
+        std::filesystem::remove_all(dir);
+        std::filesystem::create_directories(dir);
+    }
+
+    void TearDown() override
+    {
+        std::filesystem::remove_all(dir);
+    }
+
+    void writeFile(const std::string& name, const std::string& contents)
+    {
+        std::ofstream out(dir / name, std::ios::binary);
+        out << contents;
+    }
+
+    std::filesystem::path dir;
+};
+
+using namespace odbc;
+
+TEST_F(NAME, index_reads_names_only)
+{
+    writeFile("a.ini", "MAKE MATRIX=a.htm=a\nDELETE MATRIX=b.htm=b\n");
+    writeFile("b.ini", "PHY START=c.htm=c\n");
+
+    KeywordDB db;
+    ASSERT_THAT(db.indexDirectory(dir.string()), IsTrue());
+    ASSERT_THAT(db.getLoadReport().files.size(), Eq(2u));
+    ASSERT_THAT(db.getLoadReport().keywordCount, Eq(3u));
+    ASSERT_THAT(db.exists("make matrix"), IsTrue());
+    ASSERT_THAT(db.exists("PHY START"), IsTrue());
+    ASSERT_THAT(db.exists("PHY END"), IsFalse());
+
+    auto trie = db.createCommandTrie();
+    ASSERT_THAT(trie, NotNull());
+    ASSERT_THAT(trie->size(), Eq(3u));
+}
+
+TEST_F(NAME, file_is_parsed_on_first_lookup)
+{
+    writeFile("a.ini", "MAKE MATRIX=a.htm=a\n");
+
+    KeywordDB db;
+    ASSERT_THAT(db.indexDirectory(dir.string()), IsTrue());
+
+    // Changes after indexing show that parsing happens on lookup
+    writeFile("a.ini", "MAKE MATRIX=changed.htm=a\n");
+    const Keyword* keyword = db.lookup("Make Matrix");
+    ASSERT_THAT(keyword, NotNull());
+    ASSERT_THAT(keyword->helpFile, StrEq("changed.htm"));
+    ASSERT_THAT(db.lookup("MAKE MATRIX"), Eq(keyword));
+    ASSERT_THAT(db.lookup("DELETE MATRIX"), IsNull());
+}
+
+TEST_F(NAME, first_file_wins_on_conflict)
+{
+    writeFile("a.ini", "SHARED COMMAND=a.htm=a\n");
+    writeFile("b.ini", "shared command=b.htm=b\nOTHER=c.htm=c\n");
+
+    KeywordDB db;
+    ASSERT_THAT(db.indexDirectory(dir.string()), IsTrue());
+    ASSERT_THAT(db.getLoadReport().conflicts.size(), Eq(1u));
+    ASSERT_THAT(db.getLoadReport().conflicts[0].firstFile, StrEq((dir / "a.ini").string()));
+    ASSERT_THAT(db.getLoadReport().conflicts[0].secondFile, StrEq((dir / "b.ini").string()));
+    ASSERT_THAT(db.lookup("SHARED COMMAND")->helpFile, StrEq("a.htm"));
+    ASSERT_THAT(db.lookup("OTHER")->helpFile, StrEq("c.htm"));
+}
+
+TEST_F(NAME, names_match_eager_loading)
+{
+    writeFile("a.ini",
+        "NULL$=Matrix1Util_04/null$.html=(*no parameters*)\n"
+        "MAX# =Matrix1Util_07\\max#.html=(Value1, Value2)\n"
+        "BANK STRING$=bank_string.htm=(Bank, Position)\n");
+
+    KeywordDB eager;
+    ASSERT_THAT(eager.loadFromDirectory(dir.string()), IsTrue());
+    KeywordDB lazy;
+    ASSERT_THAT(lazy.indexDirectory(dir.string()), IsTrue());
+
+    for (const char* name : {"NULL$", "MAX#", "BANK STRING$"})
+    {
+        ASSERT_THAT(eager.lookup(name), NotNull()) << name;
+        const Keyword* keyword = lazy.lookup(name);
+        ASSERT_THAT(keyword, NotNull()) << name;
+        EXPECT_THAT(keyword->name, StrEq(eager.lookup(name)->name));
+        EXPECT_THAT(keyword->helpFile, StrEq(eager.lookup(name)->helpFile));
+    }
+    EXPECT_THAT(eager.lookup("NULL"), IsNull());
+    EXPECT_THAT(lazy.lookup("NULL"), IsNull());
+    EXPECT_THAT(lazy.exists("NULL"), IsFalse());
+
+    ASSERT_THAT(lazy.freeze(), IsTrue());
+    EXPECT_THAT(lazy.getSnapshot()->size(), Eq(3u));
+}
+
+TEST_F(NAME, added_keywords_conflict_with_indexed_ones)
+{
+    writeFile("a.ini", "SYNC=a.htm=a\n");
+
+    KeywordDB db;
+    ASSERT_THAT(db.indexDirectory(dir.string()), IsTrue());
+    Keyword keyword;
+    keyword.name = "SYNC";
+    ASSERT_THAT(db.addKeyword(std::move(keyword)), IsFalse());
+    ASSERT_THAT(db.lookup("SYNC")->helpFile, StrEq("a.htm"));
+}
+
+TEST_F(NAME, freeze_parses_remaining_files)
+{
+    writeFile("a.ini", "MAKE MATRIX=a.htm=a\n");
+    writeFile("b.ini", "PHY START=b.htm=b\n");
+
+    KeywordDB db;
+    ASSERT_THAT(db.indexDirectory(dir.string()), IsTrue());
+    ASSERT_THAT(db.lookup("MAKE MATRIX"), NotNull());
+    ASSERT_THAT(db.freeze(), IsTrue());
+    ASSERT_THAT(db.getSnapshot()->size(), Eq(2u));
+    ASSERT_THAT(db.exists("PHY START"), IsTrue());
+}
+
+TEST_F(NAME, concurrent_lookups_parse_once)
+{
+    for (int i = 0; i != 8; ++i)
+        writeFile("plugin" + std::to_string(i) + ".ini",
+                  "PLUGIN" + std::to_string(i) + " COMMAND=help.htm=a\n");
+
+    KeywordDB db;
+    ASSERT_THAT(db.indexDirectory(dir.string()), IsTrue());
+
+    std::vector<const Keyword*> found(8 * 4);
+    std::vector<std::thread> threads;
+    for (int t = 0; t != 4; ++t)
+        threads.emplace_back([&, t]() {
+            for (int i = 0; i != 8; ++i)
+                found[t * 8 + i] = db.lookup("PLUGIN" + std::to_string(i) + " COMMAND");
+        });
+    for (auto& thread : threads)
+        thread.join();
+
+    for (int i = 0; i != 8; ++i)
+    {
+        ASSERT_THAT(found[i], NotNull());
+        for (int t = 1; t != 4; ++t)
+            ASSERT_THAT(found[t * 8 + i], Eq(found[i]));
+    }
+}
+
+TEST_F(NAME, missing_directory_fails)
+{
+    KeywordDB db;
+    ASSERT_THAT(db.indexDirectory((dir / "does_not_exist").string()), IsFalse());
+}
+
+TEST_F(NAME, duplicate_within_file)
+{
+    writeFile("a.ini", "SYNC=a.htm=a\nSYNC=b.htm=b\n");
+
+    KeywordDB db;
+    ASSERT_THAT(db.indexDirectory(dir.string()), IsTrue());
+    ASSERT_THAT(db.getLoadReport().conflicts.size(), Eq(1u));
+    ASSERT_THAT(db.getLoadReport().conflicts[0].firstFile, StrEq((dir / "a.ini").string()));
+    ASSERT_THAT(db.getLoadReport().conflicts[0].secondFile, StrEq((dir / "a.ini").string()));
+}
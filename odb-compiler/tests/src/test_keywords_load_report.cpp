@@ -0,0 +1,140 @@
+#include <gmock/gmock.h>
+#include "odbc/parsers/keywords/KeywordsDB.hpp"
+#include "odbc/tests/TempPath.hpp"
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+#define NAME keywords_load_report
+
+using namespace testing;
+
+class NAME : public Test
+{
+public:
+    void SetUp() override
+    {
+        dir = uniqueTempPath("odbc_keywords_load_report_test");
+        std::filesystem::remove_all(dir);
+        std::filesystem::create_directories(dir);
+    }
+
+    void TearDown() override
+    {
+        std::filesystem::remove_all(dir);
+    }
+
+    std::string writeFile(const std::string& name, const std::string& contents)
+    {
+        std::ofstream out(dir / name, std::ios::binary);
+        out << contents;
+        return (dir / name).string();
+    }
+
+    std::filesystem::path dir;
+};
+
+using namespace odbc;
+
+TEST_F(NAME, add_keyword_counts_and_rejects_duplicates)
+{
+    KeywordDB db;
+    Keyword keyword;
+    keyword.name = "SYNC";
+    keyword.overloads = {{}, {"Rate"}};
+    ASSERT_THAT(db.addKeyword(std::move(keyword)), IsTrue());
+
+    Keyword duplicate;
+    duplicate.name = "SYNC";
+    duplicate.helpFile = "other.htm";
+    ASSERT_THAT(db.addKeyword(std::move(duplicate)), IsFalse());
+    ASSERT_THAT(db.lookup("SYNC")->helpFile, StrEq(""));
+
+    const KeywordLoadReport& report = db.getLoadReport();
+    ASSERT_THAT(report.keywordCount, Eq(1u));
+    ASSERT_THAT(report.overloadCount, Eq(2u));
+    ASSERT_THAT(report.conflicts.size(), Eq(1u));
+    ASSERT_THAT(report.conflicts[0].name, StrEq("SYNC"));
+    ASSERT_THAT(report.conflicts[0].secondFile, IsEmpty());
+    ASSERT_THAT(report.files, IsEmpty());
+}
+
+TEST_F(NAME, append_from_file_records_file)
+{
+    std::string fileName = writeFile("a.ini", "FIRST=first.htm=a\nSECOND=second.htm=b\nFIRST=again.htm=c\n");
+
+    KeywordDB db;
+    ASSERT_THAT(db.appendFromFile(fileName), IsTrue());
+
+    const KeywordLoadReport& report = db.getLoadReport();
+    ASSERT_THAT(report.files.size(), Eq(1u));
+    ASSERT_THAT(report.files[0].fileName, StrEq(fileName));
+    ASSERT_THAT(report.files[0].success, IsTrue());
+    ASSERT_THAT(report.files[0].keywordCount, Eq(3u));
+    ASSERT_THAT(report.files[0].parseTime, Ge(0.0));
+    ASSERT_THAT(report.keywordCount, Eq(2u));
+    ASSERT_THAT(report.conflicts.size(), Eq(1u));
+    ASSERT_THAT(report.conflicts[0].name, StrEq("FIRST"));
+    ASSERT_THAT(report.conflicts[0].firstFile, StrEq(fileName));
+    ASSERT_THAT(report.conflicts[0].secondFile, StrEq(fileName));
+}
+
+TEST_F(NAME, conflict_records_first_file)
+{
+    std::string first = writeFile("a.ini", "SHARED=a.htm=a\n");
+    std::string second = writeFile("b.ini", "SHARED=b.htm=b\n");
+    writeFile("c.ini", "SHARED=c.htm=c\n");
+
+    KeywordDB db;
+    ASSERT_THAT(db.appendFromFile(first), IsTrue());
+    ASSERT_THAT(db.appendFromFile(second), IsTrue());
+    ASSERT_THAT(db.loadFromDirectory(dir.string()), IsTrue());
+
+    Keyword keyword;
+    keyword.name = "shared";
+    ASSERT_THAT(db.addKeyword(std::move(keyword)), IsFalse());
+
+    const KeywordLoadReport& report = db.getLoadReport();
+    ASSERT_THAT(report.conflicts.size(), Eq(5u));
+    for (const auto& conflict : report.conflicts)
+        EXPECT_THAT(conflict.firstFile, StrEq(first));
+    EXPECT_THAT(report.conflicts[0].secondFile, StrEq(second));
+    EXPECT_THAT(report.conflicts[4].secondFile, IsEmpty());
+}
+
+TEST_F(NAME, directory_report_lists_files_in_order)
+{
+    writeFile("b.ini", "B COMMAND=b.htm=b\n");
+    writeFile("a.ini", "A COMMAND=a.htm=a\nSHARED=a.htm=a\n");
+    writeFile("c.ini", "SHARED=c.htm=c\n");
+    writeFile("d.ini", "this is not a keyword file\n");
+
+    KeywordDB db;
+    ASSERT_THAT(db.loadFromDirectory(dir.string(), 3), IsFalse());
+
+    const KeywordLoadReport& report = db.getLoadReport();
+    ASSERT_THAT(report.files.size(), Eq(4u));
+    ASSERT_THAT(report.files[0].fileName, EndsWith("a.ini"));
+    ASSERT_THAT(report.files[0].keywordCount, Eq(2u));
+    ASSERT_THAT(report.files[1].fileName, EndsWith("b.ini"));
+    ASSERT_THAT(report.files[2].fileName, EndsWith("c.ini"));
+    ASSERT_THAT(report.files[2].success, IsTrue());
+    ASSERT_THAT(report.files[3].fileName, EndsWith("d.ini"));
+    ASSERT_THAT(report.files[3].success, IsFalse());
+    ASSERT_THAT(report.keywordCount, Eq(3u));
+    ASSERT_THAT(report.conflicts.size(), Eq(1u));
+    ASSERT_THAT(report.conflicts[0].firstFile, EndsWith("a.ini"));
+    ASSERT_THAT(report.conflicts[0].secondFile, EndsWith("c.ini"));
+}
+
+TEST_F(NAME, clear_load_report_keeps_keywords)
+{
+    std::string fileName = writeFile("a.ini", "FIRST=first.htm=a\n");
+
+    KeywordDB db;
+    ASSERT_THAT(db.appendFromFile(fileName), IsTrue());
+    db.clearLoadReport();
+    ASSERT_THAT(db.getLoadReport().files, IsEmpty());
+    ASSERT_THAT(db.getLoadReport().keywordCount, Eq(0u));
+    ASSERT_THAT(db.lookup("FIRST"), NotNull());
+}
@@ -0,0 +1,91 @@
+#include <gmock/gmock.h>
+#include "odbc/parsers/keywords/CommandTrie.hpp"
+#include "odbc/parsers/keywords/KeywordName.hpp"
+#include "odbc/parsers/keywords/KeywordsDB.hpp"
+#include "odbc/parsers/keywords/KeywordSnapshot.hpp"
+#include <string>
+
+#define NAME keywords_lookup
+
+using namespace testing;
+
+class NAME : public Test
+{
+public:
+    bool addKeyword(const std::string& name)
+    {
+        odbc::Keyword keyword;
+        keyword.name = name;
+        keyword.overloads.push_back({});
+        return db.addKeyword(std::move(keyword));
+    }
+
+    odbc::KeywordDB db;
+};
+
+using namespace odbc;
+
+TEST_F(NAME, lookup_ignores_case_and_whitespace)
+{
+    ASSERT_THAT(addKeyword("MAKE OBJECT SPHERE"), IsTrue());
+    ASSERT_THAT(db.lookup("make object sphere"), NotNull());
+    ASSERT_THAT(db.lookup("Make\tObject   Sphere"), NotNull());
+    ASSERT_THAT(db.lookup("  MAKE OBJECT SPHERE "), NotNull());
+    ASSERT_THAT(db.lookup("make object sphere")->name, StrEq("MAKE OBJECT SPHERE"));
+    ASSERT_THAT(db.lookup("MAKE OBJECTSPHERE"), IsNull());
+    ASSERT_THAT(db.lookup("MAKE OBJECT"), IsNull());
+    ASSERT_THAT(db.exists("make object sphere"), IsTrue());
+}
+
+TEST_F(NAME, lookup_with_precomputed_hash)
+{
+    addKeyword("SYNC ON");
+
+    KeywordNameHash hash;
+    for (char c : std::string("sync   on"))
+        hash.add(c);
+    ASSERT_THAT(hash.value(), Eq(hashKeywordName("SYNC ON")));
+    ASSERT_THAT(db.lookup("sync   on", hash.value()), NotNull());
+    ASSERT_THAT(db.exists("sync   on", hash.value()), IsTrue());
+}
+
+TEST_F(NAME, names_differing_in_case_conflict)
+{
+    ASSERT_THAT(addKeyword("SYNC"), IsTrue());
+    ASSERT_THAT(addKeyword("sync"), IsFalse());
+    ASSERT_THAT(addKeyword(" Sync "), IsFalse());
+    ASSERT_THAT(db.getLoadReport().keywordCount, Eq(1u));
+    ASSERT_THAT(db.getLoadReport().conflicts.size(), Eq(2u));
+}
+
+TEST_F(NAME, frozen_lookup_ignores_case_and_whitespace)
+{
+    addKeyword("MAKE OBJECT SPHERE");
+    ASSERT_THAT(db.freeze(), IsTrue());
+    ASSERT_THAT(db.exists("make  object\tsphere"), IsTrue());
+    ASSERT_THAT(db.getSnapshot()->find("make object sphere"), Ne(KeywordSnapshot::notFound));
+    ASSERT_THAT(db.exists("make object"), IsFalse());
+}
+
+TEST_F(NAME, names_equal)
+{
+    ASSERT_THAT(keywordNamesEqual("", ""), IsTrue());
+    ASSERT_THAT(keywordNamesEqual("  ", ""), IsTrue());
+    ASSERT_THAT(keywordNamesEqual("a b", "A  B"), IsTrue());
+    ASSERT_THAT(keywordNamesEqual("a b ", "A\tB"), IsTrue());
+    ASSERT_THAT(keywordNamesEqual("ab", "a b"), IsFalse());
+    ASSERT_THAT(keywordNamesEqual("a b", "a bc"), IsFalse());
+    ASSERT_THAT(keywordNamesEqual("a", "a b"), IsFalse());
+}
+
+TEST_F(NAME, trie_match_hash_can_be_used_for_lookup)
+{
+    addKeyword("MAKE OBJECT SPHERE");
+    auto trie = db.createCommandTrie();
+    ASSERT_THAT(trie, NotNull());
+
+    CommandTrie::Match match = trie->longestMatch("make   object sphere 1, 10");
+    ASSERT_THAT(match.keyword, Ne(CommandTrie::notFound));
+    ASSERT_THAT(match.hash, Eq(hashKeywordName("MAKE OBJECT SPHERE")));
+    ASSERT_THAT(db.lookup(trie->name(match.keyword), match.hash), NotNull());
+}
@@ -0,0 +1,79 @@
+#include <gmock/gmock.h>
+#include "odbc/parsers/SourceBuffer.hpp"
+#include "odbc/parsers/db/Driver.hpp"
+#include "odbc/ast/Node.hpp"
+#include "odbc/tests/TempPath.hpp"
+#include <filesystem>
+#include <fstream>
+
+#define NAME source_buffer
+
+using namespace testing;
+
+class NAME : public Test
+{
+public:
+    void TearDown() override
+    {
+        if (!fileName.empty())
+            std::filesystem::remove(fileName);
+    }
+
+    void writeFile(const std::string& contents)
+    {
+        fileName = uniqueTempPath("odbc_source_buffer_test", ".dba").string();
+        std::ofstream out(fileName, std::ios::binary);
+        out << contents;
+    }
+
+    std::string fileName;
+};
+
+using namespace odbc;
+
+TEST_F(NAME, file_is_padded_with_two_nul_bytes)
+{
+    // Sizes around a page boundary exercise both the "padding is free" and
+    // the "extra page needed" paths
+    for (std::size_t size : {1, 4094, 4095, 4096, 4097, 8192})
+    {
+        writeFile(std::string(size, 'a'));
+        std::unique_ptr<SourceBuffer> buffer = SourceBuffer::fromFile(fileName);
+        ASSERT_THAT(buffer, NotNull()) << size;
+        ASSERT_THAT(buffer->size(), Eq(size));
+        ASSERT_THAT(buffer->scanSize(), Eq(size + 2));
+        ASSERT_THAT(buffer->data()[size - 1], Eq('a'));
+        ASSERT_THAT(buffer->data()[size], Eq('\0'));
+        ASSERT_THAT(buffer->data()[size + 1], Eq('\0'));
+    }
+}
+
+TEST_F(NAME, empty_file)
+{
+    writeFile("");
+    std::unique_ptr<SourceBuffer> buffer = SourceBuffer::fromFile(fileName);
+    ASSERT_THAT(buffer, NotNull());
+    ASSERT_THAT(buffer->size(), Eq(0u));
+    ASSERT_THAT(buffer->data()[0], Eq('\0'));
+}
+
+TEST_F(NAME, missing_file_fails)
+{
+    ASSERT_THAT(SourceBuffer::fromFile("this/file/does/not/exist.dba"), IsNull());
+
+    db::Driver driver;
+    ASSERT_THAT(driver.parseFile("this/file/does/not/exist.dba"), IsFalse());
+}
+
+TEST_F(NAME, string_literal_points_into_mapping)
+{
+    writeFile("a$=\"hello world\"\n");
+
+    db::Driver driver;
+    ASSERT_THAT(driver.parseFile(fileName), IsTrue());
+
+    ast::node_t* literal = driver.getAST()->block.statement->assignment.statement;
+    ASSERT_THAT(literal->info.type, Eq(ast::NT_LITERAL));
+    ASSERT_THAT(literal->literal.type, Eq(ast::LT_STRING));
+    ASSERT_THAT(literal->literal.value.s, StrEq("hello world"));
+}
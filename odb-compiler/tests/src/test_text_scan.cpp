@@ -0,0 +1,121 @@
+#include <gmock/gmock.h>
+#include "odbc/parsers/LineIndex.hpp"
+#include "odbc/parsers/TextScan.hpp"
+#include <string>
+#include <vector>
+
+#define NAME text_scan
+
+using namespace testing;
+
+class NAME : public Test
+{
+};
+
+using namespace odbc;
+
+TEST_F(NAME, find_newline)
+{
+    // Long enough for the vector loops to run several times
+    std::string text(100, 'x');
+    text[70] = '\n';
+    text[90] = '\n';
+    const char* end = text.data() + text.size();
+
+    EXPECT_THAT(findNewline(text.data(), end), Eq(text.data() + 70));
+    EXPECT_THAT(findNewline(text.data() + 71, end), Eq(text.data() + 90));
+    EXPECT_THAT(findNewline(text.data() + 91, end), Eq(end));
+    EXPECT_THAT(findNewline(end, end), Eq(end));
+}
+
+TEST_F(NAME, skip_blanks_at_every_length)
+{
+    // Covers runs that end inside a vector, on its boundary and in the tail
+    for (std::size_t length = 0; length != 80; ++length)
+    {
+        std::string text;
+        for (std::size_t i = 0; i != length; ++i)
+            text += "\t\r\v\f"[i % 4];
+        text += "x\t\t";
+        const char* end = text.data() + text.size();
+        EXPECT_THAT(skipBlanks(text.data(), end), Eq(text.data() + length)) << length;
+    }
+}
+
+TEST_F(NAME, skip_blanks_stops_at_space_and_newline)
+{
+    // Spaces and newlines are tokens, so they must not be skipped
+    std::string text = "\t\t \t";
+    EXPECT_THAT(skipBlanks(text.data(), text.data() + text.size()), Eq(text.data() + 2));
+    text = "\t\n";
+    EXPECT_THAT(skipBlanks(text.data(), text.data() + text.size()), Eq(text.data() + 1));
+}
+
+TEST_F(NAME, skip_blanks_to_end)
+{
+    std::string text(40, '\t');
+    const char* end = text.data() + text.size();
+    EXPECT_THAT(skipBlanks(text.data(), end), Eq(end));
+}
+
+TEST_F(NAME, find_last)
+{
+    std::string text = "remstart a REMEND b remend c";
+    const char* end = text.data() + text.size();
+    EXPECT_THAT(findLast(text.data(), end, "remend", true), Eq(text.data() + 20));
+    EXPECT_THAT(findLast(text.data(), text.data() + 24, "remend", true), Eq(text.data() + 11));
+    EXPECT_THAT(findLast(text.data(), text.data() + 24, "remend", false), IsNull());
+    EXPECT_THAT(findLast(text.data(), text.data() + 3, "remend", true), IsNull());
+    EXPECT_THAT(findLast(text.data(), end, "remstart", true), Eq(text.data()));
+}
+
+TEST_F(NAME, line_starts_match_scalar_search)
+{
+    std::string text;
+    for (int i = 0; i != 200; ++i)
+        text += std::string(i % 37, 'a') + "\n";
+    text += "no newline at the end";
+
+    std::vector<uint32_t> expected;
+    for (std::size_t i = 0; i != text.size(); ++i)
+        if (text[i] == '\n')
+            expected.push_back((uint32_t)(i + 1));
+
+    std::vector<uint32_t> starts;
+    findLineStarts(text.data(), text.size(), &starts);
+    EXPECT_THAT(starts, ContainerEq(expected));
+}
+
+TEST_F(NAME, line_index)
+{
+    std::string text = "a=1\n\nfoo(2)\nbar";
+    LineIndex index;
+    index.build(text.data(), text.size());
+
+    ASSERT_THAT(index.lineCount(), Eq(4u));
+    EXPECT_THAT(index.lineStart(1), Eq(0u));
+    EXPECT_THAT(index.lineStart(2), Eq(4u));
+    EXPECT_THAT(index.lineStart(3), Eq(5u));
+    EXPECT_THAT(index.lineStart(4), Eq(12u));
+
+    EXPECT_THAT(index.lineOf(0), Eq(1u));
+    EXPECT_THAT(index.lineOf(3), Eq(1u));   // The newline belongs to its line
+    EXPECT_THAT(index.lineOf(4), Eq(2u));
+    EXPECT_THAT(index.lineOf(8), Eq(3u));
+    EXPECT_THAT(index.columnOf(8), Eq(4u));
+    EXPECT_THAT(index.lineOf(14), Eq(4u));
+    EXPECT_THAT(index.lineOf(1000), Eq(4u));
+}
+
+TEST_F(NAME, empty_line_index)
+{
+    LineIndex index;
+    EXPECT_THAT(index.lineCount(), Eq(1u));
+    EXPECT_THAT(index.lineOf(0), Eq(1u));
+    EXPECT_THAT(index.columnOf(0), Eq(1u));
+
+    index.build("\n", 1);
+    EXPECT_THAT(index.lineCount(), Eq(2u));
+    index.clear();
+    EXPECT_THAT(index.lineCount(), Eq(1u));
+}
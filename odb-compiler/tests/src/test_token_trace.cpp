@@ -0,0 +1,91 @@
+#include <gmock/gmock.h>
+#include "odbc/parsers/TokenTrace.hpp"
+#include "odbc/parsers/db/Driver.hpp"
+#include <sstream>
+
+#define NAME token_trace
+
+using namespace testing;
+
+class NAME : public Test
+{
+public:
+};
+
+using namespace odbc;
+
+TEST_F(NAME, disabled_trace_records_nothing)
+{
+    TokenTrace trace(4);
+    trace.advance(3);
+    trace.record("symbol", "foo", 3);
+    ASSERT_THAT(trace.size(), Eq(0u));
+}
+
+TEST_F(NAME, records_kind_offset_and_text)
+{
+    TokenTrace trace(4);
+    trace.setEnabled(true);
+    trace.advance(3);
+    trace.record("symbol", "foo", 3);
+    trace.advance(1);
+    trace.record("eq", "=", 1);
+
+    ASSERT_THAT(trace.size(), Eq(2u));
+    ASSERT_THAT(trace[0].kind, StrEq("symbol"));
+    ASSERT_THAT(trace[0].offset, Eq(0u));
+    ASSERT_THAT(trace[0].length, Eq(3u));
+    ASSERT_THAT(trace[0].text, StrEq("foo"));
+    ASSERT_THAT(trace[1].kind, StrEq("eq"));
+    ASSERT_THAT(trace[1].offset, Eq(3u));
+}
+
+TEST_F(NAME, ring_buffer_keeps_most_recent_entries)
+{
+    TokenTrace trace(2);
+    trace.setEnabled(true);
+    const char* kinds[] = {"a", "b", "c"};
+    for (const char* kind : kinds)
+    {
+        trace.advance(1);
+        trace.record(kind, kind, 1);
+    }
+
+    ASSERT_THAT(trace.size(), Eq(2u));
+    ASSERT_THAT(trace[0].kind, StrEq("b"));
+    ASSERT_THAT(trace[1].kind, StrEq("c"));
+    ASSERT_THAT(trace[1].offset, Eq(2u));
+}
+
+TEST_F(NAME, long_tokens_are_truncated)
+{
+    TokenTrace trace(2);
+    trace.setEnabled(true);
+    std::string text(100, 'x');
+    trace.advance(text.length());
+    trace.record("string literal", text.c_str(), text.length());
+
+    ASSERT_THAT(trace[0].length, Eq(100u));
+    ASSERT_THAT(strlen(trace[0].text), Lt(sizeof(trace[0].text)));
+
+    std::ostringstream ss;
+    trace.dump(ss);
+    ASSERT_THAT(ss.str(), HasSubstr("..."));
+}
+
+#if defined(ODBC_SCANNER_TRACE)
+TEST_F(NAME, driver_traces_tokens)
+{
+    db::Driver driver;
+    driver.getTokenTrace()->setEnabled(true);
+    ASSERT_THAT(driver.parseString("a=1\n"), IsTrue());
+
+    TokenTrace* trace = driver.getTokenTrace();
+    ASSERT_THAT(trace->size(), Eq(4u));
+    ASSERT_THAT((*trace)[0].kind, StrEq("symbol"));
+    ASSERT_THAT((*trace)[1].kind, StrEq("eq"));
+    ASSERT_THAT((*trace)[1].offset, Eq(1u));
+    ASSERT_THAT((*trace)[2].kind, StrEq("integer"));
+    ASSERT_THAT((*trace)[3].kind, StrEq("newline"));
+}
+#endif